@@ -0,0 +1,391 @@
+// ****************************************************************************************************
+//
+//                                          cachebench.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                  Measures the throughput of the libcachesim engine. Every binary trace given on
+//                  the command line is loaded into memory once, then simulated by each cache of the
+//                  fixed GEOMETRIES x ALGORITHMS matrix, keeping the fastest of REPEATS runs. Each
+//                  run reports accesses per second, ns per access, and the peak RSS so far.
+//
+//                  With -c <baseline> every run is compared with the accesses per second stored
+//                  under the same name in the baseline file. Single runs are noisy on shared hosts,
+//                  so the gate is the geometric mean of the ratios over the whole matrix: the
+//                  program exits with status 1 if it is more than -t <percent> slower. Runs slower
+//                  than the threshold on their own are marked to show where the time went. A
+//                  baseline missing any run of the matrix fails too, since it cannot gate it. With
+//                  -w <baseline> the results of this host are written as the new baseline instead.
+//
+//                  With -p <text trace> the hex parsers are checked instead: the vectorized
+//                  traceParseHex and the scalar traceParseHexScalar parse the whole trace, then again
+//                  PARSE_CHUNK addresses at a time to stop at many capacity boundaries. Any difference
+//                  in the addresses, counts, or bytes consumed fails the run; the MB/s of both are
+//                  reported, keeping the fastest of REPEATS runs.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // libcachesim.h used for the cache simulator engine
+#include <stdio.h>                  // stdio.h used for input/output functions
+#include <stdlib.h>                 // stdlib.h used for malloc()
+#include <unistd.h>                 // unistd.h used for getopt()
+#include <string.h>                 // string.h used for strcmp()
+#include <time.h>                   // time.h used for clock_gettime()
+#include <sys/resource.h>           // sys/resource.h used for getrusage()
+#include <math.h>                   // math.h used for log() and exp()
+
+// // // Cachebench Constants
+const int REPEATS = 5;              // Runs per trace and cache, keeping the fastest
+const int NAMEMAX = 256;            // Maximum characters of a run name
+const long PARSE_CHUNK = 997;       // Addresses per call of the chunked parser check, prime so chunks end anywhere
+
+// Geometry Struct
+typedef struct{
+    const char *name;               // Name of the geometry in run names
+    int setBits;                    // (s)
+    int linesPerSet;                // (e)
+    int blockOffsetBits;            // (b)
+} Geometry;
+
+// Fixed benchmark matrix
+const Geometry GEOMETRIES[] = {
+    {"dm8k", 8, 0, 5},              // 8 KiB direct-mapped, 32 byte blocks
+    {"l1-32k", 6, 3, 6},            // 32 KiB 8-way, 64 byte blocks
+    {"l2-512k", 10, 3, 6},          // 512 KiB 8-way, 64 byte blocks
+    {"llc-8m", 13, 4, 6}            // 8 MiB 16-way, 64 byte blocks
+};
+const char *ALGORITHMS[] = {"lru", "fifo"};
+
+// // // Cachebench Variables
+// Args
+char *compareName;                  // (c) Name of baseline file to compare against
+char *writeName;                    // (w) Name of baseline file to write
+double threshold = 10;              // (t) Percent slowdown against the baseline that fails the run
+char *parseName;                    // (p) Name of a text trace the hex parsers are checked on
+
+// ****************************************************************************************************
+// Load Trace Function
+// --- Reads a binary trace written by tracegen into a malloc'd array stored in addresses and
+// --- returns the number of addresses, or -1 if the file is not a binary trace
+// ****************************************************************************************************
+long loadTrace(const char *name, unsigned long long **addresses)
+{
+    // Function Variables
+    FILE *pTrace;                   // Trace file pointer
+    TraceHeader header;             // Header of the binary trace
+    long count = -1;                // Number of addresses read
+
+    pTrace = fopen(name, "rb");
+    if(pTrace == NULL)
+    {
+        return -1;
+    }
+
+    if(fread(&header, sizeof(header), 1, pTrace) == 1 && memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) == 0
+        && header.version == TRACE_VERSION)
+    {
+        *addresses = malloc(header.count * sizeof(unsigned long long));
+        if(*addresses != NULL)
+        {
+            count = fread(*addresses, sizeof(unsigned long long), header.count, pTrace);
+        }
+    }
+
+    fclose(pTrace);
+    return count;
+}
+
+// ****************************************************************************************************
+// Baseline Function
+// --- Returns the accesses per second stored for name in the baseline file, or 0 if there is none
+// ****************************************************************************************************
+double baseline(FILE *pBaseline, const char *name)
+{
+    // Function Variables
+    char stored[NAMEMAX];           // Run name of the current baseline line
+    double rate;                    // Accesses per second of the current baseline line
+
+    rewind(pBaseline);
+    while(fscanf(pBaseline, "%255s %lf", stored, &rate) == 2)
+    {
+        if(strcmp(stored, name) == 0)
+        {
+            return rate;
+        }
+    }
+
+    return 0;
+}
+
+// ****************************************************************************************************
+// Time Parser Function
+// --- Returns the seconds of the fastest of REPEATS parses of the whole text by parser
+// ****************************************************************************************************
+double timeParser(long (*parser)(const char *, size_t, unsigned long long *, long, size_t *), const char *text, size_t length,
+    unsigned long long *addresses, long capacity)
+{
+    // Function Variables
+    struct timespec begin;          // Wall time at the start of a run
+    struct timespec end;            // Wall time at the end of a run
+    size_t consumed;                // Bytes consumed by the parser
+    double seconds = 0;             // Seconds of the fastest run
+    double elapsed;                 // Seconds of the current run
+    int repeat;
+
+    for (repeat = 0; repeat < REPEATS; repeat++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        parser(text, length, addresses, capacity, &consumed);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        elapsed = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+        if(repeat == 0 || elapsed < seconds)
+        {
+            seconds = elapsed;
+        }
+    }
+
+    return seconds;
+}
+
+// ****************************************************************************************************
+// Parse Check Function
+// --- Parses the text trace name with traceParseHex and traceParseHexScalar, whole and PARSE_CHUNK
+// --- addresses at a time, and prints their throughput. Returns 1 if they disagree, otherwise 0.
+// ****************************************************************************************************
+int parseCheck(const char *name)
+{
+    // Function Variables
+    FILE *pTrace;                   // Text trace file pointer
+    char *text;                     // Whole text of the trace
+    size_t length;                  // Bytes of the text
+    unsigned long long *vector;     // Addresses parsed by traceParseHex
+    unsigned long long *scalar;     // Addresses parsed by traceParseHexScalar
+    long capacity;                  // Addresses the arrays have room for, one per two bytes at most
+    long vectorCount, scalarCount;  // Addresses parsed by each
+    size_t vectorConsumed, scalarConsumed;  // Bytes consumed by each
+    size_t position = 0;            // Offset of the next chunk
+    long total = 0;                 // Addresses parsed by the chunks so far
+    double vectorSeconds, scalarSeconds;
+    bool same;                      // Flag indicating both parsers agree so far
+
+    pTrace = fopen(name, "rb");
+    if(pTrace == NULL || fseek(pTrace, 0, SEEK_END) != 0)
+    {
+        printf("[ERROR] Could not read %s ... [EXITING PROGRAM]\n", name);
+        return 1;
+    }
+    length = ftell(pTrace);
+    rewind(pTrace);
+    capacity = length / 2 + 1;
+    text = malloc(length + 1);
+    vector = malloc(capacity * sizeof(unsigned long long));
+    scalar = malloc(capacity * sizeof(unsigned long long));
+    if(text == NULL || vector == NULL || scalar == NULL || fread(text, 1, length, pTrace) != length)
+    {
+        printf("[ERROR] Could not read %s ... [EXITING PROGRAM]\n", name);
+        fclose(pTrace);
+        free(text);
+        free(vector);
+        free(scalar);
+        return 1;
+    }
+    fclose(pTrace);
+
+    // The whole text at once
+    vectorCount = traceParseHex(text, length, vector, capacity, &vectorConsumed);
+    scalarCount = traceParseHexScalar(text, length, scalar, capacity, &scalarConsumed);
+    same = vectorCount == scalarCount && vectorConsumed == scalarConsumed
+        && (vectorCount <= 0 || memcmp(vector, scalar, vectorCount * sizeof(unsigned long long)) == 0);
+
+    // Then in chunks ending at many places within the text
+    while(same && position < length)
+    {
+        vectorCount = traceParseHex(&text[position], length - position, vector, PARSE_CHUNK, &vectorConsumed);
+        scalarCount = traceParseHexScalar(&text[position], length - position, scalar, PARSE_CHUNK, &scalarConsumed);
+        same = vectorCount == scalarCount && vectorConsumed == scalarConsumed
+            && (vectorCount <= 0 || memcmp(vector, scalar, vectorCount * sizeof(unsigned long long)) == 0);
+        if(vectorCount <= 0)
+        {
+            break;
+        }
+        position += vectorConsumed;
+        total += vectorCount;
+    }
+
+    vectorSeconds = timeParser(traceParseHex, text, length, vector, capacity);
+    scalarSeconds = timeParser(traceParseHexScalar, text, length, scalar, capacity);
+    printf("[parse] %s bytes: %zu addresses: %ld vector MB/s: %.0f scalar MB/s: %.0f speedup: %.2fx %s\n", name, length, total,
+        length / vectorSeconds / 1e6, length / scalarSeconds / 1e6, scalarSeconds / vectorSeconds, same ? "[same]" : "[DIFFERENT]");
+
+    free(text);
+    free(vector);
+    free(scalar);
+
+    return same ? 0 : 1;
+}
+
+// ****************************************************************************************************
+// Main Function
+// --- Given arguments in the form :c:w:t: followed by binary trace files, benchmarks every trace
+// --- against the fixed matrix of geometries and algorithms. With -p, checks the hex parsers instead.
+// ****************************************************************************************************
+int main(int argc, char **argv)
+{
+    // Function Variables
+    int opt;                        // Option for switch case to gather argument list
+    FILE *pCompare = NULL;          // Baseline file compared against
+    FILE *pWrite = NULL;            // Baseline file written
+    unsigned long long *addresses;  // Decoded trace
+    long count;                     // Number of addresses in the trace
+    CacheConfig config;             // Config of the benchmarked cache
+    Cache *cache;                   // Benchmarked cache
+    struct timespec begin;          // Wall time at the start of a run
+    struct timespec end;            // Wall time at the end of a run
+    struct rusage usage;            // Resource usage for the peak RSS
+    double seconds;                 // Seconds of the fastest run
+    double elapsed;                 // Seconds of the current run
+    double rate;                    // Accesses per second of the fastest run
+    double expected;                // Accesses per second stored in the baseline
+    char name[NAMEMAX];             // Run name: trace/geometry/algorithm
+    const char *traceName;          // File name of the trace without directories
+    int slower = 0;                 // Number of runs slower than the threshold on their own
+    int compared = 0;               // Number of runs found in the baseline
+    double logRatios = 0;           // Sum of the log of each run's ratio to its baseline
+    double change;                  // Geometric mean ratio to the baseline
+    int runs;                       // Number of runs of the matrix over every trace
+    int trace, geometry, algorithm, repeat;
+
+    while ((opt = getopt(argc, argv, ":c:w:t:p:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c': compareName = optarg; break;
+            case 'w': writeName = optarg; break;
+            case 't': threshold = atof(optarg); break;
+            case 'p': parseName = optarg; break;
+            default:
+                printf("Error: Please check format of arguments ... \n");
+                exit(1);
+        }
+    }
+
+    // Check the hex parsers instead of benchmarking the engine
+    if(parseName != NULL)
+    {
+        return parseCheck(parseName);
+    }
+
+    if(optind == argc)
+    {
+        fprintf(stderr, "Usage: %s [-c baseline] [-w baseline] [-t percent] trace... | -p text-trace\n", argv[0]);
+        exit(1);
+    }
+
+    if(compareName != NULL && (pCompare = fopen(compareName, "r")) == NULL)
+    {
+        printf("[ERROR] Could not open baseline %s ... [EXITING PROGRAM]\n", compareName);
+        exit(1);
+    }
+    if(writeName != NULL && (pWrite = fopen(writeName, "w")) == NULL)
+    {
+        printf("[ERROR] Could not write baseline %s ... [EXITING PROGRAM]\n", writeName);
+        exit(1);
+    }
+
+    for (trace = optind; trace < argc; trace++)
+    {
+        count = loadTrace(argv[trace], &addresses);
+        if(count <= 0)
+        {
+            printf("[ERROR] %s is not a binary trace ... [EXITING PROGRAM]\n", argv[trace]);
+            exit(1);
+        }
+        traceName = strrchr(argv[trace], '/') != NULL ? strrchr(argv[trace], '/') + 1 : argv[trace];
+
+        for (geometry = 0; geometry < (int)(sizeof(GEOMETRIES) / sizeof(GEOMETRIES[0])); geometry++)
+        {
+            for (algorithm = 0; algorithm < (int)(sizeof(ALGORITHMS) / sizeof(ALGORITHMS[0])); algorithm++)
+            {
+                memset(&config, 0, sizeof(config));
+                config.addressSize = 64;
+                config.setBits = GEOMETRIES[geometry].setBits;
+                config.linesPerSet = GEOMETRIES[geometry].linesPerSet;
+                config.blockOffsetBits = GEOMETRIES[geometry].blockOffsetBits;
+                config.algorithm = ALGORITHMS[algorithm];
+
+                // Keep the fastest run, each on a new cold cache
+                seconds = 0;
+                for (repeat = 0; repeat < REPEATS; repeat++)
+                {
+                    cache = cacheCreate(&config);
+                    clock_gettime(CLOCK_MONOTONIC, &begin);
+                    cacheAccessBatch(cache, addresses, count, NULL);
+                    clock_gettime(CLOCK_MONOTONIC, &end);
+                    cacheDestroy(cache);
+
+                    elapsed = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+                    if(repeat == 0 || elapsed < seconds)
+                    {
+                        seconds = elapsed;
+                    }
+                }
+
+                rate = count / seconds;
+                getrusage(RUSAGE_SELF, &usage);
+                snprintf(name, sizeof(name), "%s/%s/%s", traceName, GEOMETRIES[geometry].name, ALGORITHMS[algorithm]);
+                printf("[bench] %-40s accesses: %ld accesses/s: %.0f ns/access: %.2f peak rss: %ld KiB", name, count, rate, 1e9 / rate, usage.ru_maxrss);
+
+                if(pWrite != NULL)
+                {
+                    fprintf(pWrite, "%s %.0f\n", name, rate);
+                }
+
+                // Compare with the baseline, marking runs slower than the threshold
+                if(pCompare != NULL && (expected = baseline(pCompare, name)) > 0)
+                {
+                    printf(" baseline: %+.1f%%", (rate - expected) * 100 / expected);
+                    if(rate < expected * (1 - threshold / 100))
+                    {
+                        printf(" [slower]");
+                        slower++;
+                    }
+                    logRatios += log(rate / expected);
+                    compared++;
+                }
+                printf("\n");
+            }
+        }
+
+        free(addresses);
+    }
+
+    if(pWrite != NULL)
+    {
+        fclose(pWrite);
+    }
+
+    // Fail if the whole matrix is slower than the threshold allows, or the baseline misses part of it
+    if(pCompare != NULL)
+    {
+        fclose(pCompare);
+        runs = (argc - optind) * (int)(sizeof(GEOMETRIES) / sizeof(GEOMETRIES[0])) * (int)(sizeof(ALGORITHMS) / sizeof(ALGORITHMS[0]));
+        if(compared < runs)
+        {
+            printf("[bench] [ERROR] baseline %s has %d of the %d runs - record it again with -w\n", compareName, compared, runs);
+            return 1;
+        }
+        change = exp(logRatios / compared);
+        printf("[bench] runs: %d slower runs: %d geometric mean vs baseline: %+.1f%% threshold: -%.0f%%\n",
+            compared, slower, (change - 1) * 100, threshold);
+        if(change < 1 - threshold / 100)
+        {
+            printf("[bench] [REGRESSION] throughput dropped past the threshold\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
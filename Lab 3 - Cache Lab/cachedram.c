@@ -0,0 +1,267 @@
+// ****************************************************************************************************
+//
+//                                           cachedram.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                                      DRAM Address Mapping:
+//
+//                  row:rank:bank:channel:column    [   row   ][ rank ][ bank ][ channel ][ column ][ b ]
+//                  row:column:rank:bank:channel    [   row   ][ column ][ rank ][ bank ][ channel ][ b ]
+//
+//                  A miss address is split into fields listed from the most to the least
+//                  significant bits; the block offset (b) is always the lowest. The row takes every
+//                  bit left over, so it comes first. Putting the channel and bank bits just above
+//                  the block offset spreads consecutive blocks over every bank, while putting the
+//                  column there keeps a whole row buffer of consecutive blocks in one bank.
+//
+//                                           Row Buffers:
+//
+//                  row hit       -   the bank's open row is the one requested
+//                  row empty     -   the bank has no open row yet
+//                  row conflict  -   another row is open and must be closed first
+//
+//                  Banks keep their row open after every access (open page policy) and serve one
+//                  request at a time, so requests to a busy bank wait for it.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // header file for libcachesim.c
+#include <stdlib.h>                 // stdlib.h used for malloc()
+#include <string.h>                 // string.h used for strcmp()
+
+// Address fields of a DRAM mapping
+typedef enum{
+    FIELD_ROW,
+    FIELD_RANK,
+    FIELD_BANK,
+    FIELD_CHANNEL,
+    FIELD_COLUMN,
+    NUM_FIELDS
+} Field;
+
+static const char *const FIELD_NAMES[] = {"row", "rank", "bank", "channel", "column"};
+
+// Bank Struct
+typedef struct{
+    bool open;                      // Flag indicating a row is open in the row buffer
+    unsigned long long row;         // Open row
+    unsigned long long ready;       // Cycle the bank finishes its last request
+    DramBankStats stats;
+} Bank;
+
+// CacheDram Struct
+struct CacheDram{
+    DramConfig config;              // Geometry, mapping, and latencies
+    int shift[NUM_FIELDS];          // Lowest address bit of every field
+    unsigned long long mask[NUM_FIELDS]; // Mask of every field once shifted down, row unmasked
+    Bank *banks;                    // channels * ranks * banks banks, channel major
+    DramStats stats;
+};
+
+// ****************************************************************************************************
+// Log2 Function
+// --- Returns the base 2 logarithm of a power of two, or -1 for any other count
+// ****************************************************************************************************
+static int log2Exact(int count)
+{
+    // Function Variables
+    int bits = 0;                   // Bits counted so far
+
+    if(count <= 0 || (count & (count - 1)) != 0)
+    {
+        return -1;
+    }
+    while((1 << bits) < count)
+    {
+        bits++;
+    }
+
+    return bits;
+}
+
+// ****************************************************************************************************
+// Dram Create Function
+// --- Allocates a DRAM model for misses of blocks of 2^blockOffsetBits bytes. Returns NULL if the
+// --- counts are not powers of two, a row buffer is smaller than a block, the mapping does not
+// --- list every field once starting with the row, or memory runs out.
+// ****************************************************************************************************
+CacheDram *dramCreate(const DramConfig *config, int blockOffsetBits)
+{
+    // Function Variables
+    CacheDram *dram;                // Model being created
+    const char *mapping = config->mapping != NULL ? config->mapping : "row:rank:bank:channel:column";
+    int order[NUM_FIELDS];          // Fields from the most significant down
+    int width[NUM_FIELDS];          // Address bits of every field, the row's unused
+    int count = 0;                  // Fields parsed from mapping
+    int length;                     // Characters of the current field name
+    int bit = blockOffsetBits;      // Lowest bit of the next field up
+    int field, seen;
+
+    width[FIELD_ROW] = 0;
+    width[FIELD_RANK] = log2Exact(config->ranks);
+    width[FIELD_BANK] = log2Exact(config->banks);
+    width[FIELD_CHANNEL] = log2Exact(config->channels);
+    width[FIELD_COLUMN] = config->columnBits - blockOffsetBits;
+    if(width[FIELD_RANK] < 0 || width[FIELD_BANK] < 0 || width[FIELD_CHANNEL] < 0 || width[FIELD_COLUMN] < 0
+        || config->rowHit < 0 || config->rowEmpty < 0 || config->rowConflict < 0)
+    {
+        return NULL;
+    }
+
+    // Parse the colon separated field names, each exactly once
+    while(*mapping != '\0' && count < NUM_FIELDS)
+    {
+        length = strcspn(mapping, ":");
+        for (field = 0; field < NUM_FIELDS && (strncmp(mapping, FIELD_NAMES[field], length) != 0 || FIELD_NAMES[field][length] != '\0'); field++)
+        {
+        }
+        for (seen = 0; seen < count && field < NUM_FIELDS && order[seen] != field; seen++)
+        {
+        }
+        if(field == NUM_FIELDS || seen < count)
+        {
+            return NULL;
+        }
+        order[count++] = field;
+        mapping += length + (mapping[length] == ':' ? 1 : 0);
+    }
+    if(count != NUM_FIELDS || *mapping != '\0' || order[0] != FIELD_ROW)
+    {
+        return NULL;
+    }
+
+    dram = calloc(1, sizeof(CacheDram));
+    if(dram == NULL)
+    {
+        return NULL;
+    }
+    dram->config = *config;
+    dram->config.mapping = NULL;
+    dram->banks = calloc((size_t)config->channels * config->ranks * config->banks, sizeof(Bank));
+    if(dram->banks == NULL)
+    {
+        free(dram);
+        return NULL;
+    }
+
+    // Assign bits from the least significant field up, leaving the rest to the row
+    for (field = NUM_FIELDS - 1; field >= 0; field--)
+    {
+        dram->shift[order[field]] = bit;
+        dram->mask[order[field]] = order[field] == FIELD_ROW ? ~0ULL : (1ULL << width[order[field]]) - 1;
+        bit += width[order[field]];
+    }
+
+    return dram;
+}
+
+// ****************************************************************************************************
+// Dram Destroy Function
+// --- Frees a DRAM model; NULL is ignored
+// ****************************************************************************************************
+void dramDestroy(CacheDram *dram)
+{
+    if(dram == NULL)
+    {
+        return;
+    }
+
+    free(dram->banks);
+    free(dram);
+}
+
+// ****************************************************************************************************
+// Dram Access Function
+// --- Reads the block of address, requested at cycle, from its bank: once the bank is free, the
+// --- row hit, empty, or conflict latency is charged and the row is left open. Returns the cycle
+// --- the block arrives.
+// ****************************************************************************************************
+unsigned long long dramAccess(CacheDram *dram, unsigned long long address, unsigned long long cycle)
+{
+    // Function Variables
+    unsigned long long fields[NUM_FIELDS]; // Address split into its fields
+    Bank *bank;                     // Bank holding the block
+    int field;                      // Index counter for moving through the fields
+
+    for (field = 0; field < NUM_FIELDS; field++)
+    {
+        fields[field] = address >> dram->shift[field] & dram->mask[field];
+    }
+    bank = &dram->banks[(fields[FIELD_CHANNEL] * dram->config.ranks + fields[FIELD_RANK]) * dram->config.banks + fields[FIELD_BANK]];
+
+    if(bank->ready > cycle)
+    {
+        cycle = bank->ready;
+    }
+
+    if(bank->open && bank->row == fields[FIELD_ROW])
+    {
+        cycle += dram->config.rowHit;
+        dram->stats.rowHits++;
+    }
+    else if(bank->open == false)
+    {
+        cycle += dram->config.rowEmpty;
+        dram->stats.rowEmpty++;
+    }
+    else
+    {
+        cycle += dram->config.rowConflict;
+        dram->stats.rowConflicts++;
+        bank->stats.conflicts++;
+    }
+
+    bank->open = true;
+    bank->row = fields[FIELD_ROW];
+    bank->ready = cycle;
+    bank->stats.requests++;
+    dram->stats.requests++;
+
+    return cycle;
+}
+
+// ****************************************************************************************************
+// Dram Get Stats Function
+// --- Copies the counters of the whole memory into stats
+// ****************************************************************************************************
+void dramGetStats(const CacheDram *dram, DramStats *stats)
+{
+    *stats = dram->stats;
+}
+
+// ****************************************************************************************************
+// Dram Get Bank Stats Function
+// --- Copies the counters of one bank into stats. Returns false if the bank does not exist.
+// ****************************************************************************************************
+bool dramGetBankStats(const CacheDram *dram, int channel, int rank, int bank, DramBankStats *stats)
+{
+    if(channel < 0 || channel >= dram->config.channels || rank < 0 || rank >= dram->config.ranks
+        || bank < 0 || bank >= dram->config.banks)
+    {
+        return false;
+    }
+
+    *stats = dram->banks[((long)channel * dram->config.ranks + rank) * dram->config.banks + bank].stats;
+    return true;
+}
+
+// ****************************************************************************************************
+// Dram Reset Stats Function
+// --- Zeroes the counters of the memory and of every bank, keeping the open rows. The caller's clock
+// --- restarts at 0 from cycle, so every bank still busy past cycle stays busy for the same time.
+// ****************************************************************************************************
+void dramResetStats(CacheDram *dram, unsigned long long cycle)
+{
+    // Function Variables
+    long bank;                      // Index counter for moving through the banks
+
+    memset(&dram->stats, 0, sizeof(dram->stats));
+    for (bank = 0; bank < (long)dram->config.channels * dram->config.ranks * dram->config.banks; bank++)
+    {
+        memset(&dram->banks[bank].stats, 0, sizeof(dram->banks[bank].stats));
+        dram->banks[bank].ready = dram->banks[bank].ready > cycle ? dram->banks[bank].ready - cycle : 0;
+    }
+}
@@ -33,7 +33,7 @@
 //                                 [     ][     ][     ][     ][     ][     ]    <-Set2
 //                                 [     ][     ][     ][     ][     ][     ]    <-Set3 }-----CacheSet (E cachelines : E = 6)
 //                                                      ^
-//                                                     /|\ 
+//                                                     /|\  set index
 //                                                      |
 //                                       Cache: (2^s cacheSets) (S=4, s=2)
 //                                 -s (number of index bits) ->  2^s = numSets
@@ -65,25 +65,40 @@
 //----------------------------------------------------------------------------------------------------
 // ****************************************************************************************************
 
+#define _GNU_SOURCE                 // _GNU_SOURCE used for fopencookie()
+
 #include "cachelab.h"               // header file for cachelab.c
+#include "libcachesim.h"            // libcachesim.h used for the cache simulator engine
 #include <stdio.h>                  // stdio.h used for input/output functions
-#include <stdlib.h>                 // stdlib.h used for malloc()
+#include <stdlib.h>                 // stdlib.h used for strtoull()
 #include <unistd.h>                 // unistd.h used for getopt()
-#include <math.h>                   // math.h used for pow()
 #include <stdbool.h>                // stdbool.h used for bool data type
 #include <string.h>                 // string.h used for memcpy()
+#include <time.h>                   // time.h used for clock_gettime()
+#include <sys/stat.h>               // sys/stat.h used for stat()
+#include <ctype.h>                  // ctype.h used for isspace()
 
 // // // Cachelab Constants
 // Algorithm types
-const char *LRU = "lru\0";          // Constant string comparison for lru algorithm
-const char *FIFO = "fifo";          // Constant string comparison for fifo algorithm
 const char *OPTIMAL = "optimal";    // Constant string comparison for optimal algorithm
 
 // Integer constants
-const int NUMARGS = 13;             // Number of given arguments for error check
+const int NUMARGS = 13;             // Number of required arguments for error check
 const int HEXMAX = 128;             // Maximum characters of a given hexidecimal address 
-const int MAX3HEX = 4095;           // Maximum decimal number of 3 digit hexidecimal number 0xFFF
-const int MAX4HEX = 65535;          // Maximum decimal number of 4 digit hexidecimal number 0xFFFF
+const int TRACE_CHUNK = 1 << 20;    // Bytes of the input file parsed at once by readTrace
+const int CHECKPOINT_VERSION = 5;   // Version of the checkpoint file layout written by saveCheckpoint
+const char *CHECKPOINT_MAGIC = "CSCP"; // Magic characters at the start of every checkpoint file
+const int DIFF_SHOWN = 20;          // Divergent accesses printed one by one by diffSim
+const int DIFF_TOP = 10;            // Sets and regions with the most divergences printed by diffSim
+#define WINDOW_STEPS 4              // Lookahead windows compared by printWindow, halving from -o
+const unsigned long long RESULT_SEED = 0xcbf29ce484222325ULL;  // Starting value of hashBytes
+#define RESULT_KEY_MAX 4096         // Longest key of a cached result, options and hashes
+const int SHARING_TOP = 20;         // Blocks of each kind of sharing printed by sharingAnalysis
+const int BATCH_ADDRESSES = 4096;   // Addresses handed to cacheAccessBatch at a time by batchSim
+const int REGION_LINE_MAX = 4096;   // Longest line of a region map read by loadRegions
+const int REGION_TOP = 20;          // Regions with the most misses printed by printRegions
+const int OPTION_LETTERS = 128;     // Number of characters getopt can return an option as
+const char *COMMON_OPTIONS = "msebirSEhqk"; // Options every mode accepts
 
 // // // Cachelab Variables
 // Args
@@ -92,52 +107,161 @@ int setBits;                        // (s) The number of set bits (S = 2^s)
 int linesPerSet;                    // (e) Number of lines per set
 int blockOffsetBits;                // (b) Number of set index bits
 char *fileName;                     // (i) Name of file containing addresses
-char *algorithm;                    // (r) Page Replacement Algorithm - LRU/FIFO/Optimal
+char *algorithm;                    // (r) Page Replacement Algorithm - LRU/FIFO/Optimal/Hawkeye
+char *checkpointFile;               // (c) Name of file to save a checkpoint of the cache state into
+long long checkpointAt;             // (n) Access index after which the checkpoint is saved
+char *restoreFile;                  // (l) Name of checkpoint file to restore the cache state from
+int numSlices;                      // (p) Number of time slices simulated in parallel
+long sliceWarmUp;                   // (u) Number of accesses each slice replays before it starts
+int numSets;                        // (S) Number of sets of any size, overriding setBits
+int numWays;                        // (E) Number of lines per set of any size, overriding linesPerSet
+char *indexHash;                    // (h) Set index function - modulo/xor/prime/skew
+char *tenantRates;                  // (R) Comma separated accesses per turn of each shared trace
+char *tenantWays;                   // (W) Comma separated static ways of each shared trace, or ucp
+long partitionEpoch = 100000;       // (U) Number of accesses between utility-based repartitions
+char *diffModel;                    // (D) Second model run in lockstep, as key=value pairs of m,s,e,b,r,S,E,h
+int regionBits = 12;                // (g) Address bits within a region for the -D report and -P signatures
+int numMshrs;                       // (M) Number of MSHRs of the non-blocking timing model, 0 for none
+int memoryLatency = MISS_PENALTY;   // (L) Cycles until memory answers a miss in the timing model
+int transferCycles;                 // (B) Cycles a block occupies the memory bus in the timing model
+int issueInterval = HIT_TIME;       // (I) Cycles between accesses in the timing model
+bool timestamped;                   // (T) Flag indicating each text trace address is followed by its issue cycle
+char *dramSpec;                     // (d) DRAM behind the cache, as key=value pairs of channels,ranks,banks,row,map,hit,empty,conflict
+bool quiet;                         // (q) Flag indicating only summary lines are printed, not every access
+char *resultDir;                    // (k) Directory of cached results, replayed for runs with the same inputs
+long lookahead;                     // (o) Accesses ahead of each access the optimal algorithm sees, 0 for the whole trace
+long long phaseLength;              // (P) Accesses per interval grouped into phases by phaseAnalysis, 0 for none
+int maxPhases = 10;                 // (K) Most phases phaseAnalysis groups the intervals into
+char *phaseFile;                    // (Q) Output of phaseAnalysis whose representative intervals phaseSim simulates
+bool sharingTrace;                  // (F) Flag indicating a thread tagged trace analysed for false sharing instead of simulated
+char *regionFile;                   // (A) Region map whose named address ranges the hits, misses, and evictions are split by
+char *instructionModel;             // (x) L1 instruction cache in front of the cache, as key=value pairs of m,s,e,b,r,S,E,h
+char *dataModel;                    // (y) L1 data cache in front of the cache, as key=value pairs of m,s,e,b,r,S,E,h
+bool givenOptions[128];             // Flag of each option letter given, checked against the mode by checkOptions
 
 // Function variables
-int opt;                            // Option for switch case to gather argument list
-int numSets;                        // (S) Number of sets
-int numLines;                       // (E) Number of lines; associativity
-int blockSize;                      // (B) The block size in bits
-int tagSize;                        // The tag size in bits
-int size;                           // Number of memory blocks within file for calculation of result
-
-// Index counters
-int i;                              // Index counter for moving through arrays
-int j;                              // Index counter for moving through arrays
-
-// Cache counters
-int hits;                           // Hit counter
-int misses;                         // Miss counter
-int evictions;                      // Evictions counter
-int clock;                          // "Clock" time counter for algorithm implementation
+long long size;                     // Number of memory blocks within file for calculation of result
+long long warmUp;                   // (w) Number of leading accesses excluded from the result counters
+long long interval;                 // (t) Number of accesses between interval statistic printouts
+long long accessCount;              // Number of addresses read from file including warm-up accesses
+
+// Interval counters
+long long intervalHits;             // Hit counter at the start of the current interval
+long long intervalMisses;           // Miss counter at the start of the current interval
+long long intervalEvictions;        // Evictions counter at the start of the current interval
 
 // Conversion variables
 char *hexAddress;                   // Char array containing single address in hexidecimal
-char *binaryAddress;                // Char array containing single address in binary
 
 // Result calculations
 long double missRate;               // Miss rate casted to integer for printing result
 long double avgAccessTime;          // Average access time calculated for printing result
-int runTime;                        // Run time calculated for printing result
+long long runTime;                  // Run time calculated for printing result
 
 // Input file pointer
 FILE *pFile;                        // Input file pointer
+bool binaryTrace;                   // Flag indicating the input file is a binary trace from tracegen
+unsigned long long *streamBuffer;   // TRACE_CHUNK bytes of a binary trace read ahead by readAddress
+long streamCount;                   // Number of addresses in streamBuffer
+long streamPosition;                // Index of the next address of streamBuffer handed out
 
-// CacheLine Struct
+// Trace Probe Struct
 typedef struct{
-    bool validBit;                  // Valid Bit showing use of CacheLine Block: True/1 = in use; False/0 = not in use.
-    unsigned long long tag;         // Tag Line segment of CacheLine Block
-    int lruCount;                   // Counter for uses for LRU algorithm
-    int fifoCount;                  // Counter for uses for FIFO algorithm
-/*  int futureCount;                // Counter for number of memory addresses until next occurrence */
-} CacheLine;
+    FILE *file;                     // Pipe the text trace is read from
+    char bytes[sizeof(TraceHeader)];// Bytes read from the pipe by the binary header probe
+    size_t count;                   // Number of probed bytes
+    size_t position;                // Index of the next probed byte handed out
+} TraceProbe;
 
-// Default empty CacheLine          // Sets all CacheLine struct variables to defaults
-CacheLine emptyLine = {.validBit = false, .tag = 0, .lruCount = 0, .fifoCount = 0/*, .futureCount = 0*/};
+// Checkpoint Struct
+typedef struct{
+    char magic[4];                  // CHECKPOINT_MAGIC characters identifying a checkpoint file
+    int version;                    // CHECKPOINT_VERSION of the file layout
+    long offset;                    // Byte offset into the trace file to continue reading from
+    long long accessCount;          // Addresses read from the trace including warm-up accesses
+    long long size;                 // Counted addresses for the run time calculation
+    long long intervalHits;         // Interval counters at the checkpoint
+    long long intervalMisses;
+    long long intervalEvictions;
+} Checkpoint;
+
+// Simulated cache
+Cache *cache;                       // Cache handle of the libcachesim engine
+CacheTiming *timing;                // Non-blocking timing model of the accesses, NULL without -M
+unsigned long long issueCycle;      // Issue cycle of the address just read from a timestamped trace
+TimingStats timingStats;            // Counters of the timing model for the result
+CacheDram *dram;                    // DRAM model answering misses, NULL without -d
+unsigned long long dramCycle;       // Cycles of the accesses so far with serial DRAM misses and no -M
+DramConfig dramConfig = {1, 1, 8, 13, NULL, 50, 100, 150}; // DRAM geometry and latencies, overridden by -d
+CacheRegions *regions;              // Named address ranges of the -A map, NULL without -A
+
+// Result cache
+char *resultPath;                   // Cached result written by this run, NULL when it is not cached
+char *resultTemp;                   // Temporary file capturing the output of this run
+int resultStdout = -1;              // Descriptor of the real stdout while the output is captured
+bool resultComplete;                // Flag indicating the run finished, so its capture is kept
+
+// DiffCount Struct
+typedef struct{
+    unsigned long long key;         // Set or region
+    long onlyA;                     // Accesses hitting in the first model only
+    long onlyB;                     // Accesses hitting in the second model only
+} DiffCount;
 
-// Cache double pointer
-CacheLine **cache;                  // Struct CacheLine double pointer = cache
+// LookaheadWindow Struct
+typedef struct{
+    long lookahead;                 // Accesses after the current one whose next uses are known
+    long size;                      // Slots of the ring, lookahead + 1
+    unsigned long long *addresses;  // Addresses read ahead, at their position modulo size
+    long *nextUses;                 // Position of the next access to the same block read so far, or CACHE_NEVER
+    long *previousUses;             // Position of the previous access to the same block still in the window, or -1
+    unsigned long long *blocks;     // Block of each table slot
+    long *positions;                // Latest position of each slot's block in the window, -1 if empty
+    size_t capacity;                // Number of table slots, at least twice the ring
+    int shift;                      // Shift of the block hash down to a slot
+    long position;                  // Position of the next address handed out
+    long end;                       // Position after the last address read ahead
+    Cache *caches[WINDOW_STEPS];    // Optimal cache of each window lookahead >> step, the first is cache
+} LookaheadWindow;
+
+// Lookahead window of the streaming optimal algorithm, NULL without -o
+LookaheadWindow *window;
+
+// Phase Struct
+typedef struct{
+    int phase;                      // Phase found by phaseAnalysis
+    long interval;                  // Interval representing the phase
+    long long start;                // Position of the interval's first access
+    long long length;               // Accesses of the interval
+    double weight;                  // Share of the trace's accesses in the phase
+    long long hits;                 // Counters of the interval simulated by phaseSim
+    long long misses;
+} Phase;
+
+// Whole trace read ahead for the optimal algorithm
+unsigned long long *futureAddresses;// Every address of the trace
+long *futureNextUses;               // Position of the next access to the block of each address
+long futureCount;                   // Number of addresses of the trace
+long futurePosition;                // Index of the next address handed out by readAddress
+
+// Mode Struct
+typedef struct{
+    const char *name;               // Name of the mode in error messages
+    const char *options;            // Options the mode accepts besides COMMON_OPTIONS
+    bool optimal;                   // Flag indicating the mode can run the optimal algorithm
+} Mode;
+
+// Options and algorithms of every mode, in the order of RunMode
+const Mode MODES[] = {
+    {"simulation", "wtcnlMLBITdoA", true},
+    {"shared trace simulation", "RWU", false},
+    {"sharing analysis (-F)", "F", true},
+    {"split L1 simulation (-x, -y)", "xyw", false},
+    {"phase analysis (-P)", "PKg", false},
+    {"phase simulation (-Q)", "Qu", false},
+    {"parallel simulation (-p)", "pu", false},
+    {"differential simulation (-D)", "Dg", true}
+};
 
 // ****************************************************************************************************
 // Main Function
@@ -145,12 +269,16 @@ CacheLine **cache;                  // Struct CacheLine double pointer = cache
 // --- input arguments and a file with a list of addresses in hexidecimal addresses, displaying the
 // --- hexidecimal address followed by 'H' for hit or 'M' for miss. The program will then calculate
 // --- the results of the simulated cache and display the results using the given printResult function.
-// ---
+// --- The other options choose a different mode of running the trace (see checkOptions), and every
+// --- mode leaves what it allocated for main to free, whether it finished or failed.
 // ****************************************************************************************************
 int main(int argc, char **argv)
 {
-    // Close program if argument list contains wrong number of arguments
-    if(argc != NUMARGS)
+    // Function Variables
+    RunMode mode;                   // Mode the trace is run in, chosen by the options given
+
+    // Close program if argument list is missing required arguments
+    if(argc < NUMARGS)
     {
         printf("[ERROR] Invalid number of arguments given ... [EXITING PROGRAM]\n");
         return 0;
@@ -159,70 +287,397 @@ int main(int argc, char **argv)
     // Initialize argument list into empty cache
     initialize(argc, argv);
 
-    // Allocate cache
-    cache = (CacheLine **)malloc(sizeof(CacheLine *) * numSets);
-    for (i = 0; i < numSets; i++) 
+    // Close program if an option given is not one of the mode's or the options contradict each other
+    if(checkOptions(&mode) == false)
+    {
+        return 0;
+    }
+
+    // Print the output of an earlier run with the same inputs instead of simulating again
+    if(resultDir != NULL && resultCache())
+    {
+        return 0;
+    }
+
+    // Run the trace in its mode, keeping the output for the result cache only if the run finished
+    resultComplete = runTrace(mode);
+
+    // Free whatever the run allocated before it finished or failed
+    free(hexAddress);
+    free(streamBuffer);
+    free(futureAddresses);
+    free(futureNextUses);
+    windowDestroy();
+    if(pFile != NULL)
+    {
+        fclose(pFile);
+    }
+    cacheDestroy(cache);
+    timingDestroy(timing);
+    dramDestroy(dram);
+    regionDestroy(regions);
+
+    return 0;
+}
+
+// ****************************************************************************************************
+// Check Options Function
+// --- Chooses the mode of the run from the options given into mode and checks every option given is
+// --- one of COMMON_OPTIONS or the mode's own, then the options that only work together. Displays
+// --- the first problem found and returns false if there is one.
+// ****************************************************************************************************
+bool checkOptions(RunMode *mode)
+{
+    // Function Variables
+    const char *separator;          // Comma after the current shared trace name
+    int numTraces = 1;              // Number of comma separated traces
+    int opt;                        // Index counter for moving through the option letters
+
+    if(fileName == NULL || algorithm == NULL)
+    {
+        printf("[ERROR] -i and -r are required ... [EXITING PROGRAM]\n");
+        return false;
+    }
+
+    // The first mode whose option is given runs the trace, otherwise it is simulated access by access
+    if(strchr(fileName, ',') != NULL)
+    {
+        *mode = MODE_SHARED;
+    }
+    else if(givenOptions['F'])
+    {
+        *mode = MODE_SHARING;
+    }
+    else if(givenOptions['x'] || givenOptions['y'])
+    {
+        *mode = MODE_SPLIT;
+    }
+    else if(givenOptions['P'])
+    {
+        *mode = MODE_PHASES;
+    }
+    else if(givenOptions['Q'])
+    {
+        *mode = MODE_PHASE_SIM;
+    }
+    else if(givenOptions['p'])
+    {
+        *mode = MODE_PARALLEL;
+    }
+    else if(givenOptions['D'])
+    {
+        *mode = MODE_DIFF;
+    }
+    else
     {
-        cache[i] = (CacheLine *)malloc(sizeof(CacheLine) * numLines);
-        for (j = 0; j < numLines; j++)
+        *mode = MODE_SIMULATE;
+    }
+
+    // Any other option would be silently ignored by the mode
+    for (opt = 1; opt < OPTION_LETTERS; opt++)
+    {
+        if(givenOptions[opt] && strchr(COMMON_OPTIONS, opt) == NULL && strchr(MODES[*mode].options, opt) == NULL)
         {
-            //Set cache[i][j] to emptyLine
-            cache[i][j] = emptyLine;
-            //printf("Cache[%i][%i] : ValidBit: %i Tag: %lli LRUCount: %i\n", i, j, cache[i][j].validBit, cache[i][j].tag, cache[i][j].lruCount); // ----------- Cache Allocation Check
+            printf("[ERROR] -%c is Not Available in %s ... [EXITING PROGRAM]\n", opt, MODES[*mode].name);
+            return false;
         }
     }
+    if(strcmp(algorithm, OPTIMAL) == 0 && MODES[*mode].optimal == false)
+    {
+        printf("[ERROR] Optimal Algorithm Not Available in %s ... [EXITING PROGRAM]\n", MODES[*mode].name);
+        return false;
+    }
+
+    // A checkpoint is saved after a given access, and only into a given file
+    if(givenOptions['c'] != givenOptions['n'] || (givenOptions['c'] && checkpointAt < 1))
+    {
+        printf("[ERROR] -c requires -n of at least 1 and -n requires -c ... [EXITING PROGRAM]\n");
+        return false;
+    }
+
+    // A checkpoint holds the cache and its counters, not the timing model's in-flight misses, the open DRAM rows,
+    // or the per-region counters, and the optimal algorithm reads the trace ahead, so it cannot resume it
+    if((givenOptions['c'] || givenOptions['l']) && (givenOptions['M'] || givenOptions['d'] || givenOptions['A'] || strcmp(algorithm, OPTIMAL) == 0))
+    {
+        printf("[ERROR] -c and -l are Not Available with optimal, -M, -d, or -A ... [EXITING PROGRAM]\n");
+        return false;
+    }
+
+    // The lookahead window streams the trace through the optimal algorithm alone
+    if(lookahead < 0 || (givenOptions['o'] && strcmp(algorithm, OPTIMAL) != 0))
+    {
+        printf("[ERROR] -o requires -r optimal and a lookahead of 0 or more ... [EXITING PROGRAM]\n");
+        return false;
+    }
+
+    // Timestamps and the memory behind the cache only shape the timing model
+    if((givenOptions['T'] || givenOptions['L'] || givenOptions['B'] || givenOptions['I']) && numMshrs <= 0)
+    {
+        printf("[ERROR] -T, -L, -B, and -I require -M of at least 1 ... [EXITING PROGRAM]\n");
+        return false;
+    }
+
+    // The split hierarchy needs both L1 caches, and neither reads the trace ahead
+    if(*mode == MODE_SPLIT && (instructionModel == NULL || dataModel == NULL || strstr(instructionModel, OPTIMAL) != NULL
+        || strstr(dataModel, OPTIMAL) != NULL))
+    {
+        printf("[ERROR] -x and -y go together and neither is Available with optimal ... [EXITING PROGRAM]\n");
+        return false;
+    }
+
+    // Phases are groups of at least one interval of at least one access
+    if(*mode == MODE_PHASES && (phaseLength <= 0 || maxPhases <= 0))
+    {
+        printf("[ERROR] -P and -K must be at least 1 ... [EXITING PROGRAM]\n");
+        return false;
+    }
+
+    // Every shared trace is a tenant of the one cache, which holds at most CACHE_MAX_TENANTS
+    for (separator = strchr(fileName, ','); separator != NULL; separator = strchr(separator + 1, ','))
+    {
+        numTraces++;
+    }
+    if(numTraces > CACHE_MAX_TENANTS)
+    {
+        printf("[ERROR] %d Shared Traces Given - At Most %d Share a Cache ... [EXITING PROGRAM]\n", numTraces, CACHE_MAX_TENANTS);
+        return false;
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Run Trace Function
+// --- Creates the cache, opens the trace, and runs it in mode. Everything allocated is left in the
+// --- globals for main to free. Returns false if the run failed.
+// ****************************************************************************************************
+bool runTrace(RunMode mode)
+{
+    // Function Variables
+    CacheConfig config;             // Geometry and algorithm of the simulated cache
+
+    // Allocate cache
+    cacheConfig(&config);
+    cache = cacheCreate(&config);
+
+    // Exit if algorithm or geometry is invalid
+    if(cache == NULL)
+    {
+        printf("[ERROR] Given Algorithm, Index Hash, or Cache Size Invalid - Use lru, fifo, optimal, hawkeye, or plugin:path.so ... [EXITING PROGRAM]\n");
+        return false;
+    }
+
+    // Share one cache between several comma separated traces, each read by sharedSim
+    if(mode == MODE_SHARED)
+    {
+        return sharedSim();
+    }
+
+    // Time the accesses with overlapping misses instead of a fixed penalty per miss
+    if(numMshrs > 0 && (timing = timingCreate(&(TimingConfig){numMshrs, HIT_TIME, memoryLatency, transferCycles, issueInterval}, blockOffsetBits)) == NULL)
+    {
+        printf("[ERROR] Invalid Timing Model - Check -M, -L, -B, and -I ... [EXITING PROGRAM]\n");
+        return false;
+    }
 
     // Open file containing addresses
-    pFile = fopen(fileName, "r");
+    pFile = fopen(fileName, "rb");
 
     // Exit if file is empty
     if(pFile == NULL)
     {
         printf("[ERROR] File = NULL ... [EXITING PROGRAM]\n");
-        return 0;
+        return false;
+    }
+
+    // Answer misses by DRAM bank and row instead of a fixed penalty
+    if(dramSpec != NULL)
+    {
+        if(parseDram(dramSpec, &dramConfig) == false || (dram = dramCreate(&dramConfig, blockOffsetBits)) == NULL)
+        {
+            printf("[ERROR] Invalid -d DRAM - use key=value pairs of channels,ranks,banks,row,map,hit,empty,conflict ... [EXITING PROGRAM]\n");
+            return false;
+        }
+        if(timing != NULL)
+        {
+            timingSetDram(timing, dram);
+        }
     }
 
-    // Initialize hits, misses, and evictions to 0
-    hits = 0;
-    misses = 0;
-    evictions = 0;
+    // Skip the header of a binary trace, otherwise read the file as text
+    binaryTrace = readTraceHeader(&pFile);
+
+    // Timestamps, threads, and access kinds are only found in text traces
+    if(binaryTrace && (timestamped || mode == MODE_SHARING || mode == MODE_SPLIT))
+    {
+        printf("[ERROR] -T, -F, -x, and -y require a text trace ... [EXITING PROGRAM]\n");
+        return false;
+    }
 
     // Allocate memory for hexAddress
     hexAddress = malloc(HEXMAX * sizeof(char));
 
-    // Initialize "clock" time
-    clock = 0;
+    switch (mode)
+    {
+        // Find the blocks threads share instead of simulating the trace
+        case MODE_SHARING:
+            return sharingAnalysis();
+
+        // Simulate split L1 instruction and data caches in front of the cache as a unified L2
+        case MODE_SPLIT:
+            return splitSim();
+
+        // Group the intervals of the trace into phases instead of simulating it
+        case MODE_PHASES:
+            return phaseAnalysis();
+
+        // Simulate only the interval representing each phase and extrapolate the whole trace
+        case MODE_PHASE_SIM:
+            return phaseSim();
+
+        // Simulate time slices in parallel instead of one address at a time
+        case MODE_PARALLEL:
+            return parallelSim();
+
+        // Compare with a second model access by access, reading the trace ahead if either is optimal
+        case MODE_DIFF:
+            if((strcmp(algorithm, OPTIMAL) == 0 || strstr(diffModel, OPTIMAL) != NULL) && readFuture(pFile) == false)
+            {
+                printf("[ERROR] Could not read trace ahead ... [EXITING PROGRAM]\n");
+                return false;
+            }
+            return diffSim();
+
+        default:
+            return simulateTrace();
+    }
+}
+
+// ****************************************************************************************************
+// Simulate Trace Function
+// --- Simulates the trace in pFile access by access, displaying the hexidecimal address followed by
+// --- 'H' for hit or 'M' for miss, saving or restoring a checkpoint and printing the warm-up and
+// --- interval counters on the way. Then calculates the results of the simulated cache and displays
+// --- them using the given printResult function. Returns false if the run could not start.
+// ****************************************************************************************************
+bool simulateTrace(void)
+{
+    // Function Variables
+    CacheStats stats;               // Counters of the simulated cache for the result
+    unsigned long long address;     // Address read from the input file
+
+    // Split the counters by the named address ranges of the region map
+    if(regionFile != NULL && loadRegions(regionFile) == false)
+    {
+        printf("[ERROR] Invalid -A region map %s - use /proc/<pid>/maps or lines of start-end name in hex, no ranges overlapping ... [EXITING PROGRAM]\n", regionFile);
+        return false;
+    }
+
+    // Read the whole trace and the next use of every access for the optimal algorithm
+    if(strcmp(algorithm, OPTIMAL) == 0 && lookahead == 0 && readFuture(pFile) == false)
+    {
+        printf("[ERROR] Could not read trace ahead ... [EXITING PROGRAM]\n");
+        return false;
+    }
+
+    // Or only the next lookahead accesses at a time, in memory bounded by the window
+    if(lookahead > 0 && windowCreate() == false)
+    {
+        printf("[ERROR] Could not allocate a lookahead window of %ld accesses ... [EXITING PROGRAM]\n", lookahead);
+        return false;
+    }
 
-    //Print error for optimal algorithm not being complete
-    if(strcmp(algorithm, OPTIMAL) == 0)
+    // Restore cache state and trace position from a previous run's checkpoint
+    if(restoreFile != NULL && loadCheckpoint(restoreFile) == false)
     {
-        printf("[ERROR] Optimal Algorithm Not Available ...\n");
+        printf("[ERROR] Could not restore checkpoint %s ... [EXITING PROGRAM]\n", restoreFile);
+        return false;
     }
 
-    // While addresses left in input file, read each line and store as string hexAddress
-    while(fscanf(pFile, "%s", hexAddress) > 0)
+    // A checkpoint at an access the restored run has already passed would never be saved
+    if(checkpointFile != NULL && checkpointAt <= accessCount)
     {
-        // Print line of file
-        printf("%s ", hexAddress);
+        printf("[ERROR] -n %lld is not after the %lld accesses restored from %s ... [EXITING PROGRAM]\n", checkpointAt, accessCount, restoreFile);
+        return false;
+    }
 
-        // Convert hexidecimal line to binary
-        binaryAddress = hexToBinary(hexAddress);
-        //printf("\nBinary Address: %s\n", binaryAddress); // ---------------------------------------------------------------------------------------------------- Binary address check
-        //printf("Length of Binary Address: %li\n", strlen(binaryAddress)); // ------------------------------------------------------------------------- Length of binary address check
+    // Quiet runs with nothing to do between accesses go through the engine a batch at a time
+    if(quiet && timing == NULL && dram == NULL && futureAddresses == NULL && window == NULL && checkpointFile == NULL
+        && regions == NULL && warmUp == 0 && interval == 0)
+    {
+        batchSim();
+    }
 
+    // While addresses left in input file, read each address
+    while(readAddress(pFile, &address))
+    {
         // Compare to cache display result
-        cacheSim(binaryAddress);
-        
+        cacheSim(address);
+
         // Increment size (number of addresses within file) for result calculations
         size++;
+        accessCount++;
+
+        // Save cache state once the checkpoint access index has been simulated
+        if(checkpointFile != NULL && accessCount == checkpointAt && saveCheckpoint(checkpointFile) == false)
+        {
+            printf("[ERROR] Could not save checkpoint %s ...\n", checkpointFile);
+        }
+
+        // Once the warm-up window has passed, reset counters so cold-start misses are not counted
+        if(warmUp > 0 && accessCount == warmUp)
+        {
+            cacheGetStats(cache, &stats);
+            printf("[warmup] accesses: %lld hits: %lld misses: %lld evictions: %lld\n", accessCount, stats.hits, stats.misses, stats.evictions);
+            cacheResetStats(cache);
+            if(timing != NULL)
+            {
+                timingResetStats(timing);
+            }
+            if(dram != NULL)
+            {
+                dramResetStats(dram, dramCycle);
+                dramCycle = 0;
+            }
+            if(window != NULL)
+            {
+                windowResetStats();
+            }
+            if(regions != NULL)
+            {
+                regionResetStats(regions);
+            }
+            size = 0;
+            intervalHits = 0;
+            intervalMisses = 0;
+            intervalEvictions = 0;
+        }
+        // Else if an interval has ended past the warm-up window, print its statistics
+        else if(interval > 0 && accessCount > warmUp && (accessCount - warmUp) % interval == 0)
+        {
+            printInterval(accessCount);
+        }
     }
 
-    // Free malloc'd hexAddress and binaryAddress memory
-    free(hexAddress);
-    free(binaryAddress);
+    // Report a checkpoint the trace ended before
+    if(checkpointFile != NULL && accessCount < checkpointAt)
+    {
+        printf("[ERROR] Trace ended after %lld accesses, before -n %lld - checkpoint %s not saved ...\n", accessCount, checkpointAt, checkpointFile);
+    }
+
+    // Print statistics of the last partial interval
+    if(interval > 0 && accessCount > warmUp && (accessCount - warmUp) % interval != 0)
+    {
+        printInterval(accessCount);
+    }
 
     // Calculate miss rate as decimal percentage casting misses and hits to float
-    missRate = (((float)(misses) * 100) / ((float)(hits) + misses));
+    cacheGetStats(cache, &stats);
+    missRate = 0;
+    if(stats.hits + stats.misses > 0)
+    {
+        missRate = (((double)(stats.misses) * 100) / ((double)(stats.hits) + stats.misses));
+    }
     //printf("Miss Rate: %Lf\n", missRate); // ------------------------------------------------------------------------------------------------------------------------ Miss rate check
     
     // Calculate average access time using missRateFloat
@@ -231,33 +686,77 @@ int main(int argc, char **argv)
     // Calculate total run time
     runTime = totalRunTime(size, avgAccessTime);
 
-    // Print result
-    printResult(hits, misses, missRate, runTime);
-
-    // Remember to close file when done
-    fclose(pFile);
-
-    // Free malloc'd cache memory
-    for (i = 0; i < numSets - 1; i++) // ------------------------------------- (i = 0; i < numSets; i++) -> attempt to free the last cache[i] causes a segmentation fault (core dumped)
+    // With the timing model, overlapping misses replace the fixed penalty per miss
+    if(timing != NULL)
+    {
+        printTiming(runTime);
+        runTime = timingStats.cycles;
+    }
+    // Else with the DRAM model, misses are served one at a time by their bank
+    else if(dram != NULL)
+    {
+        runTime = dramCycle;
+    }
+    if(dram != NULL)
+    {
+        printDram();
+    }
+    if(window != NULL)
     {
-        free(cache[i]);
-        //printf("TEST CHECKPOINT - FREE MALLOC'D CACHE[%i] SUCCESS\n", i); // -------------------------------------------------------------------- Free memory of each cache set check
+        printWindow();
     }
-    free(cache);
+    if(regions != NULL)
+    {
+        printRegions(stats.misses);
+    }
+
+    // Print result
+    printResult(stats.hits, stats.misses, missRate, runTime);
+
+    return true;
 }
 
 // ****************************************************************************************************
 // Initialize Function
-// --- Initializes the list of given arguments in the form :m:s:e:b:i:r: into the
-// --- variables listed below and then calculates S(numSets), E(numLines), B(blockSize), 
-// --- and tagSize before allocating the cache with malloc and setting each block to the
-// --- default emptyBlock
+// --- Initializes the list of given arguments in the form :m:s:e:b:i:r:w:t:c:n:l:p:u:S:E:h:R:W:U:D:g:M:L:B:I:Td:qk:o:P:K:Q:FA:x:y: into the
+// --- variables listed below. The cache itself is allocated by cacheCreate from these arguments.
 // ---                      m = addressSize
 // ---                      s = setBits
 // ---                      e = linesPerSet
 // ---                      b = blockOffsetBits
 // ---                      i = fileName
 // ---                      r = algorithm
+// ---                      w = warmUp      (optional)
+// ---                      t = interval    (optional)
+// ---                      c = checkpointFile  (optional)
+// ---                      n = checkpointAt    (optional)
+// ---                      l = restoreFile     (optional)
+// ---                      p = numSlices       (optional)
+// ---                      u = sliceWarmUp     (optional)
+// ---                      S = numSets         (optional, replaces s)
+// ---                      E = numWays         (optional, replaces e)
+// ---                      h = indexHash       (optional)
+// ---                      R = tenantRates     (optional)
+// ---                      W = tenantWays      (optional)
+// ---                      U = partitionEpoch  (optional)
+// ---                      D = diffModel       (optional)
+// ---                      g = regionBits      (optional)
+// ---                      M = numMshrs        (optional)
+// ---                      L = memoryLatency   (optional)
+// ---                      B = transferCycles  (optional)
+// ---                      I = issueInterval   (optional)
+// ---                      T = timestamped     (optional, no value)
+// ---                      d = dramSpec        (optional)
+// ---                      q = quiet           (optional, no value)
+// ---                      k = resultDir       (optional)
+// ---                      o = lookahead       (optional)
+// ---                      P = phaseLength     (optional)
+// ---                      K = maxPhases       (optional)
+// ---                      Q = phaseFile       (optional)
+// ---                      F = sharingTrace    (optional, no value)
+// ---                      A = regionFile      (optional)
+// ---                      x = instructionModel (optional)
+// ---                      y = dataModel       (optional)
 // ****************************************************************************************************
 void initialize(int argc, char **argv)
 {
@@ -265,8 +764,10 @@ void initialize(int argc, char **argv)
     int opt;             // Option for switch case to gather argument list
 
     // Initialize Argument List Using getopt() Function
-    while ((opt = getopt(argc, argv, ":m:s:e:b:i:r:")) != -1)
+    while ((opt = getopt(argc, argv, ":m:s:e:b:i:r:w:t:c:n:l:p:u:S:E:h:R:W:U:D:g:M:L:B:I:Td:qk:o:P:K:Q:FA:x:y:")) != -1)
     {
+        // Remember every option given for checkOptions, getopt returns only letters, '?', or ':'
+        givenOptions[opt] = true;
         switch (opt)
         {
             case 'm':
@@ -293,492 +794,2255 @@ void initialize(int argc, char **argv)
                 algorithm = optarg;
                 //printf("algorithm: %s\n", algorithm);
                 break;
+            case 'w':
+                warmUp = atoll(optarg);
+                //printf("warmUp: %lli\n", warmUp);
+                break;
+            case 't':
+                interval = atoll(optarg);
+                //printf("interval: %lli\n", interval);
+                break;
+            case 'c':
+                checkpointFile = optarg;
+                //printf("checkpointFile: %s\n", checkpointFile);
+                break;
+            case 'n':
+                checkpointAt = atoll(optarg);
+                //printf("checkpointAt: %lli\n", checkpointAt);
+                break;
+            case 'l':
+                restoreFile = optarg;
+                //printf("restoreFile: %s\n", restoreFile);
+                break;
+            case 'p':
+                numSlices = atoi(optarg);
+                //printf("numSlices: %i\n", numSlices);
+                break;
+            case 'u':
+                sliceWarmUp = atol(optarg);
+                //printf("sliceWarmUp: %li\n", sliceWarmUp);
+                break;
+            case 'S':
+                numSets = atoi(optarg);
+                //printf("numSets: %i\n", numSets);
+                break;
+            case 'E':
+                numWays = atoi(optarg);
+                //printf("numWays: %i\n", numWays);
+                break;
+            case 'h':
+                indexHash = optarg;
+                //printf("indexHash: %s\n", indexHash);
+                break;
+            case 'R':
+                tenantRates = optarg;
+                //printf("tenantRates: %s\n", tenantRates);
+                break;
+            case 'W':
+                tenantWays = optarg;
+                //printf("tenantWays: %s\n", tenantWays);
+                break;
+            case 'U':
+                partitionEpoch = atol(optarg);
+                //printf("partitionEpoch: %li\n", partitionEpoch);
+                break;
+            case 'D':
+                diffModel = optarg;
+                //printf("diffModel: %s\n", diffModel);
+                break;
+            case 'g':
+                regionBits = atoi(optarg);
+                //printf("regionBits: %i\n", regionBits);
+                break;
+            case 'M':
+                numMshrs = atoi(optarg);
+                //printf("numMshrs: %i\n", numMshrs);
+                break;
+            case 'L':
+                memoryLatency = atoi(optarg);
+                //printf("memoryLatency: %i\n", memoryLatency);
+                break;
+            case 'B':
+                transferCycles = atoi(optarg);
+                //printf("transferCycles: %i\n", transferCycles);
+                break;
+            case 'I':
+                issueInterval = atoi(optarg);
+                //printf("issueInterval: %i\n", issueInterval);
+                break;
+            case 'T':
+                timestamped = true;
+                //printf("timestamped: %i\n", timestamped);
+                break;
+            case 'd':
+                dramSpec = optarg;
+                //printf("dramSpec: %s\n", dramSpec);
+                break;
+            case 'q':
+                quiet = true;
+                //printf("quiet: %i\n", quiet);
+                break;
+            case 'k':
+                resultDir = optarg;
+                //printf("resultDir: %s\n", resultDir);
+                break;
+            case 'o':
+                lookahead = atol(optarg);
+                //printf("lookahead: %li\n", lookahead);
+                break;
+            case 'P':
+                phaseLength = atoll(optarg);
+                //printf("phaseLength: %lli\n", phaseLength);
+                break;
+            case 'K':
+                maxPhases = atoi(optarg);
+                //printf("maxPhases: %i\n", maxPhases);
+                break;
+            case 'Q':
+                phaseFile = optarg;
+                //printf("phaseFile: %s\n", phaseFile);
+                break;
+            case 'F':
+                sharingTrace = true;
+                //printf("sharingTrace: %i\n", sharingTrace);
+                break;
+            case 'A':
+                regionFile = optarg;
+                //printf("regionFile: %s\n", regionFile);
+                break;
+            case 'x':
+                instructionModel = optarg;
+                //printf("instructionModel: %s\n", instructionModel);
+                break;
+            case 'y':
+                dataModel = optarg;
+                //printf("dataModel: %s\n", dataModel);
+                break;
             default:
                 printf("Error: Please check format of arguments ... \n");
                 exit(1);
         }
     }
+}
 
-    // Calculate Number of Sets (S = 2^s)
-    numSets = pow(2, setBits);
-
-    // Calculate Number of Lines (E = 2^e)
-    numLines = pow(2, linesPerSet);
-
-    // Calculate Block Size (B = 2^b)
-    blockSize = pow(2, blockOffsetBits);
-
-    // Calculate Tag Size
-    tagSize = ( addressSize - setBits ) - blockOffsetBits;
-
+// ****************************************************************************************************
+// Cache Config Function
+// --- Fills config with the geometry, algorithm, and set index function given as arguments
+// ****************************************************************************************************
+void cacheConfig(CacheConfig *config)
+{
+    config->addressSize = addressSize;
+    config->setBits = setBits;
+    config->linesPerSet = linesPerSet;
+    config->blockOffsetBits = blockOffsetBits;
+    config->algorithm = algorithm;
+    config->sets = numSets;
+    config->ways = numWays;
+    config->indexHash = indexHash;
 }
 
 // ****************************************************************************************************
 // Cache Sim Function
-// --- Simulates the cache by comparing the given cache struct and char* address, a string
-// --- representation of the address in binary being searched in the cache
-// ****************************************************************************************************
-void cacheSim(char *address)
-{
-    // CacheSim Variables
-    char *tagString;                // String representation of tag from address parameter
-    char *setBuffer;                // String representation of set and offset
-    char *setString;                // String representation of tag from address parameter
-    unsigned long long tag;         // Integer representation of tag from address parameter
-    unsigned long long set;         // Integer representation of set from address parameter
-    int lruIndex;                   // Index of least recently used within cache set
-    int fifoIndex;                  // Index of first in within the cache set
-    bool insertFlag = false;        // Flag indicating insertion of searchAddress into cache
-    bool hitFlag = false;           // Flag indicating hit of searchAddress within the cache
-    bool fullSet = false;           // Flag indicating a full set within the cache
-
-    // Extract tag from address as string and convert to unsigned long long integer
-    tag = binToDecimal((unsigned long long)atoi(memcpy(tagString, address, tagSize)));
-    setBuffer = &address[tagSize];
-
-    // Extract set from address as string and convert to unsigned long long integer
-    strncpy(setString, setBuffer, setBits);
-    set = binToDecimal(atoi(setString));
-
-    // TEST PRINTOUTS ( Uncomment to display within output)
-    //printf("\nTag String: %s\n", tagString); // -------------------------------------------------------------------------------------------------------------------- Tag string check
-    //printf("Tag: %llu\n", tag); // ---------------------------------------------------------------------------------------------------------------------------------------- Tag check
-    //printf("Length of Tag String: %li\n", strlen(tagString)); // ----------------------------------------------------------------------------------------- Length of tag string check
-    //printf("&address[tagSize] - Set and offset bits: %s\n", &address[tagSize]); // -------------------------------------------------------------------------- &address[tagSize] check
-    //printf("Set String: %s\n", setString); // ---------------------------------------------------------------------------------------------------------------------- Set string check
-    //printf("Set: %llu\n", set); // ---------------------------------------------------------------------------------------------------------------------------------------- Set check
-
-    // If algorithm is LRU, perform least recently used algorithm
-    if(strcmp(algorithm, LRU) == 0)
-    {
-        // For each cache line within the set
-        for (i = 0; i < numLines; i++)
-        {
-            // Increment "clock" time for each line
-            clock++;
-
-            // If memory hasn't been added into cache
-            if(insertFlag == false && hitFlag == false)
-            {
-                // If cache line is empty, insert memory and increment lruCount and misses
-                if (cache[set][i].validBit == false)
-                {
-                    cache[set][i].validBit = true;
-                    cache[set][i].tag = tag;
-                    cache[set][i].lruCount = clock;
-                    misses++;
-                    printf("M\n");
-                    insertFlag = true;
-                    //printf("Cache[%lli][%i] : ValidBit: %i Tag: %lli LRUCount: %i\n\n", set, i, cache[set][i].validBit, cache[set][i].tag, cache[set][i].lruCount); // ------------ Cache block check
-                }
-                // Else if cache line tag equals searchAddress tag, display hit and increment lruCount and hits
-                else if (cache[set][i].validBit == true && cache[set][i].tag == tag)
-                {
-                    cache[set][i].lruCount = clock;
-                    hits++;
-                    printf("H\n");
-                    hitFlag = true;
-                    //printf("Cache[%lli][%i] : ValidBit: %i Tag: %lli LRUCount: %i\n\n", set, i, cache[set][i].validBit, cache[set][i].tag, cache[set][i].lruCount); // ------------ Cache block check
-                }
-                // Else cache set is full, set fullSet flag to true
-                else //if (i == numLines - 1 && cache[set][i].validBit == true)
-                {
-                    fullSet = true;
-                }
-            }   
-        }
-        // If address wasn't hit and cache is full, evict LRU and replace
-        if(insertFlag == false && hitFlag == false && fullSet == true)
-        {
-            lruIndex = leastRecentlyUsed(set);
-            cache[set][lruIndex].validBit = true;
-            cache[set][lruIndex].tag = tag;
-            cache[set][lruIndex].lruCount = clock;
-            misses++;
-            evictions++;
-            printf("M\n"); 
-            //printf("Cache[%lli][%i] : ValidBit: %i Tag: %lli LRUCount: %i\n\n", set, i, cache[set][i].validBit, cache[set][i].tag, cache[set][i].lruCount); // -------------------- Cache block check
-        } 
-    }
-    // Else if algorithm is FIFO then perform first-in first-out algorithm
-    else if(strcmp(algorithm, FIFO) == 0)
+// --- Simulates the given address in the cache and displays the address in hexidecimal followed
+// --- by 'H' for a hit or 'M' for a miss
+// ****************************************************************************************************
+void cacheSim(unsigned long long address)
+{
+    // Function Variables
+    CacheResult result;             // Outcome of the access
+
+    // With the trace read ahead, the address just handed out has its next use known
+    if(futureNextUses != NULL)
     {
-        // For each cache line within the set
-        for (i = 0; i < numLines; i++)
-        {
-            // If memory hasn't been added into cache or found within the cache
-            if(insertFlag == false && hitFlag == false)
-            {
-                // If cache line is empty, insert memory and increment fifoCount and misses
-                if (cache[set][i].validBit == false)
-                {
-                    cache[set][i].validBit = true;
-                    cache[set][i].tag = tag;
-                    cache[set][i].fifoCount = 0;
-                    misses++;
-                    printf("M\n");
-                    insertFlag = true;
-                    //printf("Cache[%lli][%i] : ValidBit: %i Tag: %lli fifoCount: %i\n\n", set, i, cache[set][i].validBit, cache[set][i].tag, cache[set][i].fifoCount); // ---------- Cache block check
-                }
-                // Else if cache line tag equals searchAddress tag, display hit and increment lruCount and hits
-                else if (cache[set][i].validBit == true && cache[set][i].tag == tag)
-                {
-                    cache[set][i].validBit = true;
-                    cache[set][i].tag = tag;
-                    hits++;
-                    printf("H\n");
-                    insertFlag = true;
-                    //printf("Cache[%lli][%i] : ValidBit: %i Tag: %lli fifoCount: %i\n\n", set, i, cache[set][i].validBit, cache[set][i].tag, cache[set][i].fifoCount); // ---------- Cache block check
-                }
-                // Else cache line is full, increment fifoCount of current cacheline
-                else if (cache[set][i].validBit == true)
-                {
-                    cache[set][i].fifoCount++;
-                }
-                // Else cache set is full, set fullSet flag to true
-                if (cache[set][numLines - 1].validBit == true)
-                {
-                    fullSet = true;
-                }
-            }   
-        }
-        // If address wasn't hit and cache is full, evict First In and replace
-        if(insertFlag == false && hitFlag == false && fullSet == true)
-        {
-            fifoIndex = firstInFirstOut(set);
-            cache[set][fifoIndex].validBit = true;
-            cache[set][fifoIndex].tag = tag;
-            cache[set][fifoIndex].fifoCount = 0;
-            misses++;
-            evictions++;
-            printf("M\n"); 
-            //printf("Cache[%lli][%i] : ValidBit: %i Tag: %lli fifoCount: %i\n\n", set, i, cache[set][i].validBit, cache[set][i].tag, cache[set][i].fifoCount); // ------------------ Cache block check
-        } 
+        result = cacheAccessNext(cache, address, futureNextUses[futurePosition - 1]);
     }
-    // Else if algorithm is OPTIMAL then perform optimal algorithm
-    else if(strcmp(algorithm, OPTIMAL) == 0)
+    // With the lookahead window, only next uses within it are known
+    else if(window != NULL)
     {
-        printf("\n");
-
-        /**************************************************************************************************************************************************************************************************************
-         
-        // For each cache line within the set
-        for (i = 0; i < numLines; i++)
-        {
-            // If memory hasn't been added into cache or found within the cache
-            if(insertFlag == false && hitFlag == false)
-            {
-                // If cache line is empty, insert memory, increment misses, and set futureCount using farthestInFuture function
-                if (cache[set][i].validBit == false)
-                {
-                    cache[set][i].validBit = true;
-                    cache[set][i].tag = tag;
-                    cache[set][i].futureCount = farthestInFuture(tag, set);
-                    misses++;
-                    printf("M\n");
-                    insertFlag = true;
-                    //printf("Cache[%lli][%i] : ValidBit: %i Tag: %lli futureCount: %i\n\n", set, i, cache[set][i].validBit, cache[set][i].tag, cache[set][i].futureCount); // ----------------------- Cache block check
-                }
-                // Else if cache line tag equals searchAddress tag, display hit, increment hits, and get futureCount
-                else if (cache[set][i].validBit == true && cache[set][i].tag == tag)
-                {
-                    cache[set][i].validBit = true;
-                    cache[set][i].tag = tag;
-                    cache[set][i].futureCount = farthestInFuture(tag, set);
-                    hits++;
-                    printf("H\n");
-                    insertFlag = true;
-                    //printf("Cache[%lli][%i] : ValidBit: %i Tag: %lli futureCount: %i\n\n", set, i, cache[set][i].validBit, cache[set][i].tag, cache[set][i].futureCount); // ----------------------- Cache block check
-                }
-                // Else cache line is full, decrement futureCount of current cacheline
-                else if (cache[set][i].validBit == true)
-                {
-                    cache[set][i].futureCount--;
-                }
-                // Else cache set is full, set fullSet flag to true
-                if (cache[set][numLines - 1].validBit == true)
-                {
-                    fullSet = true;
-                }
-            }   
-        }
-        // If address wasn't hit and cache is full, evict farthestInFuture and replace
-        if(insertFlag == false && hitFlag == false && fullSet == true)
-        {
-            cache[set][futureIndex].validBit = true;
-            cache[set][futureIndex].tag = tag;
-            cache[set][futureIndex].futureCount = farthestInFuture(cache[set][futureIndex].tag, set);
-            misses++;
-            evictions++;
-            printf("M\n"); 
-            //printf("Cache[%lli][%i] : ValidBit: %i Tag: %lli futureCount: %i\n\n", set, i, cache[set][i].validBit, cache[set][i].tag, cache[set][i].futureCount); // ------------------------------- Cache block check
-        } 
-        
-        **************************************************************************************************************************************************************************************************************/
-    }
-    // Else algorithm is not valid
+        result = windowAccess(address);
+    }
     else
     {
-        printf("\n[ERROR] Given Algorithm Invalid - Use lru, fifo, or optimal ...\n");
+        result = cacheAccess(cache, address);
     }
-}
-
-// ****************************************************************************************************
-// Least Recently Used Function
-// --- Sets least to the lruCount of the first line in the set and then compares each line of the set
-// --- returning the index of the least recently used block within the given set.
-// --- Lower number = least recent.
-// ****************************************************************************************************
-int leastRecentlyUsed(int set)
-{
-    // Function Variables
-    int least = cache[set][0].lruCount;
-    int index = 0;
 
-    // For each line of cache of given set
-    for (i = 0; i < numLines; i++)
+    if(regions != NULL)
     {
-        // If least is less than cache[set][i].lruCount
-        if (least >= cache[set][i].lruCount)
+        regionAccess(regions, address, result, result == CACHE_EVICT ? cacheLastVictim(cache) : 0);
+    }
+
+    if(timing != NULL)
+    {
+        timingAccess(timing, address, result, issueCycle);
+    }
+    else if(dram != NULL)
+    {
+        dramCycle += HIT_TIME;
+        if(result != CACHE_HIT)
+        {
+            dramCycle = dramAccess(dram, address, dramCycle);
+        }
+    }
+
+    if(quiet)
+    {
+        return;
+    }
+    else if(result == CACHE_HIT)
+    {
+        printf("%llx H\n", address);
+    }
+    else
+    {
+        printf("%llx M\n", address);
+    }
+}
+
+// ****************************************************************************************************
+// Batch Sim Function
+// --- Reads the rest of the trace BATCH_ADDRESSES at a time and simulates each batch with
+// --- cacheAccessBatch, which prefetches the sets of the accesses ahead, counting the addresses for
+// --- the result. Only for runs that neither print nor time every access.
+// ****************************************************************************************************
+void batchSim(void)
+{
+    // Function Variables
+    unsigned long long *addresses;  // Addresses of the current batch
+    long count;                     // Number of addresses of the current batch
+
+    addresses = malloc(BATCH_ADDRESSES * sizeof(unsigned long long));
+    if(addresses == NULL)
+    {
+        return;
+    }
+
+    do
+    {
+        for (count = 0; count < BATCH_ADDRESSES && readAddress(pFile, &addresses[count]); count++)
+        {
+        }
+        cacheAccessBatch(cache, addresses, count, NULL);
+        size += count;
+        accessCount += count;
+    } while(count == BATCH_ADDRESSES);
+
+    free(addresses);
+}
+
+// ****************************************************************************************************
+// Save Checkpoint Function
+// --- Writes a compact binary snapshot of the simulation to the given file: a Checkpoint header
+// --- holding the counters and byte offset into the trace, followed by the cache state written by
+// --- cacheSave. Returns false if the file could not be written.
+// ****************************************************************************************************
+bool saveCheckpoint(char *name)
+{
+    // Function Variables
+    Checkpoint header;              // Header written before the cache state
+    FILE *pCheckpoint;              // Checkpoint file pointer
+    bool written;                   // Flag indicating every write succeeded
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.offset = ftell(pFile) - (streamCount - streamPosition) * (long)sizeof(unsigned long long);
+    header.accessCount = accessCount;
+    header.size = size;
+    header.intervalHits = intervalHits;
+    header.intervalMisses = intervalMisses;
+    header.intervalEvictions = intervalEvictions;
+
+    pCheckpoint = fopen(name, "wb");
+    if(pCheckpoint == NULL)
+    {
+        return false;
+    }
+
+    // Write header followed by the cache state
+    written = fwrite(&header, sizeof(header), 1, pCheckpoint) == 1 && cacheSave(cache, pCheckpoint);
+
+    if(fclose(pCheckpoint) != 0)
+    {
+        written = false;
+    }
+
+    if(written)
+    {
+        printf("[checkpoint] saved: %s accesses: %lld offset: %ld\n", name, accessCount, header.offset);
+    }
+
+    return written;
+}
+
+// ****************************************************************************************************
+// Load Checkpoint Function
+// --- Reads a snapshot written by saveCheckpoint back into the cache and counters, then seeks the
+// --- input file to the stored byte offset so the simulation continues where the snapshot was taken.
+// --- Returns false if the file is missing, corrupt, or was taken with a different geometry.
+// ****************************************************************************************************
+bool loadCheckpoint(char *name)
+{
+    // Function Variables
+    Checkpoint header;              // Header read before the cache state
+    FILE *pCheckpoint;              // Checkpoint file pointer
+    bool valid;                     // Flag indicating the checkpoint matches the given arguments
+
+    pCheckpoint = fopen(name, "rb");
+    if(pCheckpoint == NULL)
+    {
+        return false;
+    }
+
+    // Check header and cache state match the arguments of this run
+    valid = fread(&header, sizeof(header), 1, pCheckpoint) == 1
+        && memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) == 0
+        && header.version == CHECKPOINT_VERSION
+        && cacheRestore(cache, pCheckpoint);
+
+    fclose(pCheckpoint);
+
+    if(valid == false || fseek(pFile, header.offset, SEEK_SET) != 0)
+    {
+        return false;
+    }
+
+    streamCount = 0;
+    streamPosition = 0;
+    accessCount = header.accessCount;
+    size = header.size;
+    intervalHits = header.intervalHits;
+    intervalMisses = header.intervalMisses;
+    intervalEvictions = header.intervalEvictions;
+
+    printf("[checkpoint] restored: %s accesses: %lld offset: %ld\n", name, accessCount, header.offset);
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Read Probe Function
+// --- fopencookie read function of a piped text trace: hands out the bytes the header probe took
+// --- from the pipe, then the rest of the pipe. Returns the bytes read, 0 at the end, -1 on error.
+// ****************************************************************************************************
+static ssize_t readProbe(void *cookie, char *buffer, size_t length)
+{
+    // Function Variables
+    TraceProbe *probe = cookie;     // Probed bytes and the pipe behind them
+    size_t count;                   // Bytes handed out
+
+    if(probe->position < probe->count)
+    {
+        count = probe->count - probe->position < length ? probe->count - probe->position : length;
+        memcpy(buffer, &probe->bytes[probe->position], count);
+        probe->position += count;
+        return count;
+    }
+
+    count = fread(buffer, 1, length, probe->file);
+    return count == 0 && ferror(probe->file) ? -1 : (ssize_t)count;
+}
+
+// ****************************************************************************************************
+// Close Probe Function
+// --- fopencookie close function of a piped text trace: closes the pipe and frees the probe
+// ****************************************************************************************************
+static int closeProbe(void *cookie)
+{
+    // Function Variables
+    TraceProbe *probe = cookie;     // Probed bytes and the pipe behind them
+    int result = fclose(probe->file);
+
+    free(probe);
+    return result;
+}
+
+// ****************************************************************************************************
+// Read Trace Header Function
+// --- Returns true and leaves *file after the TraceHeader if it is a binary trace, otherwise rewinds
+// --- *file to be read as text. A pipe cannot rewind, so *file is replaced by a stream reading the
+// --- probed bytes back ahead of the rest of the pipe.
+// ****************************************************************************************************
+bool readTraceHeader(FILE **file)
+{
+    // Function Variables
+    TraceHeader header;             // Header of a binary trace
+    size_t count;                   // Bytes read by the probe
+    TraceProbe *probe;              // Probed bytes of a pipe
+    FILE *stream;                   // Stream reading the probed bytes and then the pipe
+
+    count = fread(&header, 1, sizeof(header), *file);
+    if(count == sizeof(header) && memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) == 0 && header.version == TRACE_VERSION)
+    {
+        return true;
+    }
+
+    if(fseek(*file, 0, SEEK_SET) == 0)
+    {
+        return false;
+    }
+
+    probe = malloc(sizeof(TraceProbe));
+    stream = NULL;
+    if(probe != NULL)
+    {
+        probe->file = *file;
+        memcpy(probe->bytes, &header, count);
+        probe->count = count;
+        probe->position = 0;
+        stream = fopencookie(probe, "rb", (cookie_io_functions_t){readProbe, NULL, NULL, closeProbe});
+    }
+    if(stream == NULL)
+    {
+        printf("[ERROR] Could not read back the first %zu bytes of the piped trace ...\n", count);
+        free(probe);
+        return false;
+    }
+
+    *file = stream;
+    return false;
+}
+
+// ****************************************************************************************************
+// Read Address Function
+// --- Reads the next address of file into address, from the trace read ahead or the lookahead window
+// --- if there is one. Returns false at the end of the file.
+// ****************************************************************************************************
+bool readAddress(FILE *file, unsigned long long *address)
+{
+    if(futureAddresses != NULL)
+    {
+        if(futurePosition == futureCount)
+        {
+            return false;
+        }
+        *address = futureAddresses[futurePosition++];
+        return true;
+    }
+    else if(window != NULL)
+    {
+        return readWindow(file, address);
+    }
+
+    return readStream(file, address);
+}
+
+// ****************************************************************************************************
+// Read Stream Function
+// --- Reads the next address of file into address straight from the file. Returns false at the end
+// --- of the file.
+// ****************************************************************************************************
+bool readStream(FILE *file, unsigned long long *address)
+{
+    if(binaryTrace)
+    {
+        // Refill the read-ahead buffer, so memory stays the same whatever the trace length
+        if(streamPosition == streamCount)
+        {
+            if(streamBuffer == NULL && (streamBuffer = malloc(TRACE_CHUNK)) == NULL)
+            {
+                return fread(address, sizeof(unsigned long long), 1, file) == 1;
+            }
+            streamCount = fread(streamBuffer, sizeof(unsigned long long), TRACE_CHUNK / sizeof(unsigned long long), file);
+            streamPosition = 0;
+            if(streamCount == 0)
+            {
+                return false;
+            }
+        }
+        *address = streamBuffer[streamPosition++];
+        return true;
+    }
+    else if(fscanf(file, "%127s", hexAddress) > 0)
+    {
+        *address = strtoull(hexAddress, NULL, 16);
+        return timestamped == false || fscanf(file, "%llu", &issueCycle) == 1;
+    }
+
+    return false;
+}
+
+// ****************************************************************************************************
+// Read Future Function
+// --- Reads every address left in file ahead and finds the next use of each for the optimal
+// --- algorithm; readAddress then hands them out in order. Returns false if the trace could not be
+// --- read or memory runs out.
+// ****************************************************************************************************
+bool readFuture(FILE *file)
+{
+    futureCount = readTrace(file, &futureAddresses);
+    if(futureCount < 0)
+    {
+        return false;
+    }
+
+    futureNextUses = malloc((futureCount > 0 ? futureCount : 1) * sizeof(long));
+    return futureNextUses != NULL && cacheNextUses(futureAddresses, futureCount, blockOffsetBits, futureNextUses);
+}
+
+// ****************************************************************************************************
+// Window Create Function
+// --- Allocates the lookahead window of -o and the optimal caches with shorter windows that run in
+// --- lockstep with cache, which is the one of the full window. Returns false if memory runs out.
+// ****************************************************************************************************
+bool windowCreate(void)
+{
+    // Function Variables
+    CacheConfig config;             // Config of every windowed cache
+    int step;                       // Index counter for moving through the windows
+
+    window = calloc(1, sizeof(LookaheadWindow));
+    if(window == NULL)
+    {
+        return false;
+    }
+    window->lookahead = lookahead;
+    window->size = lookahead + 1;
+    window->capacity = 16;
+    window->shift = 60;
+    while(window->capacity < 2 * (size_t)window->size)
+    {
+        window->capacity *= 2;
+        window->shift--;
+    }
+
+    window->addresses = malloc(window->size * sizeof(unsigned long long));
+    window->nextUses = malloc(window->size * sizeof(long));
+    window->previousUses = malloc(window->size * sizeof(long));
+    window->blocks = malloc(window->capacity * sizeof(unsigned long long));
+    window->positions = malloc(window->capacity * sizeof(long));
+    if(window->addresses == NULL || window->nextUses == NULL || window->previousUses == NULL
+        || window->blocks == NULL || window->positions == NULL)
+    {
+        return false;
+    }
+    memset(window->positions, 0xFF, window->capacity * sizeof(long));
+
+    cacheConfig(&config);
+    window->caches[0] = cache;
+    for (step = 1; step < WINDOW_STEPS && (lookahead >> step) > 0; step++)
+    {
+        window->caches[step] = cacheCreate(&config);
+        if(window->caches[step] == NULL)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Window Destroy Function
+// --- Frees the lookahead window and its shorter windows' caches; cache itself is left to the caller
+// ****************************************************************************************************
+void windowDestroy(void)
+{
+    // Function Variables
+    int step;                       // Index counter for moving through the windows
+
+    if(window == NULL)
+    {
+        return;
+    }
+
+    for (step = 1; step < WINDOW_STEPS; step++)
+    {
+        cacheDestroy(window->caches[step]);
+    }
+    free(window->addresses);
+    free(window->nextUses);
+    free(window->previousUses);
+    free(window->blocks);
+    free(window->positions);
+    free(window);
+    window = NULL;
+}
+
+// ****************************************************************************************************
+// Window Find Function
+// --- Returns the latest position in the window of an access to block, or -1 if there is none. slot
+// --- is set to the table slot holding the block, or to the empty slot it would be added at.
+// ****************************************************************************************************
+static long windowFind(unsigned long long block, size_t *slot)
+{
+    *slot = (block * CACHE_HASH_MULTIPLIER) >> window->shift;
+    while(window->positions[*slot] >= 0 && window->blocks[*slot] != block)
+    {
+        *slot = (*slot + 1) & (window->capacity - 1);
+    }
+
+    return window->positions[*slot];
+}
+
+// ****************************************************************************************************
+// Window Remove Function
+// --- Empties slot of the table, moving back later blocks of the same probe sequence so windowFind
+// --- still reaches them
+// ****************************************************************************************************
+static void windowRemove(size_t slot)
+{
+    // Function Variables
+    size_t next = slot;             // Slot after the hole being filled
+    size_t home;                    // Slot the block of next hashes to
+
+    while(true)
+    {
+        next = (next + 1) & (window->capacity - 1);
+        if(window->positions[next] < 0)
+        {
+            break;
+        }
+
+        // A block whose probe sequence starts after the hole and reaches next stays where it is
+        home = (window->blocks[next] * CACHE_HASH_MULTIPLIER) >> window->shift;
+        if((next > slot && (home <= slot || home > next)) || (next < slot && home <= slot && home > next))
+        {
+            window->blocks[slot] = window->blocks[next];
+            window->positions[slot] = window->positions[next];
+            slot = next;
+        }
+    }
+
+    window->positions[slot] = -1;
+}
+
+// ****************************************************************************************************
+// Read Window Function
+// --- Reads the next address of file into address through the lookahead window: the trace is read
+// --- ahead until the lookahead accesses after it are in the window, linking each access read to the
+// --- previous access to its block still in the window. Returns false at the end of the file.
+// ****************************************************************************************************
+bool readWindow(FILE *file, unsigned long long *address)
+{
+    // Function Variables
+    unsigned long long next;        // Address read into the window
+    long previous;                  // Position of the previous access to its block in the window
+    long ring;                      // Slot of the ring the address is stored in
+    size_t slot;                    // Slot of the table holding its block
+
+    while(window->end <= window->position + window->lookahead && readStream(file, &next))
+    {
+        ring = window->end % window->size;
+        previous = windowFind(next >> blockOffsetBits, &slot);
+        window->addresses[ring] = next;
+        window->nextUses[ring] = CACHE_NEVER;
+        window->previousUses[ring] = previous;
+        if(previous >= 0)
+        {
+            window->nextUses[previous % window->size] = window->end;
+        }
+        window->blocks[slot] = next >> blockOffsetBits;
+        window->positions[slot] = window->end;
+        window->end++;
+    }
+
+    if(window->position == window->end)
+    {
+        return false;
+    }
+    *address = window->addresses[window->position % window->size];
+    window->position++;
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Window Access Function
+// --- Simulates the address just handed out by readWindow on the cache of every window. A window of
+// --- W accesses only knows next uses at most W ahead, treating later ones as never: the next use of
+// --- the address is passed if it is that close, and a block whose next use only now comes within W
+// --- has it set on the line still holding it. Returns the outcome of the full window's cache.
+// ****************************************************************************************************
+CacheResult windowAccess(unsigned long long address)
+{
+    // Function Variables
+    long current = window->position - 1;    // Position of the address
+    long ring = current % window->size;     // Slot of the ring holding it
+    long entering;                  // Position coming within the current window
+    long ahead;                     // Accesses of the current window
+    CacheResult result = CACHE_MISS;// Outcome of the full window
+    CacheResult outcome;            // Outcome of the current window
+    size_t slot;                    // Slot of the table holding the block of address
+    int step;                       // Index counter for moving through the windows
+
+    for (step = 0; step < WINDOW_STEPS && window->caches[step] != NULL; step++)
+    {
+        ahead = window->lookahead >> step;
+        entering = current + ahead;
+        if(entering < window->end && (window->previousUses[entering % window->size] < 0
+            || entering - window->previousUses[entering % window->size] > ahead))
+        {
+            cacheUpdateNext(window->caches[step], window->addresses[entering % window->size], entering);
+        }
+
+        outcome = cacheAccessNext(window->caches[step], address,
+            window->nextUses[ring] - current <= ahead ? window->nextUses[ring] : CACHE_NEVER);
+        if(step == 0)
+        {
+            result = outcome;
+        }
+    }
+
+    // The access leaves the window
+    if(windowFind(address >> blockOffsetBits, &slot) == current)
+    {
+        windowRemove(slot);
+    }
+
+    return result;
+}
+
+// ****************************************************************************************************
+// Window Reset Stats Function
+// --- Zeroes the counters of the cache of every window
+// ****************************************************************************************************
+void windowResetStats(void)
+{
+    // Function Variables
+    int step;                       // Index counter for moving through the windows
+
+    for (step = 0; step < WINDOW_STEPS && window->caches[step] != NULL; step++)
+    {
+        cacheResetStats(window->caches[step]);
+    }
+}
+
+// ****************************************************************************************************
+// Print Window Function
+// --- Prints the misses of every window from the shortest up, with how many more each has than the
+// --- full window, so their convergence shows whether -o is long enough. A trace no longer than the
+// --- window has every next use known, so its misses are those of the optimal algorithm.
+// ****************************************************************************************************
+void printWindow(void)
+{
+    // Function Variables
+    CacheStats full;                // Counters of the full window
+    CacheStats stats;               // Counters of the current window
+    int step;                       // Index counter for moving through the windows
+
+    cacheGetStats(window->caches[0], &full);
+    for (step = WINDOW_STEPS - 1; step >= 0; step--)
+    {
+        if(window->caches[step] != NULL)
+        {
+            cacheGetStats(window->caches[step], &stats);
+            printf("[lookahead] window: %ld misses: %lld excess: %+.3f%%\n", window->lookahead >> step, stats.misses,
+                full.misses > 0 ? (stats.misses - full.misses) * 100.0 / full.misses : 0.0);
+        }
+    }
+    if(window->end - 1 <= window->lookahead)
+    {
+        printf("[lookahead] trace within window: misses equal optimal\n");
+    }
+}
+
+// ****************************************************************************************************
+// Read Trace Function
+// --- Reads every hexidecimal address left in file into a malloc'd array stored in addresses and
+// --- returns the number of addresses read, or -1 if memory runs out or an address is invalid.
+// --- The file is read in chunks of TRACE_CHUNK bytes parsed by the vectorized traceParseHex.
+// ****************************************************************************************************
+long readTrace(FILE *file, unsigned long long **addresses)
+{
+    // Function Variables
+    char *buffer;                   // Chunk of the file, starting with the partial address kept from the last chunk
+    unsigned long long *grown;      // Array reallocated to fit the addresses of the next chunk
+    long capacity = 0;              // Number of addresses the array can hold
+    long count = 0;                 // Number of addresses read
+    long parsed;                    // Number of addresses parsed from the current chunk
+    size_t kept = 0;                // Bytes of a partial address carried over to the next chunk
+    size_t length;                  // Bytes in the buffer
+    size_t end;                     // Bytes of the buffer up to the last complete address
+    size_t consumed;                // Bytes parsed, or offset of the invalid address
+    long offset = ftell(file);      // Byte offset of the buffer within the file
+    bool endOfFile = false;         // Flag indicating the last chunk was read
+
+    buffer = malloc(TRACE_CHUNK);
+    *addresses = NULL;
+
+    // Binary traces are read straight into the array
+    while(buffer != NULL && binaryTrace && endOfFile == false)
+    {
+        if(count + TRACE_CHUNK / (long)sizeof(unsigned long long) > capacity)
+        {
+            capacity = 2 * capacity + TRACE_CHUNK / sizeof(unsigned long long);
+            grown = realloc(*addresses, capacity * sizeof(unsigned long long));
+            if(grown == NULL)
+            {
+                break;
+            }
+            *addresses = grown;
+        }
+
+        parsed = fread(&(*addresses)[count], sizeof(unsigned long long), TRACE_CHUNK / sizeof(unsigned long long), file);
+        endOfFile = parsed < TRACE_CHUNK / (long)sizeof(unsigned long long);
+        count += parsed;
+    }
+
+    while(buffer != NULL && binaryTrace == false && endOfFile == false)
+    {
+        length = kept + fread(&buffer[kept], 1, TRACE_CHUNK - kept, file);
+        endOfFile = length < (size_t)TRACE_CHUNK;
+
+        // Only parse up to the last whitespace so no address is split between chunks
+        end = length;
+        while(endOfFile == false && end > 0 && strchr(" \t\r\n", buffer[end - 1]) == NULL)
+        {
+            end--;
+        }
+
+        // Every address takes at least two bytes including its delimiter
+        if(count + (long)(end / 2) + 1 > capacity)
+        {
+            capacity = 2 * capacity > count + (long)(end / 2) + 1 ? 2 * capacity : count + (long)(end / 2) + 1;
+            grown = realloc(*addresses, capacity * sizeof(unsigned long long));
+            if(grown == NULL)
+            {
+                break;
+            }
+            *addresses = grown;
+        }
+
+        parsed = traceParseHex(buffer, end, &(*addresses)[count], capacity - count, &consumed);
+        if(parsed < 0 || (end == 0 && length == (size_t)TRACE_CHUNK))
+        {
+            printf("[ERROR] Invalid hexidecimal address at byte %ld ...\n", offset + (long)consumed);
+            free(buffer);
+            free(*addresses);
+            *addresses = NULL;
+            return -1;
+        }
+        count += parsed;
+
+        // Move the partial address to the front of the buffer
+        memmove(buffer, &buffer[end], length - end);
+        kept = length - end;
+        offset += end;
+    }
+
+    if(buffer == NULL || endOfFile == false)
+    {
+        printf("[ERROR] Not enough memory to read trace ...\n");
+        free(buffer);
+        free(*addresses);
+        *addresses = NULL;
+        return -1;
+    }
+
+    free(buffer);
+    return count;
+}
+
+// ****************************************************************************************************
+// Parallel Sim Function
+// --- Reads the whole trace, simulates it sequentially and again as numSlices time slices in
+// --- parallel, each slice warmed up on the sliceWarmUp accesses before it, then displays every
+// --- slice, the error of the merged result against the sequential run, and the merged result.
+// --- Returns false if the trace cannot be read or memory runs out.
+// ****************************************************************************************************
+bool parallelSim(void)
+{
+    // Function Variables
+    unsigned long long *addresses;  // Decoded trace
+    long count;                     // Number of addresses in the trace
+    long steps;                     // Number of same-block runs simulated by the sequential run
+    CacheConfig config;             // Config every slice creates its cache from
+    CacheStats sequential;          // Counters of the sequential run
+    CacheStats merged;              // Summed counters of every slice
+    CacheStats *sliceStats;         // Counters of each slice
+    struct timespec begin;          // Wall time at the start of a run
+    struct timespec end;            // Wall time at the end of a run
+    double sequentialTime;          // Seconds taken by the sequential run
+    double parallelTime;            // Seconds taken by the parallel run
+    int slice;                      // Index counter for moving through slices
+
+    count = readTrace(pFile, &addresses);
+    sliceStats = calloc(numSlices, sizeof(CacheStats));
+    if(count < 0 || sliceStats == NULL)
+    {
+        printf("[ERROR] Could not read trace ... [EXITING PROGRAM]\n");
+        free(addresses);
+        free(sliceStats);
+        return false;
+    }
+
+    // Sequential reference run on the cache created from the arguments, one engine step per run
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    steps = cacheAccessCollapsed(cache, addresses, count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    cacheGetStats(cache, &sequential);
+    sequentialTime = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    cacheConfig(&config);
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    if(cacheSimulateSliced(&config, addresses, count, numSlices, sliceWarmUp, &merged, sliceStats) == false)
+    {
+        printf("[ERROR] Could not simulate time slices ...\n");
+        free(addresses);
+        free(sliceStats);
+        return false;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    parallelTime = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    for (slice = 0; slice < numSlices; slice++)
+    {
+        printf("[slice] %d hits: %lld misses: %lld evictions: %lld\n", slice, sliceStats[slice].hits, sliceStats[slice].misses, sliceStats[slice].evictions);
+    }
+    printf("[runs] accesses: %ld engine steps: %ld (%.2fx fewer)\n", count, steps, steps > 0 ? (double)count / steps : 0.0);
+    printf("[sequential] hits: %lld misses: %lld evictions: %lld time: %.3f s\n", sequential.hits, sequential.misses, sequential.evictions, sequentialTime);
+    printf("[parallel] slices: %d warmup: %ld hits: %lld misses: %lld evictions: %lld time: %.3f s\n", numSlices, sliceWarmUp, merged.hits, merged.misses, merged.evictions, parallelTime);
+    printf("[error] misses: %+lld (%+.3f%%)\n", merged.misses - sequential.misses,
+        sequential.misses > 0 ? (merged.misses - sequential.misses) * 100.0 / sequential.misses : 0.0);
+
+    // Print merged result
+    missRate = 0;
+    if(merged.hits + merged.misses > 0)
+    {
+        missRate = (((double)(merged.misses) * 100) / ((double)(merged.hits) + merged.misses));
+    }
+    avgAccessTime = averageAccessTime(missRate);
+    runTime = totalRunTime(count, avgAccessTime);
+    printResult(merged.hits, merged.misses, missRate, runTime);
+
+    free(addresses);
+    free(sliceStats);
+    return true;
+}
+
+// ****************************************************************************************************
+// Parse List Function
+// --- Reads up to max comma separated integers of list into values and returns how many were read
+// ****************************************************************************************************
+int parseList(char *list, int *values, int max)
+{
+    // Function Variables
+    char *token;                    // Current comma separated integer
+    int count = 0;                  // Number of integers read
+
+    for (token = strtok(list, ","); token != NULL && count < max; token = strtok(NULL, ","))
+    {
+        values[count++] = atoi(token);
+    }
+
+    return count;
+}
+
+// ****************************************************************************************************
+// Shared Sim Function
+// --- Reads every comma separated trace of fileName and simulates them as tenants sharing one cache,
+// --- interleaved at the tenantRates and partitioned by tenantWays. Each tenant is also simulated
+// --- alone in the whole cache to show the misses added by sharing. Displays every tenant and the
+// --- combined result. Returns false if a trace, -R, or -W is invalid.
+// ****************************************************************************************************
+bool sharedSim(void)
+{
+    // Function Variables
+    SharedTenant tenants[CACHE_MAX_TENANTS];    // Trace, rate, and static ways of each tenant
+    unsigned long long *addresses[CACHE_MAX_TENANTS] = {NULL}; // Decoded trace of each tenant
+    char *names[CACHE_MAX_TENANTS]; // File name of each tenant's trace
+    int values[CACHE_MAX_TENANTS];  // Integers parsed from -R or -W
+    CacheStats tenantStats[CACHE_MAX_TENANTS];  // Counters of each tenant in the shared cache
+    int ways[CACHE_MAX_TENANTS];    // Final ways of each tenant
+    CacheStats alone;               // Counters of a tenant alone in the cache
+    CacheStats total;               // Counters summed over every tenant
+    CacheConfig config;             // Config of the shared cache
+    Cache *aloneCache;              // Cache a tenant is simulated alone in
+    const char *partition = "none"; // Partitioning policy
+    char *token;                    // Current comma separated file name
+    bool simulated = false;         // Flag indicating every tenant was simulated
+    int numTenants = 0;             // Number of traces
+    long accesses = 0;              // Accesses of every trace
+    int tenant, count;
+
+    memset(tenants, 0, sizeof(tenants));
+    for (token = strtok(fileName, ","); token != NULL; token = strtok(NULL, ","))
+    {
+        names[numTenants++] = token;
+    }
+
+    // Read every trace, each as text or binary
+    for (tenant = 0; tenant < numTenants; tenant++)
+    {
+        pFile = fopen(names[tenant], "rb");
+        if(pFile == NULL)
+        {
+            printf("[ERROR] File %s = NULL ... [EXITING PROGRAM]\n", names[tenant]);
+            break;
+        }
+        binaryTrace = readTraceHeader(&pFile);
+        tenants[tenant].count = readTrace(pFile, &addresses[tenant]);
+        tenants[tenant].addresses = addresses[tenant];
+        tenants[tenant].rate = 1;
+        fclose(pFile);
+        pFile = NULL;
+        if(tenants[tenant].count < 0)
+        {
+            printf("[ERROR] Could not read trace %s ... [EXITING PROGRAM]\n", names[tenant]);
+            break;
+        }
+        accesses += tenants[tenant].count;
+    }
+
+    // Round-robin unless rates are given; no partitions unless ways are given
+    if(tenant == numTenants && tenantRates != NULL)
+    {
+        count = parseList(tenantRates, values, CACHE_MAX_TENANTS);
+        for (tenant = 0; tenant < count && tenant < numTenants; tenant++)
+        {
+            tenants[tenant].rate = values[tenant];
+        }
+        tenant = numTenants;
+    }
+    if(tenant == numTenants && tenantWays != NULL && strcmp(tenantWays, "ucp") == 0)
+    {
+        partition = "ucp";
+    }
+    else if(tenant == numTenants && tenantWays != NULL)
+    {
+        partition = "static";
+        count = parseList(tenantWays, values, CACHE_MAX_TENANTS);
+        for (tenant = 0; tenant < count && tenant < numTenants; tenant++)
+        {
+            tenants[tenant].ways = values[tenant];
+        }
+        tenant = numTenants;
+    }
+
+    cacheConfig(&config);
+    if(tenant == numTenants && cacheSimulateShared(&config, tenants, numTenants, partition, partitionEpoch, tenantStats, ways) == false)
+    {
+        printf("[ERROR] Could not share the cache - check -R rates and -W ways ... [EXITING PROGRAM]\n");
+        tenant = 0;
+    }
+
+    if(tenant == numTenants)
+    {
+        memset(&total, 0, sizeof(total));
+        for (tenant = 0; tenant < numTenants; tenant++)
+        {
+            aloneCache = cacheCreate(&config);
+            cacheAccessCollapsed(aloneCache, addresses[tenant], tenants[tenant].count);
+            cacheGetStats(aloneCache, &alone);
+            cacheDestroy(aloneCache);
+
+            printf("[tenant] %d trace: %s rate: %d ways: %d hits: %lld misses: %lld evictions: %lld miss rate: %.2f%% alone misses: %lld (%+.2f%%)\n",
+                tenant, names[tenant], tenants[tenant].rate, ways[tenant], tenantStats[tenant].hits, tenantStats[tenant].misses,
+                tenantStats[tenant].evictions, tenants[tenant].count > 0 ? tenantStats[tenant].misses * 100.0 / tenants[tenant].count : 0.0,
+                alone.misses, alone.misses > 0 ? (tenantStats[tenant].misses - alone.misses) * 100.0 / alone.misses : 0.0);
+            total.hits += tenantStats[tenant].hits;
+            total.misses += tenantStats[tenant].misses;
+        }
+        printf("[shared] tenants: %d partition: %s epoch: %ld\n", numTenants, partition, partitionEpoch);
+
+        // Print combined result
+        missRate = 0;
+        if(total.hits + total.misses > 0)
+        {
+            missRate = (((double)(total.misses) * 100) / ((double)(total.hits) + total.misses));
+        }
+        avgAccessTime = averageAccessTime(missRate);
+        runTime = totalRunTime(accesses, avgAccessTime);
+        printResult(total.hits, total.misses, missRate, runTime);
+        simulated = true;
+    }
+
+    for (tenant = 0; tenant < numTenants; tenant++)
+    {
+        free(addresses[tenant]);
+    }
+
+    return simulated;
+}
+
+// ****************************************************************************************************
+// Parse Model Function
+// --- Overrides config with the comma separated key=value pairs of spec, keys being the single
+// --- letter arguments m, s, e, b, r, S, E, and h. Returns false on an unknown key.
+// ****************************************************************************************************
+bool parseModel(char *spec, CacheConfig *config)
+{
+    // Function Variables
+    char *token;                    // Current key=value pair
+    char *value;                    // Value of the current pair
+
+    for (token = strtok(spec, ","); token != NULL; token = strtok(NULL, ","))
+    {
+        value = strchr(token, '=');
+        if(value == NULL || value != token + 1)
+        {
+            return false;
+        }
+        value++;
+
+        switch (token[0])
+        {
+            case 'm': config->addressSize = atoi(value); break;
+            case 's': config->setBits = atoi(value); break;
+            case 'e': config->linesPerSet = atoi(value); break;
+            case 'b': config->blockOffsetBits = atoi(value); break;
+            case 'r': config->algorithm = value; break;
+            case 'S': config->sets = atoi(value); break;
+            case 'E': config->ways = atoi(value); break;
+            case 'h': config->indexHash = value; break;
+            default: return false;
+        }
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Count Divergence Function
+// --- Adds a divergence of key to the open addressing table of *capacity counts, doubling the
+// --- table when it is half full. Returns false if memory runs out.
+// ****************************************************************************************************
+static bool countDivergence(DiffCount **table, long *capacity, long *used, unsigned long long key, bool hitA)
+{
+    // Function Variables
+    DiffCount *old = *table;        // Table before growing
+    long oldCapacity = *capacity;   // Capacity before growing
+    long slot;                      // Slot of key
+    long index;                     // Index counter for moving through the old table
+
+    if(2 * (*used + 1) > *capacity)
+    {
+        *capacity = *capacity > 0 ? 2 * *capacity : 1024;
+        *table = calloc(*capacity, sizeof(DiffCount));
+        if(*table == NULL)
+        {
+            *table = old;
+            *capacity = oldCapacity;
+            return false;
+        }
+
+        // Rehash every used slot into the new table
+        for (index = 0; index < oldCapacity; index++)
+        {
+            if(old[index].onlyA + old[index].onlyB > 0)
+            {
+                slot = (old[index].key * CACHE_HASH_MULTIPLIER) >> 32 & (*capacity - 1);
+                while((*table)[slot].onlyA + (*table)[slot].onlyB > 0)
+                {
+                    slot = (slot + 1) & (*capacity - 1);
+                }
+                (*table)[slot] = old[index];
+            }
+        }
+        free(old);
+    }
+
+    slot = (key * CACHE_HASH_MULTIPLIER) >> 32 & (*capacity - 1);
+    while((*table)[slot].onlyA + (*table)[slot].onlyB > 0 && (*table)[slot].key != key)
+    {
+        slot = (slot + 1) & (*capacity - 1);
+    }
+
+    if((*table)[slot].onlyA + (*table)[slot].onlyB == 0)
+    {
+        (*table)[slot].key = key;
+        (*used)++;
+    }
+    if(hitA)
+    {
+        (*table)[slot].onlyA++;
+    }
+    else
+    {
+        (*table)[slot].onlyB++;
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Compare Divergence Function
+// --- qsort comparison putting the keys with the most divergences first
+// ****************************************************************************************************
+static int compareDivergence(const void *first, const void *second)
+{
+    // Function Variables
+    long a = ((const DiffCount *)first)->onlyA + ((const DiffCount *)first)->onlyB;
+    long b = ((const DiffCount *)second)->onlyA + ((const DiffCount *)second)->onlyB;
+
+    return a < b ? 1 : a > b ? -1 : 0;
+}
+
+// ****************************************************************************************************
+// Print Divergence Function
+// --- Sorts the used slots of table and prints the DIFF_TOP keys with the most divergences
+// ****************************************************************************************************
+static void printDivergence(const char *label, DiffCount *table, long capacity, long used)
+{
+    // Function Variables
+    long count = 0;                 // Number of used slots moved to the front
+    long index;                     // Index counter for moving through the table
+
+    for (index = 0; index < capacity; index++)
+    {
+        if(table[index].onlyA + table[index].onlyB > 0)
+        {
+            table[count++] = table[index];
+        }
+    }
+    qsort(table, count, sizeof(DiffCount), compareDivergence);
+
+    printf("[%s] divergent %ss: %ld\n", label, label, used);
+    for (index = 0; index < count && index < DIFF_TOP; index++)
+    {
+        printf("[%s] %llx divergent: %ld hit in A only: %ld hit in B only: %ld\n", label, table[index].key,
+            table[index].onlyA + table[index].onlyB, table[index].onlyA, table[index].onlyB);
+    }
+}
+
+// ****************************************************************************************************
+// Diff Sim Function
+// --- Runs the cache of the arguments (A) and the model given by diffModel (B) in lockstep on one
+// --- pass over the trace. Displays the first DIFF_SHOWN accesses whose outcomes differ, the sets
+// --- (of A) and 2^regionBits byte regions with the most divergences, and the result of each model.
+// --- Returns false if the model is invalid or memory runs out.
+// ****************************************************************************************************
+bool diffSim(void)
+{
+    // Function Variables
+    CacheConfig config;             // Config of model B, the arguments overridden by diffModel
+    Cache *other;                   // Cache of model B
+    long *otherNextUses = futureNextUses;   // Next uses for B, found again if its blocks differ
+    CacheStats statsA;              // Counters of model A
+    CacheStats statsB;              // Counters of model B
+    DiffCount *sets = NULL;         // Divergences per set of A
+    DiffCount *regions = NULL;      // Divergences per region
+    long setCapacity = 0, setsUsed = 0;
+    long regionCapacity = 0, regionsUsed = 0;
+    unsigned long long address;     // Address read from the input file
+    bool hitA, hitB;                // Flags indicating each model hit the current access
+    long index = 0;                 // Index of the current access
+    long divergences = 0;           // Accesses whose outcomes differ
+    long onlyA = 0, onlyB = 0;      // Divergences hitting in A or B only
+    bool valid = true;              // Flag indicating the tables could grow
+
+    cacheConfig(&config);
+    if(parseModel(diffModel, &config) == false || (other = cacheCreate(&config)) == NULL)
+    {
+        printf("[ERROR] Invalid -D model - use key=value pairs of m,s,e,b,r,S,E,h ... [EXITING PROGRAM]\n");
+        return false;
+    }
+    if(futureNextUses != NULL && config.blockOffsetBits != blockOffsetBits)
+    {
+        otherNextUses = malloc((futureCount > 0 ? futureCount : 1) * sizeof(long));
+        if(otherNextUses == NULL || cacheNextUses(futureAddresses, futureCount, config.blockOffsetBits, otherNextUses) == false)
+        {
+            printf("[ERROR] Could not read trace ahead ... [EXITING PROGRAM]\n");
+            free(otherNextUses);
+            cacheDestroy(other);
+            return false;
+        }
+    }
+
+    while(valid && readAddress(pFile, &address))
+    {
+        if(futureNextUses != NULL)
+        {
+            hitA = cacheAccessNext(cache, address, futureNextUses[index]) == CACHE_HIT;
+            hitB = cacheAccessNext(other, address, otherNextUses[index]) == CACHE_HIT;
+        }
+        else
+        {
+            hitA = cacheAccess(cache, address) == CACHE_HIT;
+            hitB = cacheAccess(other, address) == CACHE_HIT;
+        }
+
+        if(hitA != hitB)
+        {
+            if(divergences < DIFF_SHOWN)
+            {
+                printf("[diverge] access: %ld address: %llx A: %c B: %c set: %ld\n", index, address, hitA ? 'H' : 'M', hitB ? 'H' : 'M', cacheSetOf(cache, address));
+            }
+            divergences++;
+            onlyA += hitA;
+            onlyB += hitB;
+            valid = countDivergence(&sets, &setCapacity, &setsUsed, cacheSetOf(cache, address), hitA)
+                && countDivergence(&regions, &regionCapacity, &regionsUsed, address >> regionBits, hitA);
+        }
+        index++;
+    }
+
+    if(valid == false)
+    {
+        printf("[ERROR] Not enough memory to count divergences ...\n");
+    }
+
+    printDivergence("set", sets, setCapacity, setsUsed);
+    printDivergence("region", regions, regionCapacity, regionsUsed);
+
+    cacheGetStats(cache, &statsA);
+    cacheGetStats(other, &statsB);
+    printf("[model] A: %s hits: %lld misses: %lld evictions: %lld\n", algorithm, statsA.hits, statsA.misses, statsA.evictions);
+    printf("[model] B: %s hits: %lld misses: %lld evictions: %lld\n", config.algorithm, statsB.hits, statsB.misses, statsB.evictions);
+    printf("[diff] accesses: %ld divergent: %ld (%.3f%%) hit in A only: %ld hit in B only: %ld region: %d bits\n",
+        index, divergences, index > 0 ? divergences * 100.0 / index : 0.0, onlyA, onlyB, regionBits);
+
+    if(otherNextUses != futureNextUses)
+    {
+        free(otherNextUses);
+    }
+    free(sets);
+    free(regions);
+    cacheDestroy(other);
+
+    return valid;
+}
+
+// ****************************************************************************************************
+// Skip Addresses Function
+// --- Moves file past its next count addresses without simulating them, seeking over a binary trace
+// --- when the file allows it. Returns false if the file ends first.
+// ****************************************************************************************************
+bool skipAddresses(FILE *file, long long count)
+{
+    // Function Variables
+    unsigned long long address;     // Address read and dropped
+    long buffered = streamCount - streamPosition; // Addresses left in the read-ahead buffer
+
+    if(binaryTrace && futureAddresses == NULL && window == NULL)
+    {
+        if(count <= buffered)
+        {
+            streamPosition += count;
+            return true;
+        }
+        if(fseek(file, (count - buffered) * (long)sizeof(unsigned long long), SEEK_CUR) == 0)
+        {
+            streamPosition = streamCount;
+            return true;
+        }
+    }
+
+    for (; count > 0; count--)
+    {
+        if(readAddress(file, &address) == false)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Phase Analysis Function
+// --- Cuts the trace into intervals of phaseLength accesses, fingerprints the 2^regionBits byte regions
+// --- of each with a MinHash signature, and groups them into at most maxPhases phases of similar
+// --- working sets. Regions rather than blocks let intervals drawing different blocks from the same
+// --- large footprint, which share few blocks, still match. Prints the interval representing every
+// --- phase with its weight, the share of the trace's accesses in the phase; phaseSim reads these
+// --- lines back with -Q. Returns false if memory runs out.
+// ****************************************************************************************************
+bool phaseAnalysis(void)
+{
+    // Function Variables
+    PhaseSignature *signatures = NULL;  // Signature of every interval
+    PhaseSignature *grown;          // Array reallocated to fit the next interval
+    long capacity = 0;              // Intervals signatures has room for
+    long count = 0;                 // Intervals read
+    int *clusters;                  // Phase of every interval
+    long *representatives;          // Representative interval of every phase
+    long long *weights;             // Accesses of every phase
+    long *members;                  // Intervals of every phase
+    unsigned long long address;     // Address read from the input file
+    long long accesses = 0;         // Accesses read
+    int numPhases;                  // Phases found
+    int phase;                      // Index counter for moving through the phases
+    long interval;                  // Index counter for moving through the intervals
+
+    while(readAddress(pFile, &address))
+    {
+        if(accesses % phaseLength == 0)
+        {
+            if(count == capacity)
+            {
+                capacity = capacity > 0 ? 2 * capacity : 1024;
+                grown = realloc(signatures, capacity * sizeof(PhaseSignature));
+                if(grown == NULL)
+                {
+                    printf("[ERROR] Not enough memory for the interval signatures ... [EXITING PROGRAM]\n");
+                    free(signatures);
+                    return false;
+                }
+                signatures = grown;
+            }
+            phaseSignatureReset(&signatures[count++]);
+        }
+        phaseSignatureAdd(&signatures[count - 1], address >> regionBits);
+        accesses++;
+    }
+
+    clusters = malloc((count > 0 ? count : 1) * sizeof(int));
+    representatives = malloc(maxPhases * sizeof(long));
+    weights = calloc(maxPhases, sizeof(long long));
+    members = calloc(maxPhases, sizeof(long));
+    numPhases = clusters != NULL && representatives != NULL && weights != NULL && members != NULL
+        ? phaseCluster(signatures, count, maxPhases, clusters, representatives) : -1;
+    if(numPhases < 0)
+    {
+        printf("[ERROR] Not enough memory to cluster the intervals ... [EXITING PROGRAM]\n");
+    }
+
+    for (interval = 0; interval < count && numPhases > 0; interval++)
+    {
+        weights[clusters[interval]] += signatures[interval].accesses;
+        members[clusters[interval]]++;
+        if(quiet == false)
+        {
+            printf("[member] interval: %ld start: %lld phase: %d distance: %.3f\n", interval, interval * phaseLength, clusters[interval],
+                phaseDistance(&signatures[interval], &signatures[representatives[clusters[interval]]]));
+        }
+    }
+
+    printf("[phases] accesses: %lld intervals: %ld length: %lld phases: %d\n", accesses, count, phaseLength, numPhases > 0 ? numPhases : 0);
+    for (phase = 0; phase < numPhases; phase++)
+    {
+        if(members[phase] > 0)
+        {
+            printf("[phase] phase: %d interval: %ld start: %lld length: %lld weight: %.6f intervals: %ld\n", phase, representatives[phase],
+                representatives[phase] * phaseLength, signatures[representatives[phase]].accesses, (double)weights[phase] / accesses, members[phase]);
+        }
+    }
+
+    free(signatures);
+    free(clusters);
+    free(representatives);
+    free(weights);
+    free(members);
+
+    return numPhases >= 0;
+}
+
+// ****************************************************************************************************
+// Compare Phases Function
+// --- Orders phases by the start of their representative interval for qsort
+// ****************************************************************************************************
+static int comparePhases(const void *first, const void *second)
+{
+    long long a = ((const Phase *)first)->start;
+    long long b = ((const Phase *)second)->start;
+
+    return (a > b) - (a < b);
+}
+
+// ****************************************************************************************************
+// Phase Sim Function
+// --- Reads the phases printed by phaseAnalysis from phaseFile and simulates only the representative
+// --- interval of each, in trace order, after the sliceWarmUp accesses before it. The miss rate of the
+// --- whole trace is extrapolated from those of the intervals, weighted by their phases' share.
+// --- Returns false if phaseFile holds no phases.
+// ****************************************************************************************************
+bool phaseSim(void)
+{
+    // Function Variables
+    FILE *file;                     // File of phases
+    char line[256];                 // Current line of the file
+    Phase *phases = NULL;           // Phases read
+    Phase *grown;                   // Array reallocated to fit the next phase
+    long capacity = 0;              // Phases the array has room for
+    long count = 0;                 // Phases read
+    Phase phase;                    // Phase parsed from the current line
+    CacheStats before, after;       // Counters around a representative interval
+    unsigned long long address;     // Address read from the input file
+    long long total = -1;           // Accesses of the whole trace
+    long long position = 0;         // Position of the next address of the trace
+    long long warm;                 // First warm-up access of a representative interval
+    long long simulated = 0;        // Accesses simulated within the intervals
+    long long warmed = 0;           // Accesses simulated as warm-up
+    long double weight = 0;         // Weight of the simulated phases
+    long double rate = 0;           // Weighted miss rate of the simulated phases
+    long long misses;               // Extrapolated misses of the whole trace
+    long index;                     // Index counter for moving through the phases
+
+    file = fopen(phaseFile, "r");
+    if(file == NULL)
+    {
+        printf("[ERROR] File %s = NULL ... [EXITING PROGRAM]\n", phaseFile);
+        return false;
+    }
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        memset(&phase, 0, sizeof(phase));
+        if(sscanf(line, "[phases] accesses: %lld", &total) == 1)
+        {
+            continue;
+        }
+        if(sscanf(line, "[phase] phase: %d interval: %ld start: %lld length: %lld weight: %lf", &phase.phase, &phase.interval,
+            &phase.start, &phase.length, &phase.weight) != 5)
+        {
+            continue;
+        }
+        if(count == capacity)
+        {
+            capacity = capacity > 0 ? 2 * capacity : 16;
+            grown = realloc(phases, capacity * sizeof(Phase));
+            if(grown == NULL)
+            {
+                break;
+            }
+            phases = grown;
+        }
+        phases[count++] = phase;
+    }
+    fclose(file);
+
+    if(total < 0 || count == 0)
+    {
+        printf("[ERROR] No phases in %s - use the output of -P ... [EXITING PROGRAM]\n", phaseFile);
+        free(phases);
+        return false;
+    }
+    qsort(phases, count, sizeof(Phase), comparePhases);
+
+    for (index = 0; index < count; index++)
+    {
+        // Warm the cache up on the accesses before the interval, never reaching back into the last one
+        warm = phases[index].start - sliceWarmUp > position ? phases[index].start - sliceWarmUp : position;
+        if(skipAddresses(pFile, warm - position) == false)
+        {
+            break;
+        }
+        for (position = warm; position < phases[index].start && readAddress(pFile, &address); position++)
+        {
+            cacheAccess(cache, address);
+            warmed++;
+        }
+
+        cacheGetStats(cache, &before);
+        for (; position < phases[index].start + phases[index].length && readAddress(pFile, &address); position++)
+        {
+            cacheAccess(cache, address);
+        }
+        cacheGetStats(cache, &after);
+        phases[index].hits = after.hits - before.hits;
+        phases[index].misses = after.misses - before.misses;
+        simulated += phases[index].hits + phases[index].misses;
+
+        if(phases[index].hits + phases[index].misses > 0)
         {
-            // Set least to cache[set][i].lruCount and mark index
-            least = cache[set][i].lruCount;
-            index = i;
+            weight += phases[index].weight;
+            rate += phases[index].weight * phases[index].misses / (phases[index].hits + phases[index].misses);
         }
+        printf("[simpoint] phase: %d interval: %ld weight: %.6f hits: %lld misses: %lld\n", phases[index].phase, phases[index].interval,
+            phases[index].weight, phases[index].hits, phases[index].misses);
     }
 
-    return index;
+    printf("[simpoint] simulated: %lld warm-up: %lld of %lld accesses (%.3f%%)\n", simulated, warmed, total,
+        total > 0 ? (simulated + warmed) * 100.0 / total : 0.0);
+
+    // Extrapolate the miss rate of the simulated phases to the whole trace
+    missRate = weight > 0 ? rate / weight * 100 : 0;
+    misses = (long long)(missRate * total / 100 + 0.5);
+    avgAccessTime = averageAccessTime(missRate);
+    runTime = totalRunTime(total, avgAccessTime);
+    printResult(total - misses, misses, missRate, runTime);
+
+    free(phases);
+    return true;
 }
 
 // ****************************************************************************************************
-// First In First Out Function
-// --- Sets firstIn to the fifoCount of the first line in the set and then compares each line of the set
-// --- returning the index of the first in block within the given set.
-// --- Higher number = first in.
+// Print Granules Function
+// --- Prints the byte ranges of a block covered by the granules set in mask, e.g. 0-7,16-23, or -
 // ****************************************************************************************************
-int firstInFirstOut(int set)
+void printGranules(unsigned long long mask, int granule)
 {
     // Function Variables
-    int firstIn = cache[set][0].fifoCount;
-    int index = 0;
+    int first;                      // First granule of the current range
+    int last;                       // Granule after the current range
+    bool comma = false;             // Flag indicating a range was printed before
 
-    // For each line of cache of given set
-    for (i = 0; i < numLines; i++)
+    if(mask == 0)
     {
-        // If firstIn is less than cache[set][i].fifoCount
-        if (firstIn < cache[set][i].fifoCount)
+        printf("-");
+        return;
+    }
+
+    for (first = 0; first < 64; first = last)
+    {
+        if((mask >> first & 1) == 0)
+        {
+            last = first + 1;
+            continue;
+        }
+        for (last = first; last < 64 && (mask >> last & 1); last++)
         {
-            // Set firstIn to cache[set][i].fifoCount and mark index
-            firstIn = cache[set][i].fifoCount;
-            index = i;
         }
+        printf("%s%d-%d", comma ? "," : "", first * granule, last * granule - 1);
+        comma = true;
     }
+}
 
-    return index;
+// ****************************************************************************************************
+// Print Sharing Function
+// --- Prints the SHARING_TOP blocks with the most invalidations whose coherence misses are mostly false
+// --- sharing, or mostly true sharing, with the bytes each of their first threads read and wrote
+// ****************************************************************************************************
+void printSharing(CacheSharing *sharing, bool falseSharing, int granule)
+{
+    // Function Variables
+    SharingBlock blocks[SHARING_TOP];   // Blocks with the most invalidations
+    const char *label = falseSharing ? "false" : "true";
+    long count;                     // Number of blocks filled in
+    long index;                     // Index counter for moving through the blocks
+    int thread;                     // Index counter for moving through the threads of a block
+
+    count = sharingTop(sharing, falseSharing, blocks, SHARING_TOP);
+    for (index = 0; index < count; index++)
+    {
+        printf("[%s] block: %llx invalidations: %lld false misses: %lld true misses: %lld threads: %d%s",
+            label, blocks[index].block << blockOffsetBits, blocks[index].invalidations, blocks[index].falseMisses,
+            blocks[index].trueMisses, blocks[index].threads, blocks[index].disjoint ? " disjoint" : "");
+        for (thread = 0; thread < blocks[index].threads && thread < SHARING_THREADS_SHOWN; thread++)
+        {
+            printf(" | thread %d R: ", blocks[index].shown[thread].thread);
+            printGranules(blocks[index].shown[thread].readGranules, granule);
+            printf(" W: ");
+            printGranules(blocks[index].shown[thread].writtenGranules, granule);
+        }
+        printf("%s\n", blocks[index].threads > SHARING_THREADS_SHOWN ? " | ..." : "");
+    }
 }
 
-/***********************************************************************************************************************************************************************************************************************
-//
 // ****************************************************************************************************
-// Optimal Function
-// --- Sets farthestInFuture to the futureCount of the first line in the set and then compares each line
-// --- of the set, returning the index of the farthest block within the given set.
-// --- Higher number = farthestInFuture.
+// Sharing Analysis Function
+// --- Reads a trace of records "address thread kind bytes", kind R or L for a read and W or S for a
+// --- write, and follows the blocks threads share between private caches that never evict. Prints
+// --- the blocks ranked by the invalidations their writes cause: first those missing mostly on bytes
+// --- no other thread wrote (false sharing, fixed by moving the data apart), then those missing on
+// --- data really passed between threads (true sharing). Returns false if a record is malformed or
+// --- memory runs out.
 // ****************************************************************************************************
-int optimal(int set)
+bool sharingAnalysis(void)
 {
     // Function Variables
-    int farInFuture = cache[set][0].futureCount;
-    int index = 0;
+    CacheSharing *sharing;          // Blocks and threads seen so far
+    SharingStats stats;             // Totals of the analysis
+    int thread;                     // Thread of the current record
+    char kind;                      // Access type of the current record
+    int bytes;                      // Bytes of the current record
+    int fields;                     // Fields of the current record read by fscanf
+    long long line = 0;             // Records read so far
+
+    sharing = sharingCreate(blockOffsetBits);
+    if(sharing == NULL)
+    {
+        printf("[ERROR] Could not allocate the sharing analysis ... [EXITING PROGRAM]\n");
+        return false;
+    }
 
-    // For each line of cache of given set
-    for (i = 0; i < numLines; i++)
+    while((fields = fscanf(pFile, "%127s %d %c %d", hexAddress, &thread, &kind, &bytes)) == 4)
     {
-        // If farthestInFuture is less than cache[set][i].futureCount
-        if (farInFuture < cache[set][i].futureCount)
+        line++;
+        if(strchr("RLWS", kind) == NULL)
+        {
+            printf("[ERROR] Record %lld: access type %c is not R, L, W, or S ... [EXITING PROGRAM]\n", line, kind);
+            sharingDestroy(sharing);
+            return false;
+        }
+        if(sharingAccess(sharing, strtoull(hexAddress, NULL, 16), bytes, thread, kind == 'W' || kind == 'S') == false)
         {
-            // Set farthestInFuture to cache[set][i].futureCount and mark index
-            farInFuture = cache[set][i].futureCount;
-            index = i;
+            printf("[ERROR] Record %lld: more than %d threads or out of memory ... [EXITING PROGRAM]\n", line, SHARING_MAX_THREADS);
+            sharingDestroy(sharing);
+            return false;
         }
     }
+    if(fields != EOF)
+    {
+        printf("[ERROR] Record %lld: expected address thread kind bytes ... [EXITING PROGRAM]\n", line + 1);
+        sharingDestroy(sharing);
+        return false;
+    }
+
+    sharingGetStats(sharing, &stats);
+    printSharing(sharing, true, stats.granule);
+    printSharing(sharing, false, stats.granule);
+    printf("[sharing] accesses: %lld threads: %d blocks: %lld shared: %lld invalidations: %lld coherence misses: %lld true: %lld false: %lld granule: %d\n",
+        stats.accesses, stats.threads, stats.blocks, stats.sharedBlocks, stats.invalidations, stats.trueMisses + stats.falseMisses,
+        stats.trueMisses, stats.falseMisses, stats.granule);
 
-    return index;
+    sharingDestroy(sharing);
+    return true;
 }
 
 // ****************************************************************************************************
-// Farthest In Future Function
+// Load Regions Function
+// --- Reads the region map name into regions. Every line is a range start-end in hex, followed either
+// --- by the fields of /proc/<pid>/maps (perms offset dev inode path), the path naming the region and
+// --- mappings without one named [anonymous], or by the name of the range. Blank lines and lines
+// --- starting with # are skipped. Returns false if a line has no range or name, ranges overlap, or
+// --- memory runs out.
 // ****************************************************************************************************
-// --- Pseudocode:
-// --- Create a list of future queries from the input file
-// --- Set futureCount to nearest second occurance of memory in list
-// ---      Search for address in future queries list
-// ---      Mark first occurrence of address item index
-// ---      Set futureIndex equal to index of next same item in future queries list minus the first occurrence index
-// --- Return futureIndex
-// ---
-// --- Pseudocode v2:
-// --- Initialize firstFlag and secondFlag to false
-// --- Allocate memory for new hex address and binary address for conversion
-// --- For each scanned address of input file
-// ---      Convert to binary
-// ---      Extract the tag and set
-// ---      Convert tag and set to decimal
-// ---      Compare tags and sets
-// ---          Mark first occurrence of given tag and set
-// ---          Mark second occurrence of given tag and set
-// ---          futureIndex = secondIndex - firstIndex
-// --- Return futureIndex
-//
-// --- Possible error: Will only give the distance between the first two occurrences
-// ---                  If there are more than 2 occurrences, the result will only
-// ---                  come from the first two.
+bool loadRegions(char *name)
+{
+    // Function Variables
+    FILE *file;                     // Region map being read
+    char *line;                     // Current line of the map
+    RegionRange *ranges = NULL;     // Ranges read
+    RegionRange *grown;             // Array reallocated to fit the next range
+    long capacity = 0;              // Ranges the array has room for
+    long count = 0;                 // Ranges read
+    unsigned long long start, end;  // Range of the current line
+    char perms[8];                  // Permissions field of a /proc/<pid>/maps line
+    char *label;                    // Name of the current range
+    size_t length;                  // Characters of the current line
+    int used;                       // Characters of the line before the name
+    bool loaded = true;             // Flag indicating every line so far was read
+    long index;                     // Index counter for moving through the ranges
+
+    file = fopen(name, "r");
+    line = malloc(REGION_LINE_MAX);
+    if(file == NULL || line == NULL)
+    {
+        if(file != NULL)
+        {
+            fclose(file);
+        }
+        free(line);
+        return false;
+    }
+
+    while(loaded && fgets(line, REGION_LINE_MAX, file) != NULL)
+    {
+        // Drop the line break and trailing blanks
+        for (length = strlen(line); length > 0 && isspace((unsigned char)line[length - 1]); length--)
+        {
+        }
+        line[length] = '\0';
+        label = line + strspn(line, " \t");
+        if(*label == '\0' || *label == '#')
+        {
+            continue;
+        }
+
+        used = -1;
+        if(sscanf(label, "%llx-%llx %n", &start, &end, &used) != 2 || used < 0)
+        {
+            loaded = false;
+            break;
+        }
+        label += used;
+
+        // A /proc/<pid>/maps line names its range by the path after the inode
+        used = -1;
+        if(sscanf(label, "%7s %*x %*x:%*x %*u %n", perms, &used) == 1 && used >= 0 && strlen(perms) == 4
+            && (perms[3] == 'p' || perms[3] == 's'))
+        {
+            label = label[used] != '\0' ? label + used : "[anonymous]";
+        }
+        else if(*label == '\0')
+        {
+            loaded = false;
+            break;
+        }
+
+        if(count == capacity)
+        {
+            capacity = capacity > 0 ? 2 * capacity : 64;
+            grown = realloc(ranges, capacity * sizeof(RegionRange));
+            if(grown == NULL)
+            {
+                loaded = false;
+                break;
+            }
+            ranges = grown;
+        }
+        ranges[count].start = start;
+        ranges[count].end = end;
+        ranges[count].name = strdup(label);
+        if(ranges[count++].name == NULL)
+        {
+            loaded = false;
+        }
+    }
+    fclose(file);
+    free(line);
+
+    // The index copies the names it keeps
+    if(loaded)
+    {
+        regions = regionCreate(ranges, count);
+    }
+    for (index = 0; index < count; index++)
+    {
+        free((char *)ranges[index].name);
+    }
+    free(ranges);
+
+    return regions != NULL;
+}
+
 // ****************************************************************************************************
-int farthestInFuture(unsigned long long tag, unsigned long long set)
+// Print Regions Function
+// --- Prints the REGION_TOP regions with the most misses, each with its share of all misses and the
+// --- lines it evicted and lost
+// ****************************************************************************************************
+void printRegions(long long misses)
 {
     // Function Variables
-    char *compHexAddress;           // Char array containing single address in hexidecimal for future queries list
-    char *compBinaryAddress;        // Char array containing single address in binary for future queries list
-    char *compTagString;            // String representation of tag from future queries
-    char *compSetBuffer;            // String representation of set and offset of future queries
-    char *compSetString;            // String representation of tag from future queries for comparison
-    unsigned long long compTag;     // Integer representation of tag from future queries
-    unsigned long long compSet;     // Integer representation of set from future queries
-    bool firstFlag = false;         // Boolean flag representing that the firstIndex was set
-    bool secondFlag = false;        // Boolean flag representing that the futureIndex was set
-    int firstIndex;                 // Integer representing the number of indexes until the first occurrence of the given set and tag
-    int futureIndex;                // Integer representing the number of indexes until the next occurrence of the given set and tag
-    int index;                      // Index for marking futureIndex
+    RegionStats stats[REGION_TOP];  // Regions with the most misses
+    long count;                     // Number of regions filled in
+    long index;                     // Index counter for moving through the regions
 
-    // Allocate memory for compHexAddress
-    compHexAddress = malloc(HEXCHARMAX * sizeof(char));
+    count = regionGetStats(regions, stats, REGION_TOP);
+    for (index = 0; index < count; index++)
+    {
+        printf("[region] name: %s hits: %lld misses: %lld miss rate: %.1f%% share of misses: %.1f%% evictions: %lld evicted: %lld\n",
+            stats[index].name, stats[index].hits, stats[index].misses,
+            stats[index].hits + stats[index].misses > 0 ? stats[index].misses * 100.0 / (stats[index].hits + stats[index].misses) : 0.0,
+            misses > 0 ? stats[index].misses * 100.0 / misses : 0.0, stats[index].evictions, stats[index].evicted);
+    }
+}
 
-    // Allocate memory for compBinaryAddress
-    compBinaryAddress = malloc(MAX3HEX * sizeof(char));
+// ****************************************************************************************************
+// Split Access Function
+// --- Simulates an access of a record of the given kind in the L1 cache of its side, and on a miss in
+// --- the unified L2, counting the L2 outcome in the counters of the side. Displays the address and
+// --- kind followed by the outcome of each level reached.
+// ****************************************************************************************************
+void splitAccess(Cache *level1, CacheStats *level2Side, char kind, unsigned long long address)
+{
+    // Function Variables
+    CacheResult result;             // Outcome of the L2 access
 
-    // While addresses left in input file, store each within a list of future queries
-    while(fscanf(pFile, "%s", compHexAddress) > 0)
+    if(cacheAccess(level1, address) == CACHE_HIT)
     {
-        if(usedFlag == false)
+        if(quiet == false)
         {
-            // Convert hexidecimal line to binary
-            compBinaryAddress = hexToBinary(compHexAddress);
+            printf("%llx %c L1 H\n", address, kind);
+        }
+        return;
+    }
 
-            // Extract tag from address as string and convert to unsigned long long integer
-            compTag = binToDecimal((unsigned long long)atoi(memcpy(compTagString, compBinaryAddress, tagSize)));
-            compSetBuffer = &compBinaryAddress[tagSize];
+    result = cacheAccess(cache, address);
+    if(result == CACHE_HIT)
+    {
+        level2Side->hits++;
+    }
+    else
+    {
+        level2Side->misses++;
+        level2Side->evictions += result == CACHE_EVICT;
+    }
 
-            // Extract set from address as string and convert to unsigned long long integer
-            strncpy(compSetString, compSetBuffer, setBits);
-            compSet = binToDecimal(atoi(compSetString));
+    if(quiet == false)
+    {
+        printf("%llx %c L1 M L2 %c\n", address, kind, result == CACHE_HIT ? 'H' : 'M');
+    }
+}
 
-            // If the given tag and set match the comparison tag and set and the firstFlag and secondFlag are false
-            if(tag == compTag && set == compSet && firstFlag == false && secondFlag == false)
-            {
-                // Mark the index of the first occurrence of the set and tag
-                firstIndex = index;
-                firstFlag = true;
-            }
-            
-            // If the given tag and set match the comparison tag and set and the firstFlag is true and the secondFlag is false
-            if(tag == compTag && set == compSet && firstFlag == true && secondFlag == false)
-            {
-                // Mark the index of the second occurrence of the set and tag
-                futureIndex = index - firstIndex;
-                secondFlag = true;
-            }
+// ****************************************************************************************************
+// Print Level Function
+// --- Prints the accesses, hits, misses, evictions, and miss rate of one cache of the hierarchy
+// ****************************************************************************************************
+void printLevel(const char *label, const CacheStats *stats)
+{
+    // Function Variables
+    long long accesses = stats->hits + stats->misses;
+
+    printf("[%s] accesses: %lld hits: %lld misses: %lld evictions: %lld miss rate: %.2f%%\n", label, accesses, stats->hits,
+        stats->misses, stats->evictions, accesses > 0 ? stats->misses * 100.0 / accesses : 0.0);
+}
+
+// ****************************************************************************************************
+// Split Sim Function
+// --- Reads a trace of records "kind address", kind I for an instruction fetch and D, L, or S for a
+// --- data access (M, a load and store of the same address, is two data accesses), e.g. the output of
+// --- valgrind --tool=lackey --trace-mem=yes, whose ==pid== lines are skipped. Instruction fetches go
+// --- to an L1 instruction cache and data accesses to an L1 data cache, each configured by -x or -y
+// --- over the arguments of the cache, which serves the misses of both as a unified L2. Prints the
+// --- counters of each cache and of the L2 traffic of each side; the result counts the accesses L2
+// --- missed as misses. Returns false if -x or -y is invalid or a record is malformed.
+// ****************************************************************************************************
+bool splitSim(void)
+{
+    // Function Variables
+    CacheConfig config;             // Config of the current L1, the arguments overridden by its model
+    Cache *instruction = NULL;      // L1 instruction cache
+    Cache *data = NULL;             // L1 data cache
+    CacheStats instructionStats;    // Counters of the L1 instruction cache
+    CacheStats dataStats;           // Counters of the L1 data cache
+    CacheStats level2Stats;         // Counters of the L2
+    CacheStats instructionSide = {0};   // L2 outcomes of the instruction cache's misses
+    CacheStats dataSide = {0};      // L2 outcomes of the data cache's misses
+    unsigned long long address;     // Address of the current record
+    char kind;                      // Access type of the current record
+    long long line = 0;             // Records read so far
+    long long accesses;             // Accesses of every L1
+    long long misses;               // Accesses missing in L2 as well
+
+    cacheConfig(&config);
+    if(parseModel(instructionModel, &config) == false || (instruction = cacheCreate(&config)) == NULL)
+    {
+        printf("[ERROR] Invalid -x cache - use key=value pairs of m,s,e,b,r,S,E,h ... [EXITING PROGRAM]\n");
+        return false;
+    }
+    cacheConfig(&config);
+    if(parseModel(dataModel, &config) == false || (data = cacheCreate(&config)) == NULL)
+    {
+        printf("[ERROR] Invalid -y cache - use key=value pairs of m,s,e,b,r,S,E,h ... [EXITING PROGRAM]\n");
+        cacheDestroy(instruction);
+        return false;
+    }
+
+    while(fscanf(pFile, " %c", &kind) == 1)
+    {
+        // Lines of valgrind's own messages start with ==pid==
+        if(kind == '=')
+        {
+            fscanf(pFile, "%*[^\n]");
+            continue;
         }
-        
-        index++;
+
+        line++;
+        if(fscanf(pFile, "%127s", hexAddress) != 1)
+        {
+            printf("[ERROR] Record %lld: expected kind address ... [EXITING PROGRAM]\n", line);
+            cacheDestroy(instruction);
+            cacheDestroy(data);
+            return false;
+        }
+        address = strtoull(hexAddress, NULL, 16);
+        switch (kind)
+        {
+            case 'I':
+                splitAccess(instruction, &instructionSide, kind, address);
+                break;
+            case 'M':
+                splitAccess(data, &dataSide, kind, address);
+                splitAccess(data, &dataSide, kind, address);
+                break;
+            case 'D':
+            case 'L':
+            case 'S':
+                splitAccess(data, &dataSide, kind, address);
+                break;
+            default:
+                printf("[ERROR] Record %lld: access type %c is not I, D, L, S, or M ... [EXITING PROGRAM]\n", line, kind);
+                cacheDestroy(instruction);
+                cacheDestroy(data);
+                return false;
+        }
+
+        // Once the warm-up records have passed, reset counters so cold-start misses are not counted
+        if(warmUp > 0 && line == warmUp)
+        {
+            printf("[warmup] records: %lld\n", line);
+            cacheResetStats(instruction);
+            cacheResetStats(data);
+            cacheResetStats(cache);
+            instructionSide = (CacheStats){0};
+            dataSide = (CacheStats){0};
+        }
+    }
+
+    cacheGetStats(instruction, &instructionStats);
+    cacheGetStats(data, &dataStats);
+    cacheGetStats(cache, &level2Stats);
+    printLevel("l1i", &instructionStats);
+    printLevel("l1d", &dataStats);
+    printLevel("l2i", &instructionSide);
+    printLevel("l2d", &dataSide);
+    printLevel("l2", &level2Stats);
+
+    // Every access takes the L1 hit time, L1 misses the L2 hit time, and L2 misses the miss penalty
+    accesses = instructionStats.hits + instructionStats.misses + dataStats.hits + dataStats.misses;
+    misses = level2Stats.misses;
+    missRate = accesses > 0 ? misses * 100.0L / accesses : 0;
+    runTime = accesses * HIT_TIME + (instructionStats.misses + dataStats.misses) * L2_HIT_TIME + misses * MISS_PENALTY;
+    printResult(accesses - misses, misses, missRate, runTime);
+
+    cacheDestroy(instruction);
+    cacheDestroy(data);
+    return true;
+}
+
+// ****************************************************************************************************
+// Hash Bytes Function
+// --- Folds length bytes into hash eight at a time, then any bytes left one at a time
+// ****************************************************************************************************
+static unsigned long long hashBytes(unsigned long long hash, const unsigned char *bytes, size_t length)
+{
+    // Function Variables
+    unsigned long long word;        // Eight bytes of the input
+    size_t position;                // Index counter for moving through the bytes
+
+    for (position = 0; position + sizeof(word) <= length; position += sizeof(word))
+    {
+        memcpy(&word, bytes + position, sizeof(word));
+        hash = (hash ^ word) * CACHE_HASH_MULTIPLIER;
+        hash ^= hash >> 32;
+    }
+    for (; position < length; position++)
+    {
+        hash = (hash ^ bytes[position]) * CACHE_HASH_MULTIPLIER;
+    }
+
+    return hash;
+}
+
+// ****************************************************************************************************
+// Hash File Function
+// --- Hashes the content and length of the regular file name into hash, TRACE_CHUNK bytes at a
+// --- time. Returns false if the file cannot be read or is a pipe or device, read only once.
+// ****************************************************************************************************
+bool hashFile(const char *name, unsigned long long *hash)
+{
+    // Function Variables
+    struct stat status;             // Type of the file
+    unsigned char *buffer;          // Chunk of the file
+    unsigned long long length = 0;  // Bytes hashed
+    size_t count;                   // Bytes of the current chunk
+    FILE *file;
+
+    if(stat(name, &status) != 0 || S_ISREG(status.st_mode) == false || (file = fopen(name, "rb")) == NULL)
+    {
+        return false;
+    }
+    buffer = malloc(TRACE_CHUNK);
+    if(buffer == NULL)
+    {
+        fclose(file);
+        return false;
     }
 
-    // Free malloc'd memory from compHexAddress and compBinaryAddress
-    free(compHexAddress);
-    free(compBinaryAddress);
+    *hash = RESULT_SEED;
+    while((count = fread(buffer, 1, TRACE_CHUNK, file)) > 0)
+    {
+        *hash = hashBytes(*hash, buffer, count);
+        length += count;
+    }
+    *hash = hashBytes(*hash, (const unsigned char *)&length, sizeof(length));
 
-    return futureIndex;
+    free(buffer);
+    fclose(file);
+    return true;
 }
 
-************************************************************************************************************************************************************************************************************************/
+// ****************************************************************************************************
+// Hash Plugin Function
+// --- Folds the hash of the shared object of a plugin:path algorithm found in spec, up to the next
+// --- comma, into hash, so every plugin of a run counts. Returns false if it cannot be read; specs
+// --- without a plugin leave hash as it was.
+// ****************************************************************************************************
+static bool hashPlugin(const char *spec, unsigned long long *hash)
+{
+    // Function Variables
+    const char *path;               // Path after the plugin prefix
+    char *name;                     // Path copied up to the next comma
+    unsigned long long fileHash;    // Hash of the shared object alone
+    bool valid;
+
+    if(spec == NULL || (path = strstr(spec, "plugin:")) == NULL)
+    {
+        return true;
+    }
+    path += strlen("plugin:");
+    name = strndup(path, strcspn(path, ","));
+    valid = name != NULL && hashFile(name, &fileHash);
+    free(name);
+    if(valid)
+    {
+        *hash = hashBytes(*hash, (const unsigned char *)&fileHash, sizeof(fileHash));
+    }
+
+    return valid;
+}
 
 // ****************************************************************************************************
-// Hexidecimal To Binary Function
-// --- Receives char array in the form of a hexidecimal representation and converts it to binary
-// --- and returns the resulting binary char array
+// Result Key Function
+// --- Writes the key of a run into key: every option as parsed, so their order and spelling do not
+// --- matter, then the hash of each trace, of any region map and plugin, and of this program, so a
+// --- rebuilt engine never replays results of the old one. Returns false if any of them cannot be hashed.
 // ****************************************************************************************************
-char *hexToBinary(char *hex)
+bool resultKey(char *key, size_t size)
 {
     // Function Variables
-    int addZeros;                   // Used for adding sets of '0' to the binary address before the hexidecimal conversion
+    unsigned long long hash;        // Hash of the current file
+    char *names;                    // Copy of fileName split at its commas
+    char *token;                    // Current comma separated file name
+    size_t length;                  // Characters of key so far
+
+    length = snprintf(key, size, "m=%d s=%d e=%d b=%d r=%s w=%lld t=%lld S=%d E=%d h=%s R=%s W=%s U=%ld D=%s g=%d M=%d L=%d B=%d I=%d T=%d d=%s q=%d o=%ld P=%lld K=%d F=%d x=%s y=%s",
+        addressSize, setBits, linesPerSet, blockOffsetBits, algorithm, warmUp, interval, numSets, numWays,
+        indexHash != NULL ? indexHash : "-", tenantRates != NULL ? tenantRates : "-", tenantWays != NULL ? tenantWays : "-",
+        partitionEpoch, diffModel != NULL ? diffModel : "-", regionBits, numMshrs, memoryLatency, transferCycles,
+        issueInterval, timestamped, dramSpec != NULL ? dramSpec : "-", quiet, lookahead, phaseLength, maxPhases, sharingTrace,
+        instructionModel != NULL ? instructionModel : "-", dataModel != NULL ? dataModel : "-");
+
+    // Shared runs print the name of every trace, so it is part of their key
+    names = strdup(fileName);
+    if(names == NULL)
+    {
+        return false;
+    }
+    for (token = strtok(names, ","); token != NULL && length < size; token = strtok(NULL, ","))
+    {
+        if(hashFile(token, &hash) == false)
+        {
+            free(names);
+            return false;
+        }
+        length += snprintf(key + length, size - length, " %s=%016llx", strchr(fileName, ',') != NULL ? token : "i", hash);
+    }
+    free(names);
 
-    // Allocate memory for binary character array
-    binaryAddress = malloc(MAX3HEX * sizeof(char));
+    // The region map is read like a trace, so its content is part of the key
+    if(regionFile != NULL && length < size)
+    {
+        if(hashFile(regionFile, &hash) == false)
+        {
+            return false;
+        }
+        length += snprintf(key + length, size - length, " A=%016llx", hash);
+    }
 
-    // Add zeros to make address proper length of bits
-    for(addZeros = (addressSize - (strlen(hex) * 4)); addZeros > 0; addZeros--)
+    hash = RESULT_SEED;
+    if(length >= size || hashPlugin(algorithm, &hash) == false || hashPlugin(diffModel, &hash) == false
+        || hashPlugin(instructionModel, &hash) == false || hashPlugin(dataModel, &hash) == false)
     {
-        strncat(binaryAddress, "0", 2);
+        return false;
     }
-    // For each char of hex add binary conversion to new binary string
-    for (i = 0; i < strlen(hex); i++)
+    length += snprintf(key + length, size - length, " plugin=%016llx", hash);
+    if(length >= size || hashFile("/proc/self/exe", &hash) == false)
     {
-        if(hex[i] == '0')
-            strncat(binaryAddress, "0000", 5);
-        else if(hex[i] == '1')
-            strncat(binaryAddress, "0001", 5);
-        else if(hex[i] == '2')
-            strncat(binaryAddress, "0010", 5);
-        else if(hex[i] == '3')
-            strncat(binaryAddress, "0011", 5);
-        else if(hex[i] == '4')
-            strncat(binaryAddress, "0100", 5);
-        else if(hex[i] == '5')
-            strncat(binaryAddress, "0101", 5);
-        else if(hex[i] == '6')
-            strncat(binaryAddress, "0110", 5);
-        else if(hex[i] == '7')
-            strncat(binaryAddress, "0111", 5);
-        else if(hex[i] == '8')
-            strncat(binaryAddress, "1000", 5);
-        else if(hex[i] == '9')
-            strncat(binaryAddress, "1001", 5);
-        else if(hex[i] == 'A')
-            strncat(binaryAddress, "1010", 5);
-        else if(hex[i] == 'B')
-            strncat(binaryAddress, "1011", 5);
-        else if(hex[i] == 'C')
-            strncat(binaryAddress, "1100", 5);
-        else if(hex[i] == 'D')
-            strncat(binaryAddress, "1101", 5);
-        else if(hex[i] == 'E')
-            strncat(binaryAddress, "1110", 5);
-        else if(hex[i] == 'F')
-            strncat(binaryAddress, "1111", 5);
+        return false;
     }
+    length += snprintf(key + length, size - length, " engine=%016llx", hash);
 
-    // Return binaryAddress char*
-    return binaryAddress;
+    return length < size;
 }
 
 // ****************************************************************************************************
-// Binary To Decimal Function
-// --- Converts binary to decimal
+// Result Cache Function
+// --- With -k, looks up the output of an earlier run with the same key in resultDir. Returns true
+// --- once that output has been printed again. Otherwise the output of this run is captured in a
+// --- temporary file that finishResult moves into resultDir at exit, after printing it. Runs that
+// --- read or write other files (-c, -l, -Q), measure wall time (-p), or read a pipe are not cached.
 // ****************************************************************************************************
-int binToDecimal(unsigned long long binary)
+bool resultCache(void)
 {
-  int decimal = 0;                  // Decimal conversion of binary
-  int i = 0;                        // Index for conversion
-  int remainder;                    // Remainder of modulus 10 for conversion to decimal
+    // Function Variables
+    char key[RESULT_KEY_MAX];       // Options and hashes of the inputs of the run
+    char line[RESULT_KEY_MAX];      // First line of a stored result, its key
+    char *path;                     // Stored result of the key
+    unsigned char *buffer;          // Chunk of the stored output being printed
+    size_t count;                   // Bytes of the current chunk
+    FILE *stored;                   // Stored result being printed
+    int temp;                       // Descriptor of the capture file
+
+    if(checkpointFile != NULL || restoreFile != NULL || numSlices > 0 || phaseFile != NULL || resultKey(key, sizeof(key)) == false)
+    {
+        return false;
+    }
+
+    // Name the stored result after the hash of its key, whose full text it starts with
+    path = malloc(strlen(resultDir) + 32);
+    resultTemp = malloc(strlen(resultDir) + 32);
+    if(path == NULL || resultTemp == NULL)
+    {
+        free(path);
+        free(resultTemp);
+        resultTemp = NULL;
+        return false;
+    }
+    sprintf(path, "%s/%016llx.out", resultDir, hashBytes(RESULT_SEED, (const unsigned char *)key, strlen(key)));
+    sprintf(resultTemp, "%s/.result.XXXXXX", resultDir);
+
+    stored = fopen(path, "rb");
+    if(stored != NULL)
+    {
+        if(fgets(line, sizeof(line), stored) != NULL && strcspn(line, "\n") == strlen(key) && strncmp(line, key, strlen(key)) == 0
+            && (buffer = malloc(TRACE_CHUNK)) != NULL)
+        {
+            while((count = fread(buffer, 1, TRACE_CHUNK, stored)) > 0)
+            {
+                fwrite(buffer, 1, count, stdout);
+            }
+            free(buffer);
+            fclose(stored);
+            free(path);
+            free(resultTemp);
+            resultTemp = NULL;
+            return true;
+        }
+        fclose(stored);
+    }
+
+    // Capture stdout from here on, behind the key, creating resultDir if it is missing
+    fflush(stdout);
+    mkdir(resultDir, 0777);
+    temp = mkstemp(resultTemp);
+    if(temp >= 0 && dprintf(temp, "%s\n", key) > 0 && (resultStdout = dup(STDOUT_FILENO)) >= 0)
+    {
+        dup2(temp, STDOUT_FILENO);
+        resultPath = path;
+        atexit(finishResult);
+    }
+    else
+    {
+        // Run uncaptured, leaving no capture file behind
+        if(temp >= 0)
+        {
+            unlink(resultTemp);
+        }
+        free(path);
+        free(resultTemp);
+        resultTemp = NULL;
+    }
+    if(temp >= 0)
+    {
+        close(temp);
+    }
+
+    return false;
+}
 
-  while (binary != 0) 
-  {
-    remainder = binary % 10;
-    binary /= 10;
-    decimal += remainder * pow(2, i);
-    ++i;
-  }
+// ****************************************************************************************************
+// Finish Result Function
+// --- Restores stdout and prints the captured output to it. The capture is kept as the result of
+// --- its key if the run completed, otherwise removed.
+// ****************************************************************************************************
+void finishResult(void)
+{
+    // Function Variables
+    unsigned char *buffer;          // Chunk of the captured output being printed
+    size_t count;                   // Bytes of the current chunk
+    FILE *captured;                 // Capture file, read back from its start
+
+    fflush(stdout);
+    dup2(resultStdout, STDOUT_FILENO);
+    close(resultStdout);
+
+    // Print the capture after its key line
+    captured = fopen(resultTemp, "rb");
+    buffer = malloc(TRACE_CHUNK);
+    if(captured != NULL && buffer != NULL && fgets((char *)buffer, TRACE_CHUNK, captured) != NULL)
+    {
+        while((count = fread(buffer, 1, TRACE_CHUNK, captured)) > 0)
+        {
+            fwrite(buffer, 1, count, stdout);
+        }
+    }
+    free(buffer);
+    if(captured != NULL)
+    {
+        fclose(captured);
+    }
+    fflush(stdout);
 
-  return decimal;
+    if(resultComplete == false || rename(resultTemp, resultPath) != 0)
+    {
+        unlink(resultTemp);
+    }
+    free(resultPath);
+    free(resultTemp);
 }
 
 // ****************************************************************************************************
@@ -795,20 +3059,129 @@ long double averageAccessTime(long double missRate)
 
 // ****************************************************************************************************
 // Total Run Time Function
-// --- Calculates runTime for printResult function
+// --- Calculates runTime for printResult function, rounded to the nearest cycle so a miss rate like
+// --- 2/3 that is not exact in floating point still gives the exact number of cycles
 // ****************************************************************************************************
-int totalRunTime(int size, long double avgAccessTime)
+long long totalRunTime(long long size, long double avgAccessTime)
 {
-    int runTime = size * avgAccessTime;
+    long long runTime = size * avgAccessTime + 0.5;
 
     return runTime;
 }
 
+// ****************************************************************************************************
+// Print Timing Function
+// --- Prints the cycles of the timing model next to the serialRunTime of a fixed penalty per miss,
+// --- with the memory requests, merged misses, MSHR stalls, and memory-level parallelism
+// ****************************************************************************************************
+void printTiming(long long serialRunTime)
+{
+    timingGetStats(timing, &timingStats);
+    printf("[timing] cycles: %llu serial cycles: %lld requests: %ld merged: %ld stall cycles: %llu memory parallelism: %.2f\n",
+        timingStats.cycles, serialRunTime, timingStats.requests, timingStats.merged, timingStats.stallCycles, timingStats.parallelism);
+}
+
+// ****************************************************************************************************
+// Parse Dram Function
+// --- Overrides config with the comma separated key=value pairs of spec, keys being channels, ranks,
+// --- banks, row (log2 bytes of a row buffer), map, hit, empty, and conflict. Returns false on an
+// --- unknown key.
+// ****************************************************************************************************
+bool parseDram(char *spec, DramConfig *config)
+{
+    // Function Variables
+    char *token;                    // Current key=value pair
+    char *value;                    // Value of the current pair
+
+    for (token = strtok(spec, ","); token != NULL; token = strtok(NULL, ","))
+    {
+        value = strchr(token, '=');
+        if(value == NULL)
+        {
+            return false;
+        }
+        *value++ = '\0';
+
+        if(strcmp(token, "channels") == 0) config->channels = atoi(value);
+        else if(strcmp(token, "ranks") == 0) config->ranks = atoi(value);
+        else if(strcmp(token, "banks") == 0) config->banks = atoi(value);
+        else if(strcmp(token, "row") == 0) config->columnBits = atoi(value);
+        else if(strcmp(token, "map") == 0) config->mapping = value;
+        else if(strcmp(token, "hit") == 0) config->rowHit = atoi(value);
+        else if(strcmp(token, "empty") == 0) config->rowEmpty = atoi(value);
+        else if(strcmp(token, "conflict") == 0) config->rowConflict = atoi(value);
+        else return false;
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Print Dram Function
+// --- Prints the row buffer hit rate and conflicts of the DRAM model, then every bank with conflicts
+// ****************************************************************************************************
+void printDram(void)
+{
+    // Function Variables
+    DramStats stats;                // Counters of the whole memory
+    DramBankStats bankStats;        // Counters of the current bank
+    int channel, rank, bank;
+
+    dramGetStats(dram, &stats);
+    printf("[dram] requests: %ld row hits: %ld row empty: %ld row conflicts: %ld row hit rate: %.1f%%\n", stats.requests,
+        stats.rowHits, stats.rowEmpty, stats.rowConflicts, stats.requests > 0 ? stats.rowHits * 100.0 / stats.requests : 0.0);
+
+    for (channel = 0; channel < dramConfig.channels; channel++)
+    {
+        for (rank = 0; rank < dramConfig.ranks; rank++)
+        {
+            for (bank = 0; bank < dramConfig.banks; bank++)
+            {
+                if(dramGetBankStats(dram, channel, rank, bank, &bankStats) && bankStats.conflicts > 0)
+                {
+                    printf("[bank] channel: %d rank: %d bank: %d requests: %ld conflicts: %ld\n", channel, rank, bank, bankStats.requests, bankStats.conflicts);
+                }
+            }
+        }
+    }
+}
+
+// ****************************************************************************************************
+// Print Interval Function
+// --- Prints the hit, miss, and eviction deltas since the last interval ended at access index end
+// --- and marks the start of the next interval
+// ****************************************************************************************************
+void printInterval(long long end)
+{
+    // Function Variables
+    CacheStats stats;               // Counters of the simulated cache at the end of the interval
+    long long deltaHits;
+    long long deltaMisses;
+    long long deltaEvictions;
+    int deltaMissRate = 0;
+
+    cacheGetStats(cache, &stats);
+    deltaHits = stats.hits - intervalHits;
+    deltaMisses = stats.misses - intervalMisses;
+    deltaEvictions = stats.evictions - intervalEvictions;
+
+    if(deltaHits + deltaMisses > 0)
+    {
+        deltaMissRate = (deltaMisses * 100) / (deltaHits + deltaMisses);
+    }
+
+    printf("[interval] end: %lld hits: %lld misses: %lld evictions: %lld miss rate: %d%%\n", end, deltaHits, deltaMisses, deltaEvictions, deltaMissRate);
+
+    intervalHits = stats.hits;
+    intervalMisses = stats.misses;
+    intervalEvictions = stats.evictions;
+}
+
 // ****************************************************************************************************
 // Print Result Function
 //
 // ****************************************************************************************************
-void printResult(int hits, int misses, int missRate, int runTime)
+void printResult(long long hits, long long misses, int missRate, long long runTime)
 {
-    printf("[result] hits: %d misses %d miss rate: %d%% total running time: %d cycle\n", hits, misses, missRate, runTime);
+    printf("[result] hits: %lld misses: %lld miss rate: %d%% total running time: %lld cycle\n", hits, misses, missRate, runTime);
 }
\ No newline at end of file
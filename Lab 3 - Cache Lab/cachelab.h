@@ -8,18 +8,70 @@
 
 #define HIT_TIME 1          // hit time fixed for calculating running time
 #define MISS_PENALTY 100    // miss penalty fixed for calculating running time
+#define L2_HIT_TIME 10      // hit time of the unified L2 behind split L1 caches (-x, -y)
 
-void printResult(int hits, int misses, int missRate, int runTime);
+#include <stdio.h>
+#include <stdbool.h>
+#include "libcachesim.h"
+
+// Modes of running the trace, chosen from the options given by checkOptions
+typedef enum{
+    MODE_SIMULATE,          // access by access simulation
+    MODE_SHARED,            // comma separated traces sharing the cache (sharedSim)
+    MODE_SHARING,           // false sharing analysis (-F, sharingAnalysis)
+    MODE_SPLIT,             // split L1 caches in front of the cache (-x, -y, splitSim)
+    MODE_PHASES,            // phase analysis (-P, phaseAnalysis)
+    MODE_PHASE_SIM,         // representative intervals of the phases (-Q, phaseSim)
+    MODE_PARALLEL,          // time slices in parallel (-p, parallelSim)
+    MODE_DIFF               // second model in lockstep (-D, diffSim)
+} RunMode;
+
+void printResult(long long hits, long long misses, int missRate, long long runTime);
+void printInterval(long long end);
 void initialize(int argc, char *argv[]);
+bool checkOptions(RunMode *mode);
+bool runTrace(RunMode mode);
+bool simulateTrace(void);
+void cacheConfig(CacheConfig *config);
 long double averageAccessTime(long double missRate);
-int totalRunTime(int numCode, long double avgAccessTime);
-void generateCache(int numSets, int numLines);
-void cacheSim(char *address);
-int leastRecentlyUsed(int set);
-int firstInFirstOut(int set);
-/*int optimal(int set);
-int farthestInFuture(unsigned long long tag, unsigned long long set);*/
-char *hexToBinary(char *hex);
-int binToDecimal(unsigned long long binary);
+long long totalRunTime(long long numCode, long double avgAccessTime);
+void cacheSim(unsigned long long address);
+void batchSim(void);
+bool saveCheckpoint(char *name);
+bool loadCheckpoint(char *name);
+bool readTraceHeader(FILE **file);
+bool readAddress(FILE *file, unsigned long long *address);
+bool readStream(FILE *file, unsigned long long *address);
+long readTrace(FILE *file, unsigned long long **addresses);
+bool readFuture(FILE *file);
+bool windowCreate(void);
+void windowDestroy(void);
+bool readWindow(FILE *file, unsigned long long *address);
+CacheResult windowAccess(unsigned long long address);
+void windowResetStats(void);
+void printWindow(void);
+bool skipAddresses(FILE *file, long long count);
+bool phaseAnalysis(void);
+bool phaseSim(void);
+void printGranules(unsigned long long mask, int granule);
+void printSharing(CacheSharing *sharing, bool falseSharing, int granule);
+bool sharingAnalysis(void);
+bool loadRegions(char *name);
+void printRegions(long long misses);
+void splitAccess(Cache *level1, CacheStats *level2Side, char kind, unsigned long long address);
+void printLevel(const char *label, const CacheStats *stats);
+bool splitSim(void);
+bool parallelSim(void);
+int parseList(char *list, int *values, int max);
+bool sharedSim(void);
+bool parseModel(char *spec, CacheConfig *config);
+bool diffSim(void);
+void printTiming(long long serialRunTime);
+bool parseDram(char *spec, DramConfig *config);
+void printDram(void);
+bool hashFile(const char *name, unsigned long long *hash);
+bool resultKey(char *key, size_t size);
+bool resultCache(void);
+void finishResult(void);
 
 #endif /* cachelab_h */
@@ -0,0 +1,137 @@
+// ****************************************************************************************************
+//
+//                                         cacheparallel.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                                   Time-Sliced Simulation:
+//
+//              [   slice 0   ][   slice 1   ][   slice 2   ][   slice 3   ]    <-Trace
+//                      [warm ][   slice 1   ]                                <-Worker 1
+//                                     [warm ][   slice 2   ]                 <-Worker 2
+//
+//                  The trace is split into contiguous time slices, each simulated by its own
+//                  thread on its own Cache. Before counting its slice a worker replays the warm-up
+//                  prefix just before it so the cache is no longer cold when the slice starts.
+//                  Counters of every slice are summed into the merged result, which only differs
+//                  from a sequential run when the warm-up prefix is too short to rebuild the state.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // header file for libcachesim.c
+#include <stdlib.h>                 // stdlib.h used for malloc()
+#include <string.h>                 // string.h used for memset()
+#include <pthread.h>                // pthread.h used for pthread_create()
+
+// Slice Struct
+typedef struct{
+    const CacheConfig *config;      // Config of the cache each worker creates
+    const unsigned long long *addresses; // Whole decoded trace
+    long warmStart;                 // Index of the first warm-up access of the slice
+    long start;                     // Index of the first counted access of the slice
+    long end;                       // Index one past the last counted access of the slice
+    CacheStats stats;               // Counters of the slice
+    bool valid;                     // Flag indicating the worker could create its cache
+} Slice;
+
+// ****************************************************************************************************
+// Simulate Slice Function
+// --- Thread body: creates a cache, replays the warm-up prefix, resets the counters, and simulates
+// --- the slice's own accesses
+// ****************************************************************************************************
+static void *simulateSlice(void *argument)
+{
+    // Function Variables
+    Slice *slice = argument;        // Slice assigned to this worker
+    Cache *cache;                   // Cache private to this worker
+
+    cache = cacheCreate(slice->config);
+    if(cache == NULL)
+    {
+        return NULL;
+    }
+
+    // Same-block runs are collapsed; the warm-up and the slice are collapsed separately so no run
+    // crosses the point where the counters are reset
+    cacheAccessCollapsed(cache, &slice->addresses[slice->warmStart], slice->start - slice->warmStart);
+    cacheResetStats(cache);
+    cacheAccessCollapsed(cache, &slice->addresses[slice->start], slice->end - slice->start);
+
+    cacheGetStats(cache, &slice->stats);
+    cacheDestroy(cache);
+    slice->valid = true;
+
+    return NULL;
+}
+
+// ****************************************************************************************************
+// Cache Simulate Sliced Function
+// --- Splits count addresses into numSlices contiguous slices simulated in parallel, each warmed up
+// --- on the warmUp accesses before it. The counters of every slice are stored in sliceStats when it
+// --- is not NULL and their sum in stats. Returns false if a worker could not be started.
+// ****************************************************************************************************
+bool cacheSimulateSliced(const CacheConfig *config, const unsigned long long *addresses, long count,
+    int numSlices, long warmUp, CacheStats *stats, CacheStats *sliceStats)
+{
+    // Function Variables
+    Slice *slices;                  // Work description and result of every slice
+    pthread_t *threads;             // Worker thread of every slice
+    bool *started;                  // Flag per slice indicating its thread was created
+    bool valid = true;              // Flag indicating every slice was simulated
+    int slice;                      // Index counter for moving through slices
+
+    if(numSlices <= 0 || count < 0 || warmUp < 0)
+    {
+        return false;
+    }
+
+    slices = calloc(numSlices, sizeof(Slice));
+    threads = calloc(numSlices, sizeof(pthread_t));
+    started = calloc(numSlices, sizeof(bool));
+    if(slices == NULL || threads == NULL || started == NULL)
+    {
+        free(slices);
+        free(threads);
+        free(started);
+        return false;
+    }
+
+    // Divide the trace evenly, giving the remainder to the first slices
+    for (slice = 0; slice < numSlices; slice++)
+    {
+        slices[slice].config = config;
+        slices[slice].addresses = addresses;
+        slices[slice].start = count / numSlices * slice + (slice < count % numSlices ? slice : count % numSlices);
+        slices[slice].end = slices[slice].start + count / numSlices + (slice < count % numSlices ? 1 : 0);
+        slices[slice].warmStart = slices[slice].start > warmUp ? slices[slice].start - warmUp : 0;
+        started[slice] = pthread_create(&threads[slice], NULL, simulateSlice, &slices[slice]) == 0;
+    }
+
+    // Wait for every worker and merge the counters
+    memset(stats, 0, sizeof(*stats));
+    for (slice = 0; slice < numSlices; slice++)
+    {
+        if(started[slice])
+        {
+            pthread_join(threads[slice], NULL);
+        }
+
+        valid = valid && started[slice] && slices[slice].valid;
+        stats->hits += slices[slice].stats.hits;
+        stats->misses += slices[slice].stats.misses;
+        stats->evictions += slices[slice].stats.evictions;
+
+        if(sliceStats != NULL)
+        {
+            sliceStats[slice] = slices[slice].stats;
+        }
+    }
+
+    free(slices);
+    free(threads);
+    free(started);
+
+    return valid;
+}
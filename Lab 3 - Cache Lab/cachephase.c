@@ -0,0 +1,336 @@
+// ****************************************************************************************************
+//
+//                                          cachephase.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                                     Working Set Signatures:
+//
+//                  block -> hash h:    [ bin (top PHASE_BIN_BITS) ][          rest          ]
+//                  signature:          bin 0: min h   bin 1: min h   ...   bin 63: min h
+//
+//                  Every block accessed in an interval is hashed once per access; each bin keeps
+//                  the smallest hash that fell into it (one permutation MinHash). Two intervals
+//                  touching the same blocks get the same minimums, and the share of bins that
+//                  agree estimates the Jaccard similarity of their working sets, whatever the
+//                  order or number of the accesses. The signature is a fixed PHASE_BINS words.
+//
+//                                            Clustering:
+//
+//                  Intervals are grouped by k-medoids on the distance 1 - similarity: medoids start
+//                  spread out (each new one the interval furthest from those chosen), then every
+//                  interval joins its nearest medoid and each cluster moves its medoid to the
+//                  member nearest the cluster's per-bin most common value, until nothing moves.
+//                  Every k up to the maximum is tried and the smallest k that removes 90% of the
+//                  distance removed by the best k is kept, as SimPoint does with its BIC score.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // header file for libcachesim.c
+#include <stdlib.h>                 // stdlib.h used for malloc()
+#include <string.h>                 // string.h used for memset()
+
+// Bin of an empty signature, above every hash
+#define PHASE_EMPTY ULLONG_MAX
+
+// Most rounds of assigning intervals and moving medoids per k
+#define PHASE_ITERATIONS 20
+
+// Share of the distance removed by the best k that the chosen k must remove
+#define PHASE_EXPLAINED 0.9
+
+// ****************************************************************************************************
+// Phase Signature Reset Function
+// --- Empties signature for the next interval
+// ****************************************************************************************************
+void phaseSignatureReset(PhaseSignature *signature)
+{
+    // Function Variables
+    int bin;                        // Index counter for moving through the bins
+
+    for (bin = 0; bin < PHASE_BINS; bin++)
+    {
+        signature->mins[bin] = PHASE_EMPTY;
+    }
+    signature->accesses = 0;
+}
+
+// ****************************************************************************************************
+// Phase Signature Add Function
+// --- Adds an access to block to signature
+// ****************************************************************************************************
+void phaseSignatureAdd(PhaseSignature *signature, unsigned long long block)
+{
+    // Function Variables
+    unsigned long long hash = block * CACHE_HASH_MULTIPLIER;
+    unsigned long long *bin;        // Bin the hash falls into
+
+    hash ^= hash >> 32;
+    hash *= 0xd6e8feb86659fd93ULL;
+    hash ^= hash >> 32;
+
+    bin = &signature->mins[hash >> (64 - PHASE_BIN_BITS)];
+    if(hash < *bin)
+    {
+        *bin = hash;
+    }
+    signature->accesses++;
+}
+
+// ****************************************************************************************************
+// Phase Distance Function
+// --- Returns 1 minus the estimated Jaccard similarity of the working sets of two signatures: the
+// --- share of the bins filled in either signature whose minimums differ, a bin filled in only one
+// --- counting as different. Two empty signatures are at distance 0.
+// ****************************************************************************************************
+double phaseDistance(const PhaseSignature *first, const PhaseSignature *second)
+{
+    // Function Variables
+    int used = 0;                   // Bins filled in either signature
+    int equal = 0;                  // Filled bins with the same minimum
+    int bin;                        // Index counter for moving through the bins
+
+    for (bin = 0; bin < PHASE_BINS; bin++)
+    {
+        if(first->mins[bin] != PHASE_EMPTY || second->mins[bin] != PHASE_EMPTY)
+        {
+            used++;
+            equal += first->mins[bin] == second->mins[bin];
+        }
+    }
+
+    return used > 0 ? 1.0 - (double)equal / used : 0.0;
+}
+
+// ****************************************************************************************************
+// Compare Hashes Function
+// --- Orders bin minimums for qsort
+// ****************************************************************************************************
+static int compareHashes(const void *first, const void *second)
+{
+    unsigned long long a = *(const unsigned long long *)first;
+    unsigned long long b = *(const unsigned long long *)second;
+
+    return (a > b) - (a < b);
+}
+
+// ****************************************************************************************************
+// Move Medoid Function
+// --- Returns the member of a cluster nearest its center, the most common minimum of every bin
+// --- among the members (the smallest on a tie). values holds room for every member.
+// ****************************************************************************************************
+static long moveMedoid(const PhaseSignature *signatures, const long *members, long count, unsigned long long *values)
+{
+    // Function Variables
+    PhaseSignature center;          // Most common minimum of every bin
+    long run, best;                 // Length of the current and the longest run of equal values
+    long medoid = members[0];       // Member nearest the center so far
+    double nearest = 2.0;           // Distance of that member
+    double distance;
+    long member, index;
+    int bin;
+
+    for (bin = 0; bin < PHASE_BINS; bin++)
+    {
+        for (member = 0; member < count; member++)
+        {
+            values[member] = signatures[members[member]].mins[bin];
+        }
+        qsort(values, count, sizeof(unsigned long long), compareHashes);
+
+        center.mins[bin] = values[0];
+        for (index = 0, run = 0, best = 0; index < count; index++)
+        {
+            run = index > 0 && values[index] == values[index - 1] ? run + 1 : 1;
+            if(run > best)
+            {
+                best = run;
+                center.mins[bin] = values[index];
+            }
+        }
+    }
+
+    for (member = 0; member < count; member++)
+    {
+        distance = phaseDistance(&signatures[members[member]], &center);
+        if(distance < nearest)
+        {
+            nearest = distance;
+            medoid = members[member];
+        }
+    }
+
+    return medoid;
+}
+
+// ****************************************************************************************************
+// K Medoids Function
+// --- Groups count signatures into at most k clusters, storing the cluster of every interval in
+// --- clusters and the interval chosen as each medoid in medoids. Fewer clusters are used when the
+// --- intervals have fewer distinct signatures. Returns the number of clusters and stores their
+// --- summed distance to the medoids in cost, or returns -1 if memory runs out.
+// ****************************************************************************************************
+static int kMedoids(const PhaseSignature *signatures, long count, int k, int *clusters, long *medoids, double *cost)
+{
+    // Function Variables
+    double *nearest = malloc(count * sizeof(double));   // Distance of every interval to its medoid
+    long *members = malloc(count * sizeof(long));       // Intervals ordered by cluster
+    long *starts = malloc((k + 1) * sizeof(long));      // First member of every cluster in members
+    unsigned long long *values = malloc(count * sizeof(unsigned long long)); // Scratch for moveMedoid
+    double distance;
+    long interval, furthest, moved;
+    int used = 1;                   // Clusters with a medoid
+    int cluster, iteration;
+
+    if(nearest == NULL || members == NULL || starts == NULL || values == NULL)
+    {
+        free(nearest);
+        free(members);
+        free(starts);
+        free(values);
+        return -1;
+    }
+
+    // Spread the medoids out: each new one is the interval furthest from those chosen
+    medoids[0] = 0;
+    for (interval = 0; interval < count; interval++)
+    {
+        nearest[interval] = phaseDistance(&signatures[interval], &signatures[0]);
+    }
+    while(used < k)
+    {
+        for (interval = 1, furthest = 0; interval < count; interval++)
+        {
+            furthest = nearest[interval] > nearest[furthest] ? interval : furthest;
+        }
+        if(nearest[furthest] == 0)
+        {
+            break;
+        }
+        medoids[used++] = furthest;
+        for (interval = 0; interval < count; interval++)
+        {
+            distance = phaseDistance(&signatures[interval], &signatures[furthest]);
+            nearest[interval] = distance < nearest[interval] ? distance : nearest[interval];
+        }
+    }
+
+    for (iteration = 0; iteration < PHASE_ITERATIONS; iteration++)
+    {
+        // Join every interval to its nearest medoid, the first on a tie
+        *cost = 0;
+        for (interval = 0; interval < count; interval++)
+        {
+            clusters[interval] = 0;
+            nearest[interval] = phaseDistance(&signatures[interval], &signatures[medoids[0]]);
+            for (cluster = 1; cluster < used; cluster++)
+            {
+                distance = phaseDistance(&signatures[interval], &signatures[medoids[cluster]]);
+                if(distance < nearest[interval])
+                {
+                    nearest[interval] = distance;
+                    clusters[interval] = cluster;
+                }
+            }
+            *cost += nearest[interval];
+        }
+
+        // Order the intervals by cluster, then move every medoid to the center of its members
+        memset(starts, 0, (k + 1) * sizeof(long));
+        for (interval = 0; interval < count; interval++)
+        {
+            starts[clusters[interval] + 1]++;
+        }
+        for (cluster = 0; cluster < used; cluster++)
+        {
+            starts[cluster + 1] += starts[cluster];
+        }
+        for (interval = 0; interval < count; interval++)
+        {
+            members[starts[clusters[interval]]++] = interval;
+        }
+        for (cluster = used; cluster > 0; cluster--)
+        {
+            starts[cluster] = starts[cluster - 1];
+        }
+        starts[0] = 0;
+
+        // A medoid whose signature another medoid shares may be left without members
+        for (cluster = 0, moved = 0; cluster < used; cluster++)
+        {
+            if(starts[cluster + 1] == starts[cluster])
+            {
+                continue;
+            }
+            interval = moveMedoid(signatures, members + starts[cluster], starts[cluster + 1] - starts[cluster], values);
+            moved += interval != medoids[cluster];
+            medoids[cluster] = interval;
+        }
+        if(moved == 0)
+        {
+            break;
+        }
+    }
+
+    free(nearest);
+    free(members);
+    free(starts);
+    free(values);
+    return used;
+}
+
+// ****************************************************************************************************
+// Phase Cluster Function
+// --- Groups the count interval signatures into phases of similar working sets, at most
+// --- maxClusters. Stores the phase of every interval in clusters and its representative interval
+// --- (the medoid) in representatives, which has room for maxClusters. Returns the number of
+// --- phases, or -1 if memory runs out.
+// ****************************************************************************************************
+int phaseCluster(const PhaseSignature *signatures, long count, int maxClusters, int *clusters, long *representatives)
+{
+    // Function Variables
+    double *costs;                  // Summed distance to the medoids of every k
+    int k;                          // Number of clusters tried
+    int chosen = 1;                 // Smallest k explaining enough of the distance
+    int best = 1;                   // k of the lowest cost
+    int used;                       // Clusters kMedoids found for k
+
+    if(count <= 0 || maxClusters <= 0)
+    {
+        return count <= 0 ? 0 : -1;
+    }
+    maxClusters = maxClusters < count ? maxClusters : count;
+    costs = malloc((maxClusters + 1) * sizeof(double));
+    if(costs == NULL)
+    {
+        return -1;
+    }
+
+    for (k = 1; k <= maxClusters; k++)
+    {
+        used = kMedoids(signatures, count, k, clusters, representatives, &costs[k]);
+        if(used < 0)
+        {
+            free(costs);
+            return -1;
+        }
+        best = costs[k] < costs[best] ? k : best;
+
+        // More clusters than distinct signatures cannot lower the cost further
+        if(used < k)
+        {
+            break;
+        }
+    }
+
+    while(chosen < best && costs[1] - costs[chosen] < PHASE_EXPLAINED * (costs[1] - costs[best]))
+    {
+        chosen++;
+    }
+
+    used = kMedoids(signatures, count, chosen, clusters, representatives, &costs[0]);
+    free(costs);
+    return used;
+}
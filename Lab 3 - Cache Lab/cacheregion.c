@@ -0,0 +1,293 @@
+// ****************************************************************************************************
+//
+//                                          cacheregion.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                                      Region Attribution:
+//
+//              starts:   [ 400000 | 601000 | 1a2b000 | 7f3c000 ]   sorted, never overlapping
+//              ends:     [ 401000 | 602000 | 1a4c000 | 7f3e000 ]
+//              owners:   [ a.out  | a.out  | [heap]  | libc.so ]   ranges sharing a name share a row
+//
+//              address 1a2b740 -> last start <= address is 1a2b000, below its end -> [heap]
+//
+//                  Every access looks up the region of its address by a branch-free binary search
+//                  over the sorted starts, after first trying the range the previous lookup found,
+//                  which nearby accesses usually fall in again. Hits and misses count towards the
+//                  region of the address; an eviction also counts towards the region of the block
+//                  it removed, so a region pushing out another one shows up on both rows.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // header file for libcachesim.c
+#include <stdlib.h>                 // stdlib.h used for malloc()
+#include <string.h>                 // string.h used for strcmp()
+
+// CacheRegions Struct
+struct CacheRegions{
+    unsigned long long *starts;     // First address of every range, ascending
+    unsigned long long *ends;       // Address after every range
+    long *owners;                   // Region of every range
+    long numRanges;                 // Number of ranges
+    RegionStats *stats;             // Counters of every region, REGION_UNMAPPED last
+    long numRegions;                // Number of regions including REGION_UNMAPPED
+    long lastAccess;                // Range the previous access fell in, -1 for none
+    long lastVictim;                // Range the previous evicted block fell in, -1 for none
+};
+
+// ****************************************************************************************************
+// Compare Starts Function
+// --- qsort comparison putting ranges in address order
+// ****************************************************************************************************
+static int compareStarts(const void *first, const void *second)
+{
+    // Function Variables
+    const RegionRange *a = *(const RegionRange *const *)first;
+    const RegionRange *b = *(const RegionRange *const *)second;
+
+    return a->start < b->start ? -1 : a->start > b->start;
+}
+
+// ****************************************************************************************************
+// Compare Names Function
+// --- qsort comparison putting ranges in name order, then address order
+// ****************************************************************************************************
+static int compareNames(const void *first, const void *second)
+{
+    // Function Variables
+    const RegionRange *a = *(const RegionRange *const *)first;
+    const RegionRange *b = *(const RegionRange *const *)second;
+    int order = strcmp(a->name, b->name);
+
+    return order != 0 ? order : compareStarts(first, second);
+}
+
+// ****************************************************************************************************
+// Region Create Function
+// --- Builds the index of count ranges, copying their names. Returns NULL if a range is empty, two
+// --- ranges overlap, or memory runs out.
+// ****************************************************************************************************
+CacheRegions *regionCreate(const RegionRange *ranges, long count)
+{
+    // Function Variables
+    CacheRegions *regions;          // Index being created
+    const RegionRange **sorted;     // Ranges in name order, then in address order
+    long *ownerOf;                  // Region of every range, in the order given
+    bool valid;                     // Flag indicating every allocation and range so far is fine
+    long index;                     // Index counter for moving through the ranges
+
+    regions = calloc(1, sizeof(CacheRegions));
+    sorted = malloc((count > 0 ? count : 1) * sizeof(RegionRange *));
+    ownerOf = malloc((count > 0 ? count : 1) * sizeof(long));
+    if(regions == NULL || sorted == NULL || ownerOf == NULL)
+    {
+        free(regions);
+        free(sorted);
+        free(ownerOf);
+        return NULL;
+    }
+    regions->numRanges = count;
+    regions->lastAccess = -1;
+    regions->lastVictim = -1;
+    regions->starts = malloc((count > 0 ? count : 1) * sizeof(unsigned long long));
+    regions->ends = malloc((count > 0 ? count : 1) * sizeof(unsigned long long));
+    regions->owners = malloc((count > 0 ? count : 1) * sizeof(long));
+    regions->stats = calloc(count + 1, sizeof(RegionStats));
+    valid = regions->starts != NULL && regions->ends != NULL && regions->owners != NULL && regions->stats != NULL;
+
+    // Number the distinct names
+    for (index = 0; index < count; index++)
+    {
+        sorted[index] = &ranges[index];
+    }
+    qsort(sorted, count, sizeof(RegionRange *), compareNames);
+    for (index = 0; valid && index < count; index++)
+    {
+        if(index == 0 || strcmp(sorted[index]->name, sorted[index - 1]->name) != 0)
+        {
+            regions->stats[regions->numRegions].name = strdup(sorted[index]->name);
+            valid = regions->stats[regions->numRegions++].name != NULL;
+        }
+        ownerOf[sorted[index] - ranges] = regions->numRegions - 1;
+    }
+
+    // Lay the ranges out in address order, none overlapping the one before
+    qsort(sorted, count, sizeof(RegionRange *), compareStarts);
+    for (index = 0; valid && index < count; index++)
+    {
+        regions->starts[index] = sorted[index]->start;
+        regions->ends[index] = sorted[index]->end;
+        regions->owners[index] = ownerOf[sorted[index] - ranges];
+        valid = regions->starts[index] < regions->ends[index] && (index == 0 || regions->starts[index] >= regions->ends[index - 1]);
+    }
+
+    if(valid)
+    {
+        regions->stats[regions->numRegions].name = strdup(REGION_UNMAPPED);
+        valid = regions->stats[regions->numRegions++].name != NULL;
+    }
+    free(sorted);
+    free(ownerOf);
+    if(valid == false)
+    {
+        regionDestroy(regions);
+        return NULL;
+    }
+
+    return regions;
+}
+
+// ****************************************************************************************************
+// Region Destroy Function
+// --- Frees an index; NULL is ignored
+// ****************************************************************************************************
+void regionDestroy(CacheRegions *regions)
+{
+    // Function Variables
+    long index;                     // Index counter for moving through the regions
+
+    if(regions == NULL)
+    {
+        return;
+    }
+
+    for (index = 0; regions->stats != NULL && index < regions->numRegions; index++)
+    {
+        free((char *)regions->stats[index].name);
+    }
+    free(regions->starts);
+    free(regions->ends);
+    free(regions->owners);
+    free(regions->stats);
+    free(regions);
+}
+
+// ****************************************************************************************************
+// Find Region Function
+// --- Returns the region of address, trying the range last first and leaving last at the range found
+// ****************************************************************************************************
+static long findRegion(const CacheRegions *regions, unsigned long long address, long *last)
+{
+    // Function Variables
+    long base = 0;                  // Last range known to start at or below address, if any does
+    long remaining = regions->numRanges; // Ranges from base still to search
+    long half;                      // Ranges skipped by the current step
+
+    if(*last >= 0 && address >= regions->starts[*last] && address < regions->ends[*last])
+    {
+        return regions->owners[*last];
+    }
+
+    // Halve the ranges left with a conditional move rather than a branch, which scattered
+    // addresses would mispredict at every step
+    while(remaining > 1)
+    {
+        half = remaining / 2;
+        base = regions->starts[base + half] <= address ? base + half : base;
+        remaining -= half;
+    }
+    if(regions->numRanges > 0 && address >= regions->starts[base] && address < regions->ends[base])
+    {
+        *last = base;
+        return regions->owners[base];
+    }
+
+    return regions->numRegions - 1;
+}
+
+// ****************************************************************************************************
+// Region Access Function
+// --- Counts an access to address that the cache answered with result, and for CACHE_EVICT the
+// --- eviction of the block at victim (cacheLastVictim)
+// ****************************************************************************************************
+void regionAccess(CacheRegions *regions, unsigned long long address, CacheResult result, unsigned long long victim)
+{
+    // Function Variables
+    RegionStats *stats = &regions->stats[findRegion(regions, address, &regions->lastAccess)];
+
+    if(result == CACHE_HIT)
+    {
+        stats->hits++;
+        return;
+    }
+
+    stats->misses++;
+    if(result == CACHE_EVICT)
+    {
+        stats->evictions++;
+        regions->stats[findRegion(regions, victim, &regions->lastVictim)].evicted++;
+    }
+}
+
+// ****************************************************************************************************
+// Compare Stats Function
+// --- qsort comparison putting the regions with the most misses first, then the most lines evicted
+// ****************************************************************************************************
+static int compareStats(const void *first, const void *second)
+{
+    // Function Variables
+    const RegionStats *a = first;
+    const RegionStats *b = second;
+
+    if(a->misses != b->misses)
+    {
+        return a->misses < b->misses ? 1 : -1;
+    }
+    if(a->evicted != b->evicted)
+    {
+        return a->evicted < b->evicted ? 1 : -1;
+    }
+
+    return strcmp(a->name, b->name);
+}
+
+// ****************************************************************************************************
+// Region Get Stats Function
+// --- Fills stats with up to max regions accessed or evicted from, those with the most misses first.
+// --- Returns the number of regions filled, or -1 if memory runs out. The names stay owned by regions.
+// ****************************************************************************************************
+long regionGetStats(const CacheRegions *regions, RegionStats *stats, long max)
+{
+    // Function Variables
+    RegionStats *active;            // Regions accessed or evicted from
+    long count = 0;                 // Number of active regions
+    long index;                     // Index counter for moving through the regions
+
+    active = malloc(regions->numRegions * sizeof(RegionStats));
+    if(active == NULL)
+    {
+        return -1;
+    }
+    for (index = 0; index < regions->numRegions; index++)
+    {
+        if(regions->stats[index].hits + regions->stats[index].misses + regions->stats[index].evicted > 0)
+        {
+            active[count++] = regions->stats[index];
+        }
+    }
+    qsort(active, count, sizeof(RegionStats), compareStats);
+
+    count = count < max ? count : max;
+    memcpy(stats, active, count * sizeof(RegionStats));
+    free(active);
+
+    return count;
+}
+
+// ****************************************************************************************************
+// Region Reset Stats Function
+// --- Zeroes the counters of every region
+// ****************************************************************************************************
+void regionResetStats(CacheRegions *regions)
+{
+    // Function Variables
+    long index;                     // Index counter for moving through the regions
+
+    for (index = 0; index < regions->numRegions; index++)
+    {
+        regions->stats[index] = (RegionStats){regions->stats[index].name, 0, 0, 0, 0};
+    }
+}
@@ -0,0 +1,301 @@
+// ****************************************************************************************************
+//
+//                                          cacheshared.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                                   Multiprogrammed Simulation:
+//
+//              tenant 0:  a0 a1 a2 a3 ...         rate 2
+//              tenant 1:  b0 b1 b2 ...            rate 1       ->  a0 a1 b0 a2 a3 b1 ...
+//
+//                  Several traces share one Cache. Each round every tenant issues rate accesses
+//                  from its own trace; tenants whose trace has ended drop out of the rotation.
+//                  Tenants have separate address spaces, so equal addresses of two traces are
+//                  different blocks, and every tenant keeps its own counters.
+//
+//                                       Way Partitioning:
+//
+//                  none    -   every tenant may fill any way
+//                  static  -   tenant i fills only its own tenants[i].ways ways, assigned in order
+//                  ucp     -   utility-based: a UMON per tenant keeps LRU shadow tags of every
+//                              UMON_SAMPLE-th set as if the tenant had the whole cache, counting
+//                              hits per LRU stack position. Every epoch the lookahead algorithm
+//                              hands out the ways one chunk at a time to the tenant gaining the
+//                              most hits per way, then the counters are halved.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // header file for libcachesim.c
+#include <stdlib.h>                 // stdlib.h used for malloc()
+#include <string.h>                 // string.h used for memset()
+
+// Every UMON_SAMPLE-th set is shadowed by the utility monitors
+#define UMON_SAMPLE 32
+
+// Partitioning policies
+typedef enum{
+    PARTITION_NONE,
+    PARTITION_STATIC,
+    PARTITION_UCP
+} Partition;
+
+// Umon Struct
+typedef struct{
+    unsigned long long *tags;       // numSampled * ways shadow block addresses, most recently used first
+    int *depth;                     // Number of valid shadow tags of each sampled set
+    long *hits;                     // Shadow hits at each LRU stack position
+} Umon;
+
+// ****************************************************************************************************
+// Umon Access Function
+// --- Records an access of block in a sampled set of the tenant's shadow tags, counting a hit at its
+// --- LRU stack position and moving it to the most recently used position
+// ****************************************************************************************************
+static void umonAccess(Umon *umon, long sampled, int ways, unsigned long long block)
+{
+    // Function Variables
+    unsigned long long *stack = &umon->tags[sampled * ways];
+    int position;                   // Stack position of block, or depth if it was not found
+
+    for (position = 0; position < umon->depth[sampled] && stack[position] != block; position++)
+    {
+    }
+
+    if(position < umon->depth[sampled])
+    {
+        umon->hits[position]++;
+    }
+    else if(umon->depth[sampled] < ways)
+    {
+        umon->depth[sampled]++;
+    }
+    else
+    {
+        // Drop the least recently used shadow tag
+        position = ways - 1;
+    }
+
+    memmove(&stack[1], &stack[0], position * sizeof(unsigned long long));
+    stack[0] = block;
+}
+
+// ****************************************************************************************************
+// Utility Function
+// --- Returns the shadow hits the tenant would have had with the given number of ways
+// ****************************************************************************************************
+static long utility(const Umon *umon, int ways)
+{
+    // Function Variables
+    long hits = 0;                  // Hits of the first ways stack positions
+    int position;                   // Index counter for moving through stack positions
+
+    for (position = 0; position < ways; position++)
+    {
+        hits += umon->hits[position];
+    }
+
+    return hits;
+}
+
+// ****************************************************************************************************
+// Lookahead Function
+// --- Divides ways among the tenants with the UCP lookahead algorithm: starting from one way each,
+// --- repeatedly gives the tenant with the highest marginal utility per way the number of ways at
+// --- which that utility is reached, until no ways are left
+// ****************************************************************************************************
+static void lookahead(const Umon *umons, int numTenants, int ways, int *allocation)
+{
+    // Function Variables
+    int balance = ways - numTenants;// Ways not yet handed out
+    double gain;                    // Extra hits per way of giving extra ways to a tenant
+    double bestGain;                // Highest gain of this round
+    int bestTenant;                 // Tenant with the highest gain
+    int bestExtra;                  // Ways giving bestTenant its highest gain
+    int tenant, extra;
+
+    for (tenant = 0; tenant < numTenants; tenant++)
+    {
+        allocation[tenant] = 1;
+    }
+
+    while(balance > 0)
+    {
+        bestGain = -1;
+        bestTenant = 0;
+        bestExtra = 1;
+        for (tenant = 0; tenant < numTenants; tenant++)
+        {
+            for (extra = 1; extra <= balance; extra++)
+            {
+                gain = (double)(utility(&umons[tenant], allocation[tenant] + extra) - utility(&umons[tenant], allocation[tenant])) / extra;
+                if(gain > bestGain)
+                {
+                    bestGain = gain;
+                    bestTenant = tenant;
+                    bestExtra = extra;
+                }
+            }
+        }
+
+        allocation[bestTenant] += bestExtra;
+        balance -= bestExtra;
+    }
+}
+
+// ****************************************************************************************************
+// Apply Partition Function
+// --- Assigns each tenant a contiguous range of allocation[tenant] ways in tenant order
+// ****************************************************************************************************
+static void applyPartition(Cache *cache, int numTenants, const int *allocation)
+{
+    // Function Variables
+    int firstWay = 0;               // First way of the current tenant's range
+    int tenant;                     // Index counter for moving through tenants
+
+    for (tenant = 0; tenant < numTenants; tenant++)
+    {
+        cacheSetPartition(cache, tenant, firstWay, allocation[tenant]);
+        firstWay += allocation[tenant];
+    }
+}
+
+// ****************************************************************************************************
+// Cache Simulate Shared Function
+// --- Interleaves the traces of numTenants tenants into one cache of the given config, each tenant
+// --- issuing its rate accesses per round, with the ways divided by the partition policy "none",
+// --- "static", or "ucp" (repartitioned every epoch accesses). Stores each tenant's counters in
+// --- tenantStats and its final number of ways in tenantWays. Returns false if the config, the
+// --- partition, or the static ways are invalid or memory runs out.
+// ****************************************************************************************************
+bool cacheSimulateShared(const CacheConfig *config, const SharedTenant *tenants, int numTenants,
+    const char *partition, long epoch, CacheStats *tenantStats, int *tenantWays)
+{
+    // Function Variables
+    Cache *cache;                   // Cache shared by every tenant
+    Partition policy;               // Partitioning policy parsed from partition
+    Umon *umons = NULL;             // Utility monitor of each tenant
+    long *positions = NULL;         // Index of the next access of each tenant's trace
+    int *allocation = NULL;         // Ways of each tenant
+    int ways;                       // (E) Associativity of the shared cache
+    long numSets;                   // (S) Number of sets of the shared cache
+    long numSampled;                // Number of sets shadowed by each UMON
+    long set;                       // Set of the current access
+    long accesses = 0;              // Accesses simulated since the start
+    bool active = true;             // Flag indicating a trace still had accesses this round
+    bool valid = true;              // Flag indicating every allocation succeeded
+    int tenant, issued, decayed, total = 0;
+
+    if(partition == NULL || strcmp(partition, "none") == 0)
+        policy = PARTITION_NONE;
+    else if(strcmp(partition, "static") == 0)
+        policy = PARTITION_STATIC;
+    else if(strcmp(partition, "ucp") == 0)
+        policy = PARTITION_UCP;
+    else
+        return false;
+
+    ways = config->ways > 0 ? config->ways : 1 << config->linesPerSet;
+    numSets = config->sets > 0 ? config->sets : 1L << config->setBits;
+    if(numTenants <= 0 || numTenants > CACHE_MAX_TENANTS || (policy != PARTITION_NONE && numTenants > ways))
+    {
+        return false;
+    }
+
+    cache = cacheCreate(config);
+    positions = calloc(numTenants, sizeof(long));
+    allocation = calloc(numTenants, sizeof(int));
+    if(cache == NULL || positions == NULL || allocation == NULL)
+    {
+        valid = false;
+    }
+
+    // Static ways must give every tenant at least one way and fit in the set
+    for (tenant = 0; valid && tenant < numTenants; tenant++)
+    {
+        allocation[tenant] = policy == PARTITION_STATIC ? tenants[tenant].ways : ways;
+        total += tenants[tenant].ways;
+        valid = tenants[tenant].rate > 0 && (policy != PARTITION_STATIC || tenants[tenant].ways > 0);
+    }
+    if(valid && policy == PARTITION_STATIC)
+    {
+        valid = total <= ways;
+        if(valid)
+        {
+            applyPartition(cache, numTenants, allocation);
+        }
+    }
+
+    // UCP starts from an even split and shadows every UMON_SAMPLE-th set per tenant
+    numSampled = (numSets + UMON_SAMPLE - 1) / UMON_SAMPLE;
+    if(valid && policy == PARTITION_UCP)
+    {
+        umons = calloc(numTenants, sizeof(Umon));
+        valid = umons != NULL;
+        for (tenant = 0; valid && tenant < numTenants; tenant++)
+        {
+            umons[tenant].tags = malloc(numSampled * ways * sizeof(unsigned long long));
+            umons[tenant].depth = calloc(numSampled, sizeof(int));
+            umons[tenant].hits = calloc(ways, sizeof(long));
+            valid = umons[tenant].tags != NULL && umons[tenant].depth != NULL && umons[tenant].hits != NULL;
+            allocation[tenant] = ways / numTenants + (tenant < ways % numTenants ? 1 : 0);
+        }
+        if(valid)
+        {
+            applyPartition(cache, numTenants, allocation);
+        }
+    }
+
+    // Round-robin over the tenants until every trace has ended
+    while(valid && active)
+    {
+        active = false;
+        for (tenant = 0; tenant < numTenants; tenant++)
+        {
+            for (issued = 0; issued < tenants[tenant].rate && positions[tenant] < tenants[tenant].count; issued++)
+            {
+                if(policy == PARTITION_UCP && (set = cacheSetOf(cache, tenants[tenant].addresses[positions[tenant]])) % UMON_SAMPLE == 0)
+                {
+                    umonAccess(&umons[tenant], set / UMON_SAMPLE, ways, tenants[tenant].addresses[positions[tenant]] >> config->blockOffsetBits);
+                }
+
+                cacheAccessTenant(cache, tenant, tenants[tenant].addresses[positions[tenant]]);
+                positions[tenant]++;
+                accesses++;
+                active = true;
+
+                // Repartition at the end of every epoch, decaying the old utility
+                if(policy == PARTITION_UCP && epoch > 0 && accesses % epoch == 0)
+                {
+                    lookahead(umons, numTenants, ways, allocation);
+                    applyPartition(cache, numTenants, allocation);
+                    for (decayed = 0; decayed < numTenants * ways; decayed++)
+                    {
+                        umons[decayed / ways].hits[decayed % ways] /= 2;
+                    }
+                }
+            }
+        }
+    }
+
+    for (tenant = 0; valid && tenant < numTenants; tenant++)
+    {
+        cacheGetTenantStats(cache, tenant, &tenantStats[tenant]);
+        tenantWays[tenant] = allocation[tenant];
+    }
+
+    for (tenant = 0; umons != NULL && tenant < numTenants; tenant++)
+    {
+        free(umons[tenant].tags);
+        free(umons[tenant].depth);
+        free(umons[tenant].hits);
+    }
+    free(umons);
+    free(positions);
+    free(allocation);
+    cacheDestroy(cache);
+
+    return valid;
+}
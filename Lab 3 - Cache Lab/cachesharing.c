@@ -0,0 +1,451 @@
+// ****************************************************************************************************
+//
+//                                          cachesharing.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                                      Coherence Misses:
+//
+//              t0 writes bytes 0-7:    t0 [M]   t1 [I]        -> 1 invalidation of t1's copy
+//              t1 reads bytes 8-15:    t0 [S]   t1 [S]        -> coherence miss, false sharing:
+//                                                                nothing t1 touches was written
+//              t1 reads bytes 0-7:     (after another t0 write) -> true sharing: t1 needs t0's data
+//
+//                  Every thread has a private cache large enough to never evict, so the only misses
+//                  after a thread first touches a block are coherence misses. A write leaves the
+//                  writer with the only valid copy, invalidating every other thread holding one.
+//                  Until a thread that lost its copy accesses the block again, the granules other
+//                  threads write are collected; the miss that access takes is true sharing if it
+//                  touches one of them and false sharing otherwise, in which case padding or
+//                  moving the data apart would remove it.
+//
+//                  Blocks are kept in an open addressing table; each holds a list of the threads
+//                  that accessed it, sorted by thread ID, with the granules each read and wrote.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // header file for libcachesim.c
+#include <stdlib.h>                 // stdlib.h used for malloc()
+#include <string.h>                 // string.h used for memset()
+
+// Entry Struct: one block of the table
+typedef struct{
+    unsigned long long block;       // Block address
+    unsigned long long sharers;     // Threads holding a valid copy, bit per dense thread index
+    unsigned long long lost;        // Threads whose copy a write of another thread invalidated
+    long long invalidations;
+    long long trueMisses;
+    long long falseMisses;
+    long first;                     // First record of the block's thread list, -1 for an empty slot
+    int threads;                    // Records in the list
+} Entry;
+
+// Record Struct: one thread's use of one block
+typedef struct{
+    int thread;                     // Dense thread index
+    long next;                      // Next record of the block, -1 at the end
+    unsigned long long read;        // Granules the thread read
+    unsigned long long written;     // Granules the thread wrote
+    unsigned long long pending;     // Granules others wrote since the thread lost its copy
+} Record;
+
+// CacheSharing Struct
+struct CacheSharing{
+    int blockOffsetBits;            // (b) Bits of an address within its block
+    int granuleBits;                // Bits of an address within its granule
+    int threadIds[SHARING_MAX_THREADS]; // Thread ID of every dense index
+    Entry *table;                   // Blocks, at their hash slot or the next free one
+    long capacity;                  // Slots of table, a power of two
+    Record *records;                // Thread lists of every block
+    long recordCount;               // Records in use
+    long recordCapacity;            // Records allocated
+    SharingStats stats;
+};
+
+// ****************************************************************************************************
+// Sharing Create Function
+// --- Allocates an analysis of blocks of 2^blockOffsetBits bytes. Returns NULL if memory runs out.
+// ****************************************************************************************************
+CacheSharing *sharingCreate(int blockOffsetBits)
+{
+    // Function Variables
+    CacheSharing *sharing;          // Analysis being created
+    long slot;                      // Index counter for moving through the table
+
+    if(blockOffsetBits < 0 || blockOffsetBits > 30)
+    {
+        return NULL;
+    }
+
+    sharing = calloc(1, sizeof(CacheSharing));
+    if(sharing == NULL)
+    {
+        return NULL;
+    }
+    sharing->blockOffsetBits = blockOffsetBits;
+    sharing->granuleBits = blockOffsetBits > 6 ? blockOffsetBits - 6 : 0;
+    sharing->stats.granule = 1 << sharing->granuleBits;
+    sharing->capacity = 1024;
+    sharing->table = malloc(sharing->capacity * sizeof(Entry));
+    if(sharing->table == NULL)
+    {
+        free(sharing);
+        return NULL;
+    }
+    for (slot = 0; slot < sharing->capacity; slot++)
+    {
+        sharing->table[slot].first = -1;
+    }
+
+    return sharing;
+}
+
+// ****************************************************************************************************
+// Sharing Destroy Function
+// --- Frees an analysis; NULL is ignored
+// ****************************************************************************************************
+void sharingDestroy(CacheSharing *sharing)
+{
+    if(sharing == NULL)
+    {
+        return;
+    }
+
+    free(sharing->table);
+    free(sharing->records);
+    free(sharing);
+}
+
+// ****************************************************************************************************
+// Find Entry Function
+// --- Returns the slot of block in the table, or the free slot it would take
+// ****************************************************************************************************
+static long findEntry(const Entry *table, long capacity, unsigned long long block)
+{
+    // Function Variables
+    long slot = (block * CACHE_HASH_MULTIPLIER) >> 32 & (capacity - 1);
+
+    while(table[slot].first >= 0 && table[slot].block != block)
+    {
+        slot = (slot + 1) & (capacity - 1);
+    }
+
+    return slot;
+}
+
+// ****************************************************************************************************
+// Grow Function
+// --- Doubles the table once it is half full. Returns false if memory runs out.
+// ****************************************************************************************************
+static bool grow(CacheSharing *sharing)
+{
+    // Function Variables
+    Entry *old = sharing->table;    // Table before growing
+    long oldCapacity = sharing->capacity;
+    long slot;                      // Index counter for moving through the tables
+
+    if(2 * (sharing->stats.blocks + 1) <= sharing->capacity)
+    {
+        return true;
+    }
+
+    sharing->table = malloc(2 * oldCapacity * sizeof(Entry));
+    if(sharing->table == NULL)
+    {
+        sharing->table = old;
+        return false;
+    }
+    sharing->capacity = 2 * oldCapacity;
+    for (slot = 0; slot < sharing->capacity; slot++)
+    {
+        sharing->table[slot].first = -1;
+    }
+
+    // Rehash every used slot into the new table
+    for (slot = 0; slot < oldCapacity; slot++)
+    {
+        if(old[slot].first >= 0)
+        {
+            sharing->table[findEntry(sharing->table, sharing->capacity, old[slot].block)] = old[slot];
+        }
+    }
+    free(old);
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Thread Index Function
+// --- Returns the dense index of thread, assigning the next one to a new thread, or -1 once
+// --- SHARING_MAX_THREADS threads are known
+// ****************************************************************************************************
+static int threadIndex(CacheSharing *sharing, int thread)
+{
+    // Function Variables
+    int index;                      // Index counter for moving through the known threads
+
+    for (index = 0; index < sharing->stats.threads; index++)
+    {
+        if(sharing->threadIds[index] == thread)
+        {
+            return index;
+        }
+    }
+    if(sharing->stats.threads == SHARING_MAX_THREADS)
+    {
+        return -1;
+    }
+
+    sharing->threadIds[sharing->stats.threads] = thread;
+    return sharing->stats.threads++;
+}
+
+// ****************************************************************************************************
+// Access Block Function
+// --- Applies an access of the granules in mask of one block by the thread of dense index thread.
+// --- Returns false if memory runs out.
+// ****************************************************************************************************
+static bool accessBlock(CacheSharing *sharing, unsigned long long block, unsigned long long mask, int thread, bool write)
+{
+    // Function Variables
+    unsigned long long bit = 1ULL << thread;    // Thread's bit of the sharer masks
+    unsigned long long others;      // Other threads holding a copy, invalidated by a write
+    Entry *entry;                   // Block's entry
+    Record *record = NULL;          // Thread's record of the block
+    Record *grown;                  // Records after growing
+    long *link;                     // Link to the place of the thread's record in the sorted list
+    long index;                     // Index counter for moving through the block's records
+
+    if(grow(sharing) == false)
+    {
+        return false;
+    }
+    entry = &sharing->table[findEntry(sharing->table, sharing->capacity, block)];
+    if(entry->first < 0)
+    {
+        memset(entry, 0, sizeof(Entry));
+        entry->block = block;
+        entry->first = -1;
+        sharing->stats.blocks++;
+    }
+
+    // Find the thread's record, adding it in thread ID order
+    for (link = &entry->first; *link >= 0 && sharing->threadIds[sharing->records[*link].thread] < sharing->threadIds[thread]; link = &sharing->records[*link].next)
+    {
+    }
+    if(*link >= 0 && sharing->records[*link].thread == thread)
+    {
+        record = &sharing->records[*link];
+    }
+    else
+    {
+        if(sharing->recordCount == sharing->recordCapacity)
+        {
+            // link may point into the records, so remember it by index across the move
+            index = link == &entry->first ? -1 : (long)(((char *)link - (char *)sharing->records) / sizeof(Record));
+            grown = realloc(sharing->records, (sharing->recordCapacity > 0 ? 2 * sharing->recordCapacity : 1024) * sizeof(Record));
+            if(grown == NULL)
+            {
+                return false;
+            }
+            sharing->records = grown;
+            sharing->recordCapacity = sharing->recordCapacity > 0 ? 2 * sharing->recordCapacity : 1024;
+            link = index < 0 ? &entry->first : &sharing->records[index].next;
+        }
+        record = &sharing->records[sharing->recordCount];
+        memset(record, 0, sizeof(Record));
+        record->thread = thread;
+        record->next = *link;
+        *link = sharing->recordCount++;
+        if(++entry->threads == 2)
+        {
+            sharing->stats.sharedBlocks++;
+        }
+    }
+
+    // Without a valid copy, the access misses; once invalidated, it is a coherence miss
+    if((entry->sharers & bit) == 0)
+    {
+        if(entry->lost & bit)
+        {
+            if(record->pending & mask)
+            {
+                entry->trueMisses++;
+                sharing->stats.trueMisses++;
+            }
+            else
+            {
+                entry->falseMisses++;
+                sharing->stats.falseMisses++;
+            }
+            entry->lost &= ~bit;
+            record->pending = 0;
+        }
+        entry->sharers |= bit;
+    }
+
+    if(write == false)
+    {
+        record->read |= mask;
+        return true;
+    }
+
+    // A write leaves the writer the only copy
+    record->written |= mask;
+    others = entry->sharers & ~bit;
+    entry->invalidations += __builtin_popcountll(others);
+    sharing->stats.invalidations += __builtin_popcountll(others);
+    entry->lost |= others;
+    entry->sharers = bit;
+    for (index = entry->first; index >= 0; index = sharing->records[index].next)
+    {
+        if(entry->lost & (1ULL << sharing->records[index].thread))
+        {
+            sharing->records[index].pending |= mask;
+        }
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Sharing Access Function
+// --- Adds an access of bytes bytes (at least one) at address by thread, a read or a write, split over
+// --- every block it spans. Returns false if more than SHARING_MAX_THREADS threads appear or memory runs out.
+// ****************************************************************************************************
+bool sharingAccess(CacheSharing *sharing, unsigned long long address, int bytes, int thread, bool write)
+{
+    // Function Variables
+    unsigned long long blockBytes = 1ULL << sharing->blockOffsetBits;
+    unsigned long long offset = address & (blockBytes - 1); // Byte of the access within its block
+    unsigned long long chunk;       // Bytes of the access within the current block
+    unsigned long long mask;        // Granules of the current block accessed
+    int first, last;                // First and last granule accessed
+    int index = threadIndex(sharing, thread);
+
+    if(index < 0)
+    {
+        return false;
+    }
+    sharing->stats.accesses++;
+    if(bytes < 1)
+    {
+        bytes = 1;
+    }
+
+    do
+    {
+        chunk = (unsigned long long)bytes < blockBytes - offset ? (unsigned long long)bytes : blockBytes - offset;
+        first = offset >> sharing->granuleBits;
+        last = (offset + chunk - 1) >> sharing->granuleBits;
+        mask = last - first == 63 ? ~0ULL : ((1ULL << (last - first + 1)) - 1) << first;
+        if(accessBlock(sharing, address >> sharing->blockOffsetBits, mask, index, write) == false)
+        {
+            return false;
+        }
+        address += chunk;
+        bytes -= chunk;
+        offset = 0;
+    } while(bytes > 0);
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Compare Entries Function
+// --- qsort comparison putting the blocks with the most invalidations first, then the lowest block
+// ****************************************************************************************************
+static int compareEntries(const void *first, const void *second)
+{
+    // Function Variables
+    const Entry *a = *(const Entry *const *)first;
+    const Entry *b = *(const Entry *const *)second;
+
+    if(a->invalidations != b->invalidations)
+    {
+        return a->invalidations < b->invalidations ? 1 : -1;
+    }
+
+    return a->block < b->block ? -1 : a->block > b->block;
+}
+
+// ****************************************************************************************************
+// Sharing Top Function
+// --- Fills blocks with up to max blocks, those with the most invalidations first, whose coherence
+// --- misses are mostly false sharing (falseSharing) or mostly true sharing. Returns the number of
+// --- blocks filled, or -1 if memory runs out.
+// ****************************************************************************************************
+long sharingTop(const CacheSharing *sharing, bool falseSharing, SharingBlock *blocks, long max)
+{
+    // Function Variables
+    const Entry **chosen;           // Blocks of the kind asked for
+    const Entry *entry;
+    const Record *record, *other;
+    long count = 0;                 // Number of blocks chosen
+    long slot;                      // Index counter for moving through the table
+    long index;                     // Index counter for moving through the blocks filled
+    int shown;                      // Threads of the block filled in so far
+
+    chosen = malloc((sharing->stats.blocks > 0 ? sharing->stats.blocks : 1) * sizeof(Entry *));
+    if(chosen == NULL)
+    {
+        return -1;
+    }
+    for (slot = 0; slot < sharing->capacity; slot++)
+    {
+        entry = &sharing->table[slot];
+        if(entry->first >= 0 && (falseSharing ? entry->falseMisses > 0 && entry->falseMisses >= entry->trueMisses
+            : entry->trueMisses > entry->falseMisses))
+        {
+            chosen[count++] = entry;
+        }
+    }
+    qsort(chosen, count, sizeof(Entry *), compareEntries);
+
+    for (index = 0; index < count && index < max; index++)
+    {
+        entry = chosen[index];
+        memset(&blocks[index], 0, sizeof(SharingBlock));
+        blocks[index].block = entry->block;
+        blocks[index].invalidations = entry->invalidations;
+        blocks[index].trueMisses = entry->trueMisses;
+        blocks[index].falseMisses = entry->falseMisses;
+        blocks[index].threads = entry->threads;
+        blocks[index].disjoint = true;
+
+        shown = 0;
+        for (record = &sharing->records[entry->first]; record != NULL; record = record->next >= 0 ? &sharing->records[record->next] : NULL)
+        {
+            if(shown < SHARING_THREADS_SHOWN)
+            {
+                blocks[index].shown[shown].thread = sharing->threadIds[record->thread];
+                blocks[index].shown[shown].readGranules = record->read;
+                blocks[index].shown[shown].writtenGranules = record->written;
+                shown++;
+            }
+
+            // Disjoint unless some other thread accessed a granule this one wrote
+            for (other = &sharing->records[entry->first]; other != NULL; other = other->next >= 0 ? &sharing->records[other->next] : NULL)
+            {
+                if(other != record && (record->written & (other->read | other->written)) != 0)
+                {
+                    blocks[index].disjoint = false;
+                }
+            }
+        }
+    }
+    free(chosen);
+
+    return index;
+}
+
+// ****************************************************************************************************
+// Sharing Get Stats Function
+// --- Copies the totals over every block into stats
+// ****************************************************************************************************
+void sharingGetStats(const CacheSharing *sharing, SharingStats *stats)
+{
+    *stats = sharing->stats;
+}
@@ -0,0 +1,269 @@
+// ****************************************************************************************************
+//
+//                                           cachesimc.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                  Example client of cachesimd. Connects to the daemon's socket, creates the cache
+//                  called -n from the -c config, sends the addresses of a text trace in batches of
+//                  ACCESS_BATCH, reads the counters back, and destroys the cache. Every reply is
+//                  printed with its status (see cachesimd.h), so a request the daemon refuses shows
+//                  up as a non-zero status rather than ending the client.
+//
+//                  ex.) ./cachesimc -s /tmp/cachesim.sock -n l2 -c s=2,e=2,b=4,r=lru address04
+//
+// ****************************************************************************************************
+
+#include "cachesimd.h"              // cachesimd.h used for the wire protocol
+#include <stdio.h>                  // stdio.h used for input/output functions
+#include <stdlib.h>                 // stdlib.h used for atoi()
+#include <string.h>                 // string.h used for strncpy()
+#include <unistd.h>                 // unistd.h used for getopt() and close()
+#include <sys/socket.h>             // sys/socket.h used for socket()
+#include <sys/un.h>                 // sys/un.h used for sockaddr_un
+
+// // // Cachesimc Constants
+#define ACCESS_BATCH 4096           // Addresses sent per DAEMON_ACCESS
+
+// // // Cachesimc Variables
+// Args
+char *socketName;                   // (s) Path of the daemon's Unix domain socket
+char *cacheName;                    // (n) Name of the cache created on the daemon
+char *cacheSpec;                    // (c) Cache as key=value pairs of m,s,e,b,r,S,E,h
+
+int socketFd;                       // Connection to the daemon
+
+// ****************************************************************************************************
+// Parse Config Function
+// --- Fills config from spec, key=value pairs of m,s,e,b,r,S,E,h separated by commas, or NULL. Keys
+// --- not given keep the defaults of a 64 bit, 64 set, 8 way, 64 byte block lru cache. Returns false
+// --- if a pair is malformed or a string is too long.
+// ****************************************************************************************************
+bool parseConfig(char *spec, DaemonConfig *config)
+{
+    // Function Variables
+    char *pair;                     // Current key=value pair
+    char *value;                    // Value of the pair
+
+    memset(config, 0, sizeof(DaemonConfig));
+    config->addressSize = 64;
+    config->setBits = 6;
+    config->linesPerSet = 3;
+    config->blockOffsetBits = 6;
+    strcpy(config->algorithm, "lru");
+
+    for (pair = spec != NULL ? strtok(spec, ",") : NULL; pair != NULL; pair = strtok(NULL, ","))
+    {
+        value = strchr(pair, '=');
+        if(value == NULL || value - pair != 1)
+        {
+            return false;
+        }
+        value++;
+        switch (pair[0])
+        {
+            case 'm': config->addressSize = atoi(value); break;
+            case 's': config->setBits = atoi(value); break;
+            case 'e': config->linesPerSet = atoi(value); break;
+            case 'b': config->blockOffsetBits = atoi(value); break;
+            case 'S': config->sets = atoi(value); break;
+            case 'E': config->ways = atoi(value); break;
+            case 'r':
+                if(strlen(value) >= sizeof(config->algorithm))
+                {
+                    return false;
+                }
+                strcpy(config->algorithm, value);
+                break;
+            case 'h':
+                if(strlen(value) >= sizeof(config->indexHash))
+                {
+                    return false;
+                }
+                strcpy(config->indexHash, value);
+                break;
+            default: return false;
+        }
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Send All Function
+// --- Writes length bytes of buffer to the daemon. Returns false if the connection failed.
+// ****************************************************************************************************
+bool sendAll(const void *buffer, size_t length)
+{
+    // Function Variables
+    const char *bytes = buffer;     // Bytes not yet sent, from sent on
+    size_t sent = 0;                // Bytes taken by the socket
+    ssize_t count;                  // Bytes taken by the current send
+
+    while(sent < length)
+    {
+        count = send(socketFd, &bytes[sent], length - sent, MSG_NOSIGNAL);
+        if(count <= 0)
+        {
+            return false;
+        }
+        sent += count;
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Receive All Function
+// --- Reads length bytes from the daemon into buffer. Returns false if the connection closed first.
+// ****************************************************************************************************
+bool receiveAll(void *buffer, size_t length)
+{
+    // Function Variables
+    char *bytes = buffer;           // Buffer filled up to received
+    size_t received = 0;            // Bytes read so far
+    ssize_t count;                  // Bytes read by the current recv
+
+    while(received < length)
+    {
+        count = recv(socketFd, &bytes[received], length - received, 0);
+        if(count <= 0)
+        {
+            return false;
+        }
+        received += count;
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Request Function
+// --- Sends a request of type on the cache called cacheName with count addresses or the payload of
+// --- length bytes, and reads its reply and, for DAEMON_ACCESS, the hit bitmap into bitmap. Returns
+// --- false if the connection failed.
+// ****************************************************************************************************
+bool request(unsigned int type, unsigned long long count, const void *payload, size_t length, DaemonReply *reply, unsigned char *bitmap)
+{
+    // Function Variables
+    DaemonRequest header;           // Header of the request
+
+    memset(&header, 0, sizeof(header));
+    header.type = type;
+    header.count = count;
+    memcpy(header.name, cacheName, strlen(cacheName) < DAEMON_NAME_MAX ? strlen(cacheName) : DAEMON_NAME_MAX);
+
+    return sendAll(&header, sizeof(header)) && sendAll(payload, length) && receiveAll(reply, sizeof(DaemonReply))
+        && (type != DAEMON_ACCESS || receiveAll(bitmap, (count + 7) / 8));
+}
+
+// ****************************************************************************************************
+// Main Function
+// --- Given arguments in the form :s:n:c: followed by a text trace, creates the cache on the daemon,
+// --- streams the trace through it, and prints the counters and status of every reply
+// ****************************************************************************************************
+int main(int argc, char **argv)
+{
+    // Function Variables
+    int opt;                        // Option for switch case to gather argument list
+    struct sockaddr_un address;     // Address of the daemon's socket
+    DaemonConfig config;            // Config of the created cache
+    DaemonReply reply;              // Reply of the last request
+    FILE *pTrace;                   // Text trace sent to the daemon
+    unsigned long long addresses[ACCESS_BATCH]; // Batch of addresses read from the trace
+    unsigned char bitmap[ACCESS_BATCH / 8];     // Hit bitmap of the batch
+    unsigned long long sent = 0;    // Addresses sent
+    long long hits = 0;             // Hits counted from the bitmaps
+    int status = DAEMON_OK;         // First non-zero status of the access replies
+    int count;                      // Addresses in the current batch
+    int index;                      // Index counter for moving through the batch
+    bool connected;                 // Flag indicating every request got its reply
+
+    while ((opt = getopt(argc, argv, ":s:n:c:")) != -1)
+    {
+        switch (opt)
+        {
+            case 's': socketName = optarg; break;
+            case 'n': cacheName = optarg; break;
+            case 'c': cacheSpec = optarg; break;
+            default:
+                printf("Error: Please check format of arguments ... \n");
+                exit(1);
+        }
+    }
+
+    if(socketName == NULL || cacheName == NULL || optind != argc - 1)
+    {
+        fprintf(stderr, "Usage: %s -s socket -n name [-c key=value,...] trace\n", argv[0]);
+        exit(1);
+    }
+    if(parseConfig(cacheSpec, &config) == false)
+    {
+        printf("[ERROR] Invalid -c cache - use key=value pairs of m,s,e,b,r,S,E,h ... [EXITING PROGRAM]\n");
+        exit(1);
+    }
+    if((pTrace = fopen(argv[optind], "r")) == NULL)
+    {
+        printf("[ERROR] File %s = NULL ... [EXITING PROGRAM]\n", argv[optind]);
+        exit(1);
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketName, sizeof(address.sun_path) - 1);
+    socketFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(socketFd < 0 || connect(socketFd, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        printf("[ERROR] Could not connect to %s ... [EXITING PROGRAM]\n", socketName);
+        exit(1);
+    }
+
+    connected = request(DAEMON_CREATE, 0, &config, sizeof(config), &reply, NULL);
+    if(connected)
+    {
+        printf("[create] name: %s algorithm: %s status: %d\n", cacheName, config.algorithm, reply.status);
+    }
+
+    // Stream the trace a batch at a time, counting the hits of every bitmap
+    do
+    {
+        for (count = 0; count < ACCESS_BATCH && fscanf(pTrace, "%llx", &addresses[count]) == 1; count++)
+        {
+        }
+        if(count > 0 && connected)
+        {
+            connected = request(DAEMON_ACCESS, count, addresses, count * sizeof(unsigned long long), &reply, bitmap);
+            for (index = 0; connected && index < count; index++)
+            {
+                hits += (bitmap[index / 8] >> (index % 8)) & 1;
+            }
+            status = status == DAEMON_OK ? reply.status : status;
+            sent += count;
+        }
+    } while(count == ACCESS_BATCH);
+    if(connected)
+    {
+        printf("[access] addresses: %llu hits: %lld status: %d\n", sent, hits, status);
+    }
+
+    if(connected && (connected = request(DAEMON_STATS, 0, NULL, 0, &reply, NULL)))
+    {
+        printf("[stats] hits: %lld misses: %lld evictions: %lld status: %d\n", reply.stats.hits, reply.stats.misses, reply.stats.evictions, reply.status);
+    }
+    if(connected && (connected = request(DAEMON_DESTROY, 0, NULL, 0, &reply, NULL)))
+    {
+        printf("[destroy] name: %s status: %d\n", cacheName, reply.status);
+    }
+
+    if(connected == false)
+    {
+        printf("[ERROR] Connection to %s lost ... [EXITING PROGRAM]\n", socketName);
+    }
+
+    close(socketFd);
+    fclose(pTrace);
+
+    return connected ? 0 : 1;
+}
@@ -0,0 +1,540 @@
+// ****************************************************************************************************
+//
+//                                           cachesimd.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                  Cache simulation daemon. Named caches stay in memory between requests, so live
+//                  instrumentation such as a sampling profiler can stream its accesses without
+//                  starting a simulator per trace. Clients connect to a Unix domain socket and send
+//                  the requests of cachesimd.h; a DAEMON_ACCESS carries a whole batch of addresses
+//                  and is answered with a hit bitmap and the running counters, so the cost of a
+//                  message is spread over thousands of accesses.
+//
+//                  One thread serves every client with epoll. Sockets are non-blocking: bytes are
+//                  read into a per-client input buffer until a whole request is there, and replies
+//                  are queued in an output buffer written as the socket accepts them. A request with
+//                  an unknown type or an oversized batch is answered, then the client is dropped
+//                  since the rest of its stream can no longer be framed.
+//
+//                  A plugin policy runs code inside the daemon, so DAEMON_CREATE only loads the
+//                  shared objects given by -p, spelled exactly as on the command line; any other
+//                  "plugin:" algorithm is denied. The socket is only accessible to its owner.
+//
+//                  ex.) ./cachesimd -s /tmp/cachesim.sock -p ./policy_bip.so
+//
+// ****************************************************************************************************
+
+#include "cachesimd.h"              // cachesimd.h used for the wire protocol
+#include "libcachesim.h"            // libcachesim.h used for the cache simulator engine
+#include <stdio.h>                  // stdio.h used for input/output functions
+#include <stdlib.h>                 // stdlib.h used for malloc()
+#include <string.h>                 // string.h used for memcpy()
+#include <unistd.h>                 // unistd.h used for getopt() and close()
+#include <errno.h>                  // errno.h used for EAGAIN
+#include <signal.h>                 // signal.h used for sigaction()
+#include <fcntl.h>                  // fcntl.h used for O_NONBLOCK
+#include <sys/socket.h>             // sys/socket.h used for socket()
+#include <sys/un.h>                 // sys/un.h used for sockaddr_un
+#include <sys/stat.h>               // sys/stat.h used for chmod()
+#include <sys/epoll.h>              // sys/epoll.h used for epoll_wait()
+
+// // // Cachesimd Constants
+const int MAX_CACHES = 64;          // Named caches held at once
+const int MAX_EVENTS = 64;          // Events handled per epoll_wait
+const int READ_CHUNK = 1 << 16;     // Bytes read from a client at once
+const char *OPTIMAL = "optimal";    // Algorithm needing the next use of every access, which a live stream cannot give
+
+// Client Struct
+typedef struct{
+    int fd;                         // Connected socket
+    unsigned char *input;           // Bytes received and not yet handled
+    size_t inputLength;
+    size_t inputCapacity;
+    unsigned char *output;          // Replies not yet sent, from outputSent on
+    size_t outputLength;
+    size_t outputSent;
+    size_t outputCapacity;
+    bool writing;                   // Flag indicating the socket is watched for EPOLLOUT
+} Client;
+
+// NamedCache Struct
+typedef struct{
+    char name[DAEMON_NAME_MAX];     // Name given by DAEMON_CREATE, empty for a free slot
+    Cache *cache;
+} NamedCache;
+
+// // // Cachesimd Variables
+// Args
+char *socketName;                   // (s) Path of the Unix domain socket to listen on
+char **allowedPlugins;              // (p) Paths of the plugin policies clients may load
+int numAllowedPlugins;              // Number of allowed plugin paths
+
+NamedCache *caches;                 // MAX_CACHES slots of named caches
+int epollFd;                        // epoll instance watching the listening socket and every client
+volatile sig_atomic_t running = 1;  // Cleared by SIGINT or SIGTERM
+
+// ****************************************************************************************************
+// Stop Function
+// --- Signal handler ending the event loop
+// ****************************************************************************************************
+void stop(int signal)
+{
+    (void)signal;
+    running = 0;
+}
+
+// ****************************************************************************************************
+// Reserve Function
+// --- Grows *buffer to hold at least needed bytes. Returns false if memory runs out.
+// ****************************************************************************************************
+bool reserve(unsigned char **buffer, size_t *capacity, size_t needed)
+{
+    // Function Variables
+    unsigned char *grown;           // Buffer reallocated to the new capacity
+    size_t size = *capacity > 0 ? *capacity : (size_t)READ_CHUNK;
+
+    if(needed <= *capacity)
+    {
+        return true;
+    }
+    while(size < needed)
+    {
+        size *= 2;
+    }
+
+    grown = realloc(*buffer, size);
+    if(grown == NULL)
+    {
+        return false;
+    }
+    *buffer = grown;
+    *capacity = size;
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Find Cache Function
+// --- Returns the slot holding the cache called name, or NULL if there is none
+// ****************************************************************************************************
+NamedCache *findCache(const char *name)
+{
+    // Function Variables
+    int slot;                       // Index counter for moving through the slots
+
+    for (slot = 0; slot < MAX_CACHES; slot++)
+    {
+        if(caches[slot].cache != NULL && strncmp(caches[slot].name, name, DAEMON_NAME_MAX) == 0)
+        {
+            return &caches[slot];
+        }
+    }
+
+    return NULL;
+}
+
+// ****************************************************************************************************
+// Payload Size Function
+// --- Returns the payload bytes following request, or -1 if its type or batch is invalid
+// ****************************************************************************************************
+long long payloadSize(const DaemonRequest *request)
+{
+    switch (request->type)
+    {
+        case DAEMON_CREATE: return sizeof(DaemonConfig);
+        case DAEMON_ACCESS: return request->count <= DAEMON_BATCH_MAX ? (long long)(request->count * sizeof(unsigned long long)) : -1;
+        case DAEMON_STATS:
+        case DAEMON_RESET:
+        case DAEMON_DESTROY: return 0;
+        default: return -1;
+    }
+}
+
+// ****************************************************************************************************
+// Plugin Allowed Function
+// --- Returns true if algorithm loads no plugin or one of the plugins given by -p
+// ****************************************************************************************************
+bool pluginAllowed(const char *algorithm)
+{
+    // Function Variables
+    const char *prefix = "plugin:"; // Prefix of algorithms loading a plugin
+    int index;                      // Index counter for moving through the allowed plugins
+
+    if(strncmp(algorithm, prefix, strlen(prefix)) != 0)
+    {
+        return true;
+    }
+    for (index = 0; index < numAllowedPlugins; index++)
+    {
+        if(strcmp(&algorithm[strlen(prefix)], allowedPlugins[index]) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ****************************************************************************************************
+// Handle Request Function
+// --- Carries out a whole request with its payload and appends the reply to the client's output.
+// --- Returns false if memory for the reply runs out.
+// ****************************************************************************************************
+bool handleRequest(Client *client, const DaemonRequest *request, const unsigned char *payload)
+{
+    // Function Variables
+    DaemonReply reply;              // Reply header
+    DaemonConfig daemonConfig;      // Config of DAEMON_CREATE
+    CacheConfig config;             // Engine config built from daemonConfig
+    NamedCache *named;              // Cache the request names
+    const unsigned long long *addresses = (const unsigned long long *)payload;
+    unsigned char *bitmap;          // Hit bitmap of DAEMON_ACCESS in the output buffer
+    size_t bitmapSize = 0;          // Bytes of the bitmap
+    unsigned long long index;       // Index counter for moving through the batch
+    int slot;                       // Index counter for moving through the slots
+
+    memset(&reply, 0, sizeof(reply));
+    named = findCache(request->name);
+    if(request->type == DAEMON_ACCESS)
+    {
+        bitmapSize = (request->count + 7) / 8;
+    }
+    if(reserve(&client->output, &client->outputCapacity, client->outputLength + sizeof(reply) + bitmapSize) == false)
+    {
+        return false;
+    }
+    bitmap = &client->output[client->outputLength + sizeof(reply)];
+    memset(bitmap, 0, bitmapSize);
+
+    // A name filling the whole field could never be matched again once stored NUL terminated
+    if(memchr(request->name, '\0', DAEMON_NAME_MAX) == NULL)
+    {
+        reply.status = DAEMON_ERROR_INVALID;
+    }
+    else if(request->type == DAEMON_CREATE)
+    {
+        for (slot = 0; slot < MAX_CACHES && caches[slot].cache != NULL; slot++)
+        {
+        }
+
+        memcpy(&daemonConfig, payload, sizeof(daemonConfig));
+        daemonConfig.algorithm[sizeof(daemonConfig.algorithm) - 1] = '\0';
+        daemonConfig.indexHash[sizeof(daemonConfig.indexHash) - 1] = '\0';
+        memset(&config, 0, sizeof(config));
+        config.addressSize = daemonConfig.addressSize;
+        config.setBits = daemonConfig.setBits;
+        config.linesPerSet = daemonConfig.linesPerSet;
+        config.blockOffsetBits = daemonConfig.blockOffsetBits;
+        config.algorithm = daemonConfig.algorithm;
+        config.sets = daemonConfig.sets;
+        config.ways = daemonConfig.ways;
+        config.indexHash = daemonConfig.indexHash[0] != '\0' ? daemonConfig.indexHash : NULL;
+
+        if(named != NULL)
+        {
+            reply.status = DAEMON_ERROR_EXISTS;
+        }
+        else if(slot == MAX_CACHES)
+        {
+            reply.status = DAEMON_ERROR_FULL;
+        }
+        else if(pluginAllowed(config.algorithm) == false)
+        {
+            reply.status = DAEMON_ERROR_DENIED;
+        }
+        else if(request->name[0] == '\0' || strcmp(config.algorithm, OPTIMAL) == 0 || (caches[slot].cache = cacheCreate(&config)) == NULL)
+        {
+            reply.status = DAEMON_ERROR_INVALID;
+        }
+        else
+        {
+            memcpy(caches[slot].name, request->name, DAEMON_NAME_MAX);
+            named = &caches[slot];
+            printf("[create] %s algorithm: %s\n", named->name, config.algorithm);
+        }
+    }
+    else if(named == NULL)
+    {
+        reply.status = DAEMON_ERROR_UNKNOWN;
+    }
+    else if(request->type == DAEMON_ACCESS)
+    {
+        for (index = 0; index < request->count; index++)
+        {
+            if(cacheAccess(named->cache, addresses[index]) == CACHE_HIT)
+            {
+                bitmap[index / 8] |= 1 << (index % 8);
+            }
+        }
+        reply.count = request->count;
+    }
+    else if(request->type == DAEMON_RESET)
+    {
+        cacheResetStats(named->cache);
+    }
+
+    if(named != NULL && reply.status == DAEMON_OK)
+    {
+        cacheGetStats(named->cache, &reply.stats);
+    }
+
+    if(named != NULL && reply.status == DAEMON_OK && request->type == DAEMON_DESTROY)
+    {
+        printf("[destroy] %s hits: %lld misses: %lld evictions: %lld\n", named->name, reply.stats.hits, reply.stats.misses, reply.stats.evictions);
+        cacheDestroy(named->cache);
+        named->cache = NULL;
+        named->name[0] = '\0';
+    }
+
+    memcpy(&client->output[client->outputLength], &reply, sizeof(reply));
+    client->outputLength += sizeof(reply) + bitmapSize;
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Close Client Function
+// --- Stops watching the client and frees it
+// ****************************************************************************************************
+void closeClient(Client *client)
+{
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    free(client->input);
+    free(client->output);
+    free(client);
+}
+
+// ****************************************************************************************************
+// Flush Client Function
+// --- Sends as much of the client's queued replies as the socket takes, watching for EPOLLOUT while
+// --- some remain. Returns false if the connection failed.
+// ****************************************************************************************************
+bool flushClient(Client *client)
+{
+    // Function Variables
+    struct epoll_event event;       // Events the client is watched for
+    ssize_t sent;                   // Bytes taken by the socket
+
+    while(client->outputSent < client->outputLength)
+    {
+        sent = send(client->fd, &client->output[client->outputSent], client->outputLength - client->outputSent, MSG_NOSIGNAL);
+        if(sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        if(sent <= 0)
+        {
+            return false;
+        }
+        client->outputSent += sent;
+    }
+
+    if(client->outputSent == client->outputLength)
+    {
+        client->outputSent = 0;
+        client->outputLength = 0;
+    }
+
+    // Watch for room in the socket only while replies are waiting
+    if(client->writing != (client->outputLength > 0))
+    {
+        client->writing = client->outputLength > 0;
+        event.events = EPOLLIN | (client->writing ? EPOLLOUT : 0);
+        event.data.ptr = client;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, client->fd, &event);
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Read Client Function
+// --- Reads what the client sent and handles every whole request in its input. Returns false if the
+// --- client closed the connection, sent an unframeable request, or memory runs out.
+// ****************************************************************************************************
+bool readClient(Client *client)
+{
+    // Function Variables
+    DaemonRequest request;          // Header of the next request
+    DaemonReply reply;              // Reply to a request that cannot be framed
+    long long payload;              // Payload bytes of the next request
+    size_t handled = 0;             // Bytes of input handled
+    ssize_t received;               // Bytes read from the socket
+    bool open = true;               // Flag indicating the connection is still usable
+
+    // Drain the socket
+    while(open)
+    {
+        if(reserve(&client->input, &client->inputCapacity, client->inputLength + READ_CHUNK) == false)
+        {
+            return false;
+        }
+        received = recv(client->fd, &client->input[client->inputLength], READ_CHUNK, 0);
+        if(received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        open = received > 0;
+        client->inputLength += received > 0 ? received : 0;
+    }
+
+    // Handle every whole request; the input buffer stays 8 byte aligned at each request
+    while(client->inputLength - handled >= sizeof(request))
+    {
+        memcpy(&request, &client->input[handled], sizeof(request));
+        payload = payloadSize(&request);
+        if(payload < 0)
+        {
+            memset(&reply, 0, sizeof(reply));
+            reply.status = DAEMON_ERROR_INVALID;
+            if(reserve(&client->output, &client->outputCapacity, client->outputLength + sizeof(reply)))
+            {
+                memcpy(&client->output[client->outputLength], &reply, sizeof(reply));
+                client->outputLength += sizeof(reply);
+                flushClient(client);
+            }
+            return false;
+        }
+        if(client->inputLength - handled < sizeof(request) + (size_t)payload)
+        {
+            break;
+        }
+
+        if(handleRequest(client, &request, &client->input[handled + sizeof(request)]) == false)
+        {
+            return false;
+        }
+        handled += sizeof(request) + payload;
+    }
+
+    memmove(client->input, &client->input[handled], client->inputLength - handled);
+    client->inputLength -= handled;
+
+    return flushClient(client) && open;
+}
+
+// ****************************************************************************************************
+// Main Function
+// --- Given arguments in the form :s:p: listens on the socket and serves clients until SIGINT or
+// --- SIGTERM, then frees every cache and removes the socket. -p may be given once per plugin.
+// ****************************************************************************************************
+int main(int argc, char **argv)
+{
+    // Function Variables
+    int opt;                        // Option for switch case to gather argument list
+    int listenFd;                   // Listening socket
+    int clientFd;                   // Socket of a new client
+    struct sockaddr_un address;     // Path of the listening socket
+    struct epoll_event event;       // Event registered with epoll
+    struct epoll_event *events;     // Events returned by epoll_wait
+    struct sigaction action;        // Handler of SIGINT and SIGTERM
+    Client *client;                 // Client of the current event
+    int ready;                      // Events returned by epoll_wait
+    int index;                      // Index counter for moving through events and slots
+
+    // Every -p is one argument, so argc bounds the plugins
+    allowedPlugins = calloc(argc, sizeof(char *));
+    while (allowedPlugins != NULL && (opt = getopt(argc, argv, ":s:p:")) != -1)
+    {
+        switch (opt)
+        {
+            case 's': socketName = optarg; break;
+            case 'p': allowedPlugins[numAllowedPlugins++] = optarg; break;
+            default:
+                printf("Error: Please check format of arguments ... \n");
+                exit(1);
+        }
+    }
+
+    if(allowedPlugins == NULL || socketName == NULL || strlen(socketName) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "Usage: %s -s socket [-p plugin.so]...\n", argv[0]);
+        exit(1);
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    // Listen on the socket, replacing a stale one left by an earlier run. Only the owner may connect;
+    // no client can before listen, so the mode is set in time
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketName);
+    unlink(socketName);
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if(listenFd < 0 || bind(listenFd, (struct sockaddr *)&address, sizeof(address)) != 0
+        || chmod(socketName, S_IRUSR | S_IWUSR) != 0 || listen(listenFd, SOMAXCONN) != 0)
+    {
+        printf("[ERROR] Could not listen on %s ... [EXITING PROGRAM]\n", socketName);
+        exit(1);
+    }
+
+    caches = calloc(MAX_CACHES, sizeof(NamedCache));
+    events = calloc(MAX_EVENTS, sizeof(struct epoll_event));
+    epollFd = epoll_create1(0);
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if(caches == NULL || events == NULL || epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) != 0)
+    {
+        printf("[ERROR] Could not start the event loop ... [EXITING PROGRAM]\n");
+        exit(1);
+    }
+
+    printf("[listen] %s\n", socketName);
+    fflush(stdout);
+
+    while(running)
+    {
+        ready = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        for (index = 0; index < ready; index++)
+        {
+            // Accept every waiting connection
+            if(events[index].data.ptr == NULL)
+            {
+                while((clientFd = accept(listenFd, NULL, NULL)) >= 0)
+                {
+                    client = calloc(1, sizeof(Client));
+                    if(client == NULL || fcntl(clientFd, F_SETFL, O_NONBLOCK) != 0)
+                    {
+                        free(client);
+                        close(clientFd);
+                        continue;
+                    }
+                    client->fd = clientFd;
+                    event.events = EPOLLIN;
+                    event.data.ptr = client;
+                    epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &event);
+                }
+                continue;
+            }
+
+            client = events[index].data.ptr;
+            if(((events[index].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && readClient(client) == false)
+                || ((events[index].events & EPOLLOUT) && flushClient(client) == false))
+            {
+                closeClient(client);
+            }
+        }
+        fflush(stdout);
+    }
+
+    // Free every cache and remove the socket
+    for (index = 0; index < MAX_CACHES; index++)
+    {
+        cacheDestroy(caches[index].cache);
+    }
+    free(caches);
+    free(events);
+    free(allowedPlugins);
+    close(epollFd);
+    close(listenFd);
+    unlink(socketName);
+
+    return 0;
+}
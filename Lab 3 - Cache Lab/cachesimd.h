@@ -0,0 +1,72 @@
+//
+//  cachesimd.h - wire protocol of cachesimd
+//  : clients connect to the daemon's Unix domain socket and send requests, each a DaemonRequest
+//  : followed by its payload. Every request gets one DaemonReply, followed by a hit bitmap for
+//  : DAEMON_ACCESS. All fields are in the byte order of the host, as both ends share it.
+//
+
+#ifndef cachesimd_h
+#define cachesimd_h
+
+#include "libcachesim.h"
+
+//
+// DaemonRequest types and their payload
+//  - DAEMON_CREATE: a DaemonConfig; creates the cache called name
+//  - DAEMON_ACCESS: count 64 bit addresses simulated in order on the cache called name
+//  - DAEMON_STATS: none; replies with the counters of the cache
+//  - DAEMON_RESET: none; zeroes the counters of the cache
+//  - DAEMON_DESTROY: none; frees the cache
+//
+#define DAEMON_CREATE 1
+#define DAEMON_ACCESS 2
+#define DAEMON_STATS 3
+#define DAEMON_RESET 4
+#define DAEMON_DESTROY 5
+
+// Longest cache name including its terminating NUL, and most addresses of one DAEMON_ACCESS
+#define DAEMON_NAME_MAX 32
+#define DAEMON_BATCH_MAX (1 << 24)
+
+typedef struct{
+    unsigned int type;
+    unsigned int reserved;
+    unsigned long long count;
+    char name[DAEMON_NAME_MAX];
+} DaemonRequest;
+
+//
+// DaemonConfig
+// : CacheConfig of DAEMON_CREATE with the strings held inline, NUL terminated
+//
+typedef struct{
+    int addressSize;
+    int setBits;
+    int linesPerSet;
+    int blockOffsetBits;
+    int sets;
+    int ways;
+    char algorithm[64];
+    char indexHash[16];
+} DaemonConfig;
+
+//
+// DaemonReply
+// : status of the request and the counters of the cache after it. For DAEMON_ACCESS it is
+// : followed by (count + 7) / 8 bytes, bit i % 8 of byte i / 8 set when address i hit.
+//
+#define DAEMON_OK 0
+#define DAEMON_ERROR_UNKNOWN 1      // No cache of that name
+#define DAEMON_ERROR_INVALID 2      // Unknown type, invalid config, optimal, name not NUL terminated, or batch over DAEMON_BATCH_MAX
+#define DAEMON_ERROR_EXISTS 3       // DAEMON_CREATE of a name already in use
+#define DAEMON_ERROR_FULL 4         // DAEMON_CREATE with every slot in use
+#define DAEMON_ERROR_DENIED 5       // DAEMON_CREATE of a plugin not allowed by the daemon's -p
+
+typedef struct{
+    int status;
+    int reserved;
+    unsigned long long count;
+    CacheStats stats;
+} DaemonReply;
+
+#endif /* cachesimd_h */
@@ -0,0 +1,223 @@
+// ****************************************************************************************************
+//
+//                                          cachetiming.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                                   Non-Blocking Timing Model:
+//
+//              issue:     a0   a1   a2   a3   a4 ...     (every issueInterval cycles, or at the
+//                          |    |    |                    cycle of a timestamped record)
+//              miss a0:   [hit][    latency    ][xfer]   -> MSHR 0 busy until the block arrives
+//              miss a2:             [hit][    latency    ][xfer]   -> MSHR 1, overlaps a0
+//              a3 = a0's block:     waits on MSHR 0 (merged, no second memory request)
+//
+//                  Accesses issue in order and never wait for earlier ones to finish, so misses
+//                  overlap up to the number of MSHRs (miss status holding registers). A miss to a
+//                  block that is already outstanding merges into its MSHR. A miss finding every
+//                  MSHR busy stalls issue until the first one frees. Memory answers after a fixed
+//                  latency, or that of its bank when a DRAM model is set (cachedram.c), then the
+//                  block occupies the bus for transferCycles, so back-to-back misses are limited by
+//                  bandwidth. The run takes as long as its last completion.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // header file for libcachesim.c
+#include <stdlib.h>                 // stdlib.h used for malloc()
+
+// CacheTiming Struct
+struct CacheTiming{
+    TimingConfig config;            // Latencies, bandwidth, and MSHRs of the model
+    int blockOffsetBits;            // (b) Bits of an address within its block
+    unsigned long long *mshrBlock;  // Block address outstanding in each MSHR
+    unsigned long long *mshrReady;  // Cycle each MSHR's block arrives; free once it has passed
+    unsigned long long nextIssue;   // Earliest cycle the next access may issue
+    unsigned long long busFree;     // Cycle the memory bus finishes its last transfer
+    unsigned long long busyEnd;     // Latest completion of any miss, for the MLP
+    unsigned long long start;       // Cycle the counters were last reset
+    unsigned long long end;         // Latest completion of any access since the reset
+    unsigned long long missCycles;  // Sum of the latency of every memory request
+    unsigned long long busyCycles;  // Cycles with at least one memory request outstanding
+    CacheDram *dram;                // DRAM model answering requests, NULL for the fixed latency
+    TimingStats stats;
+};
+
+// ****************************************************************************************************
+// Timing Create Function
+// --- Allocates a timing model for a cache with blocks of 2^blockOffsetBits bytes. Returns NULL if
+// --- the config is invalid or memory runs out.
+// ****************************************************************************************************
+CacheTiming *timingCreate(const TimingConfig *config, int blockOffsetBits)
+{
+    // Function Variables
+    CacheTiming *timing;            // Model being created
+
+    if(config->mshrs <= 0 || config->hitLatency < 0 || config->memoryLatency < 0
+        || config->transferCycles < 0 || config->issueInterval < 0)
+    {
+        return NULL;
+    }
+
+    timing = calloc(1, sizeof(CacheTiming));
+    if(timing == NULL)
+    {
+        return NULL;
+    }
+
+    timing->config = *config;
+    timing->blockOffsetBits = blockOffsetBits;
+    timing->mshrBlock = calloc(config->mshrs, sizeof(unsigned long long));
+    timing->mshrReady = calloc(config->mshrs, sizeof(unsigned long long));
+    if(timing->mshrBlock == NULL || timing->mshrReady == NULL)
+    {
+        timingDestroy(timing);
+        return NULL;
+    }
+
+    return timing;
+}
+
+// ****************************************************************************************************
+// Timing Destroy Function
+// --- Frees a timing model; NULL is ignored
+// ****************************************************************************************************
+void timingDestroy(CacheTiming *timing)
+{
+    if(timing == NULL)
+    {
+        return;
+    }
+
+    free(timing->mshrBlock);
+    free(timing->mshrReady);
+    free(timing);
+}
+
+// ****************************************************************************************************
+// Timing Set Dram Function
+// --- Answers later memory requests with the latency of dram instead of the fixed memoryLatency.
+// --- The DRAM model stays owned by the caller; NULL restores the fixed latency.
+// ****************************************************************************************************
+void timingSetDram(CacheTiming *timing, CacheDram *dram)
+{
+    timing->dram = dram;
+}
+
+// ****************************************************************************************************
+// Memory Request Function
+// --- Returns the cycle a block requested from memory at cycle request arrives: after the memory
+// --- or DRAM latency, once the bus has finished every earlier transfer
+// ****************************************************************************************************
+static unsigned long long memoryRequest(CacheTiming *timing, unsigned long long block, unsigned long long request)
+{
+    // Function Variables
+    unsigned long long transfer = timing->dram != NULL ? dramAccess(timing->dram, block << timing->blockOffsetBits, request)
+        : request + timing->config.memoryLatency;
+
+    if(transfer < timing->busFree)
+    {
+        transfer = timing->busFree;
+    }
+    timing->busFree = transfer + timing->config.transferCycles;
+
+    return timing->busFree;
+}
+
+// ****************************************************************************************************
+// Timing Access Function
+// --- Times an access to address that the cache answered with result, issued no earlier than cycle
+// --- (0 for the fixed issue rate). Returns the cycle the access completes.
+// ****************************************************************************************************
+unsigned long long timingAccess(CacheTiming *timing, unsigned long long address, CacheResult result, unsigned long long cycle)
+{
+    // Function Variables
+    unsigned long long block = address >> timing->blockOffsetBits;
+    unsigned long long now = cycle > timing->nextIssue ? cycle : timing->nextIssue;
+    unsigned long long done;        // Cycle the access completes
+    int idle = -1;                  // MSHR free at now
+    int first = 0;                  // MSHR freeing first
+    int mshr;                       // Index counter for moving through the MSHRs
+
+    timing->stats.accesses++;
+
+    // A block still in flight is outstanding even if the cache already counts it as present
+    for (mshr = 0; mshr < timing->config.mshrs; mshr++)
+    {
+        if(timing->mshrReady[mshr] > now && timing->mshrBlock[mshr] == block)
+        {
+            break;
+        }
+        if(timing->mshrReady[mshr] <= now && idle < 0)
+        {
+            idle = mshr;
+        }
+        if(timing->mshrReady[mshr] < timing->mshrReady[first])
+        {
+            first = mshr;
+        }
+    }
+
+    if(mshr < timing->config.mshrs)
+    {
+        timing->stats.merged++;
+        done = timing->mshrReady[mshr];
+    }
+    else if(result == CACHE_HIT)
+    {
+        done = now + timing->config.hitLatency;
+    }
+    else
+    {
+        // Stall issue until an MSHR frees
+        if(idle < 0)
+        {
+            timing->stats.stallCycles += timing->mshrReady[first] - now;
+            now = timing->mshrReady[first];
+            idle = first;
+        }
+
+        done = memoryRequest(timing, block, now + timing->config.hitLatency);
+        timing->mshrBlock[idle] = block;
+        timing->mshrReady[idle] = done;
+        timing->stats.requests++;
+
+        // Cycles with a request outstanding, counting overlapping requests once
+        timing->missCycles += done - now;
+        timing->busyCycles += done - (now > timing->busyEnd ? now : timing->busyEnd);
+        timing->busyEnd = done;
+    }
+
+    timing->nextIssue = now + timing->config.issueInterval;
+    if(done > timing->end)
+    {
+        timing->end = done;
+    }
+
+    return done;
+}
+
+// ****************************************************************************************************
+// Timing Get Stats Function
+// --- Copies the counters since creation or the last timingResetStats into stats
+// ****************************************************************************************************
+void timingGetStats(const CacheTiming *timing, TimingStats *stats)
+{
+    *stats = timing->stats;
+    stats->cycles = timing->end > timing->start ? timing->end - timing->start : 0;
+    stats->parallelism = timing->busyCycles > 0 ? (double)timing->missCycles / timing->busyCycles : 0;
+}
+
+// ****************************************************************************************************
+// Timing Reset Stats Function
+// --- Zeroes the counters and starts counting cycles from the next issue, keeping the MSHRs and bus
+// ****************************************************************************************************
+void timingResetStats(CacheTiming *timing)
+{
+    timing->start = timing->nextIssue;
+    timing->end = timing->nextIssue;
+    timing->missCycles = 0;
+    timing->busyCycles = 0;
+    timing->stats = (TimingStats){0};
+}
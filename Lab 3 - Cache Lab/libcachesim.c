@@ -0,0 +1,1575 @@
+// ****************************************************************************************************
+//
+//                                         libcachesim.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                                  Memory Address Structure:
+//
+//                               [     tag     ][   s   ][  b  ]
+//
+//                  The engine keeps all state of a simulated cache inside its Cache handle: the
+//                  geometry, the "clock", the counters, and the lines of every set stored in one
+//                  flat array (set * numLines + line). Nothing is shared between handles, so
+//                  independent caches may be driven concurrently from separate threads.
+//
+//                  Lines keep 32 bit LRU and FIFO stamps of the "clock" to stay small. Before the
+//                  clock would overflow, every stamp is renumbered densely in the same order, so
+//                  traces of any length replace exactly as with unbounded stamps.
+//
+//                                      Set Index Functions:
+//
+//                  modulo  -   block % S, the raw s middle bits when S is a power of two
+//                  xor     -   every s bit chunk of the block XORed together, then % S
+//                  prime   -   block % P, P the largest prime <= S; the sets above P stay unused
+//                  skew    -   skewed-associative: way w is indexed by its own hash of the block,
+//                              so blocks conflicting in one way are spread apart in the others
+//
+//                  Since hashed indexes no longer leave the set bits implied by the set, every
+//                  line stores the whole block address (address >> b) as its tag.
+//
+//                                    Replacement Algorithms:
+//
+//                  lru     -   evicts the line with the oldest last use
+//                  fifo    -   evicts the line with the oldest insertion
+//                  optimal -   Belady: evicts the line whose next use is furthest away, given
+//                              with every access through cacheAccessNext
+//                  hawkeye -   learns from what optimal would have done in the past. OPTgen
+//                              replays the accesses of up to HAWKEYE_SAMPLED_SETS sets over a
+//                              history of HAWKEYE_HISTORY accesses per way, keeping the number of
+//                              blocks OPT would hold at each step (the occupancy vector). When a
+//                              block is reused and every step since its last access had room, OPT
+//                              would have hit, and the region (4 KiB page) of the last access is
+//                              trained as cache-friendly; otherwise as cache-averse. Traces have no
+//                              PC, so the predictor is keyed by region. Lines are kept with RRIP:
+//                              friendly blocks are inserted and promoted to RRPV 0 and age the
+//                              rest of the set, averse blocks get HAWKEYE_RRPV_MAX and are evicted
+//                              first. Evicting a friendly line detrains its region.
+//                  plugin  -   a CachePolicy from a shared object decides through callbacks and
+//                              keeps its own per-line metadata. The built-in algorithms above
+//                              never go through the callbacks.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // header file for libcachesim.c
+#include <stdlib.h>                 // stdlib.h used for malloc()
+#include <string.h>                 // string.h used for strcmp()
+#include <dlfcn.h>                  // dlfcn.h used for dlopen()
+#include <stdint.h>                 // stdint.h used for uintptr_t
+#include <sys/mman.h>               // sys/mman.h used for madvise()
+
+// Algorithm types
+typedef enum{
+    ALGORITHM_LRU,
+    ALGORITHM_FIFO,
+    ALGORITHM_OPTIMAL,
+    ALGORITHM_HAWKEYE,
+    ALGORITHM_PLUGIN
+} Algorithm;
+
+// Prefix of algorithm names loading a CachePolicy plugin
+#define PLUGIN_PREFIX "plugin:"
+
+// Set index functions
+typedef enum{
+    INDEX_MODULO,
+    INDEX_XOR,
+    INDEX_PRIME,
+    INDEX_SKEW
+} IndexHash;
+
+// CacheLine Struct
+typedef struct{
+    bool validBit;                  // Valid Bit showing use of CacheLine Block: True/1 = in use; False/0 = not in use.
+    short owner;                    // Tenant whose address space the block belongs to
+    int lruCount;                   // "Clock" time of last use for LRU algorithm
+    unsigned long long tag;         // Block address held by the CacheLine Block
+    int fifoCount;                  // "Clock" time of insertion for FIFO algorithm
+    int rank;                       // Next use for OPTIMAL, RRPV for HAWKEYE; higher is evicted first
+} CacheLine;
+
+// Hawkeye parameters
+#define HAWKEYE_SAMPLED_SETS 64     // Sets replayed by OPTgen
+#define HAWKEYE_HISTORY 8           // OPTgen history length per way
+#define HAWKEYE_PREDICTOR_BITS 11   // Index bits of the region predictor
+#define HAWKEYE_PREDICTOR (1 << HAWKEYE_PREDICTOR_BITS)
+#define HAWKEYE_COUNTER_MAX 7       // 3 bit predictor counters
+#define HAWKEYE_FRIENDLY 4          // Counter value from which a region is cache-friendly
+#define HAWKEYE_RRPV_MAX 7          // 3 bit re-reference prediction values
+#define HAWKEYE_REGION_BITS 12      // Address bits within a region
+
+// SamplerEntry Struct
+typedef struct{
+    unsigned long long block;       // Block address of the last access
+    unsigned long long region;      // Region of the last access, trained on the next one
+    long time;                      // Access of the sampled set the block was last seen at
+    bool valid;                     // Flag indicating the entry holds a block
+} SamplerEntry;
+
+// Hawkeye Struct
+typedef struct{
+    unsigned char predictor[HAWKEYE_PREDICTOR]; // Saturating counter per hashed region
+    int sampleStride;               // Every sampleStride-th set is sampled
+    int numSampled;                 // Number of sampled sets
+    int history;                    // OPTgen history length, HAWKEYE_HISTORY * ways
+    int regionShift;                // Block address bits within a region
+    long *times;                    // Accesses seen by each sampled set
+    int *occupancy;                 // numSampled * history blocks OPT holds at each step
+    SamplerEntry *entries;          // numSampled * history last accesses of each sampled set
+} Hawkeye;
+
+// Cache Struct
+struct Cache{
+    CacheConfig config;             // Arguments the cache was created with
+    Algorithm algorithm;            // Replacement algorithm parsed from config.algorithm
+    IndexHash indexHash;            // Set index function parsed from config.indexHash
+    int numSets;                    // (S) Number of sets
+    int numLines;                   // (E) Number of lines; associativity
+    int indexBits;                  // Bits needed to index numSets sets
+    unsigned long long modulus;     // Number of sets blocks are spread over by the index function
+    unsigned long long setMask;     // numSets - 1 when numSets is a power of two, otherwise 0
+    bool maskIndex;                 // Flag indicating the set is just the masked block (modulo of 2^s sets)
+    unsigned long long addressMask; // Mask of the addressSize bits of an address
+    int clock;                      // "Clock" time counter for algorithm implementation
+    CacheStats stats;               // Hit, miss, and eviction counters
+    CacheLine *lines;               // numSets * numLines cache lines, one set after another
+    CacheLine *lastLine;            // Line holding the block of the most recent access
+    unsigned long long victimBlock; // Block address the most recent eviction removed
+    int nextUse;                    // Next use of the current access for OPTIMAL
+    long rankBase;                  // Trace position OPTIMAL ranks count from, raised by rebaseRanks
+    Hawkeye *hawkeye;               // Predictor and OPTgen state for HAWKEYE, otherwise NULL
+    void *plugin;                   // dlopen handle of the PLUGIN shared object, otherwise NULL
+    const CachePolicy *policy;      // Callbacks of the PLUGIN policy
+    void *policyState;              // State returned by the policy's init
+    unsigned long long policyHash;  // Hash of the PLUGIN shared object, checked by cacheRestore
+    unsigned char *policyData;      // numSets * numLines * lineDataSize bytes of policy metadata
+    int tenant;                     // Tenant of the current access, 0 outside cacheAccessTenant
+    int fillFirst;                  // First way the current access may fill
+    int fillEnd;                    // One past the last way the current access may fill
+    int partitionFirst[CACHE_MAX_TENANTS];  // First way of each tenant's partition
+    int partitionWays[CACHE_MAX_TENANTS];   // Number of ways of each tenant's partition
+    CacheStats tenantStats[CACHE_MAX_TENANTS]; // Counters of each tenant
+};
+
+// Number of addresses collapsed into runs at a time by cacheAccessCollapsed
+#define RUN_CHUNK 4096
+
+// Bytes of lines from which they are kept in huge pages, and the size of a host page
+#define HUGE_LINES_BYTES (2 << 20)
+#define HOST_PAGE_BYTES 4096
+
+// Addresses whose sets cacheAccessBatch computes at a time, how many accesses ahead it prefetches
+// a set, and the most bytes of each set prefetched
+#define BATCH_CHUNK 256
+#define BATCH_PREFETCH 8
+#define BATCH_PREFETCH_BYTES 512
+
+// "Clock" time at which every stamp is renumbered before the int clock overflows
+#define CLOCK_LIMIT INT_MAX
+
+// Distance from rankBase at which OPTIMAL ranks are rebased before they overflow an int
+#define RANK_LIMIT INT_MAX
+
+// Cache checkpoint header written by cacheSave
+typedef struct{
+    int addressSize;
+    int setBits;
+    int linesPerSet;
+    int blockOffsetBits;
+    int algorithm;
+    int sets;
+    int ways;
+    int indexHash;
+    int clock;
+    unsigned long long policyHash;
+    CacheStats stats;
+} CacheHeader;
+
+// ****************************************************************************************************
+// Largest Prime Function
+// --- Returns the largest prime not above limit, or 1 if there is none
+// ****************************************************************************************************
+static unsigned long long largestPrime(unsigned long long limit)
+{
+    // Function Variables
+    unsigned long long candidate;   // Number tested for primality
+    unsigned long long divisor;     // Trial divisor of candidate
+
+    for (candidate = limit; candidate >= 2; candidate--)
+    {
+        for (divisor = 2; divisor * divisor <= candidate && candidate % divisor != 0; divisor++)
+        {
+        }
+        if(divisor * divisor > candidate)
+        {
+            return candidate;
+        }
+    }
+
+    return 1;
+}
+
+// ****************************************************************************************************
+// Set Index Function
+// --- Returns the set of the given block address in way (only used by skew)
+// ****************************************************************************************************
+static inline unsigned long long setIndex(const Cache *cache, unsigned long long block, int way)
+{
+    // Function Variables
+    unsigned long long hash = 0;    // Block address hashed down to the index bits
+
+    switch(cache->indexHash)
+    {
+        case INDEX_XOR:
+            // Fold every indexBits chunk of the block onto the lowest one
+            if(cache->indexBits == 0)
+            {
+                return 0;
+            }
+            for (; block != 0; block >>= cache->indexBits)
+            {
+                hash ^= block & ((1ULL << cache->indexBits) - 1);
+            }
+            break;
+        case INDEX_SKEW:
+            // Distinct multiplicative hash per way, keeping the well mixed upper half
+            hash = ((block ^ (CACHE_HASH_MULTIPLIER * (unsigned long long)way)) * CACHE_HASH_MULTIPLIER) >> 32;
+            break;
+        default:
+            hash = block;
+            break;
+    }
+
+    return cache->setMask != 0 || cache->modulus == 1 ? hash & cache->setMask : hash % cache->modulus;
+}
+
+// ****************************************************************************************************
+// Allocate Lines Function
+// --- Returns count invalid cache lines, or NULL if memory runs out. Large caches ask for huge pages,
+// --- so accesses to random sets miss the host TLB far less often.
+// ****************************************************************************************************
+static CacheLine *allocateLines(size_t count)
+{
+    // Function Variables
+    CacheLine *lines = calloc(count, sizeof(CacheLine));
+    uintptr_t start = ((uintptr_t)lines + HOST_PAGE_BYTES - 1) & ~(uintptr_t)(HOST_PAGE_BYTES - 1); // First whole page
+    uintptr_t end = ((uintptr_t)lines + count * sizeof(CacheLine)) & ~(uintptr_t)(HOST_PAGE_BYTES - 1); // End of the last whole page
+
+#ifdef MADV_HUGEPAGE
+    if(lines != NULL && count * sizeof(CacheLine) >= HUGE_LINES_BYTES && end > start)
+    {
+        madvise((void *)start, end - start, MADV_HUGEPAGE);
+    }
+#endif
+
+    return lines;
+}
+
+// ****************************************************************************************************
+// Create Hawkeye Function
+// --- Allocates the Hawkeye state of the cache with every region predicted cache-friendly.
+// --- Returns false if memory runs out.
+// ****************************************************************************************************
+static bool createHawkeye(Cache *cache)
+{
+    // Function Variables
+    Hawkeye *hawkeye;               // Newly allocated Hawkeye state
+
+    hawkeye = calloc(1, sizeof(Hawkeye));
+    if(hawkeye == NULL)
+    {
+        return false;
+    }
+    cache->hawkeye = hawkeye;
+
+    memset(hawkeye->predictor, HAWKEYE_FRIENDLY, sizeof(hawkeye->predictor));
+    hawkeye->numSampled = cache->numSets < HAWKEYE_SAMPLED_SETS ? cache->numSets : HAWKEYE_SAMPLED_SETS;
+    hawkeye->sampleStride = cache->numSets / hawkeye->numSampled;
+    hawkeye->history = HAWKEYE_HISTORY * cache->numLines;
+    hawkeye->regionShift = HAWKEYE_REGION_BITS > cache->config.blockOffsetBits ? HAWKEYE_REGION_BITS - cache->config.blockOffsetBits : 0;
+    hawkeye->times = calloc(hawkeye->numSampled, sizeof(long));
+    hawkeye->occupancy = calloc((size_t)hawkeye->numSampled * hawkeye->history, sizeof(int));
+    hawkeye->entries = calloc((size_t)hawkeye->numSampled * hawkeye->history, sizeof(SamplerEntry));
+
+    return hawkeye->times != NULL && hawkeye->occupancy != NULL && hawkeye->entries != NULL;
+}
+
+// ****************************************************************************************************
+// Hash Object Function
+// --- Hashes the bytes of the file at path into hash. Returns false if it cannot be read.
+// ****************************************************************************************************
+static bool hashObject(const char *path, unsigned long long *hash)
+{
+    // Function Variables
+    FILE *file;                     // Shared object file pointer
+    unsigned char buffer[4096];     // Bytes of the file read at once
+    size_t length;                  // Bytes in buffer
+    size_t position;                // Index counter for moving through buffer
+
+    file = fopen(path, "rb");
+    if(file == NULL)
+    {
+        return false;
+    }
+
+    *hash = 0;
+    while((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        for (position = 0; position < length; position++)
+        {
+            *hash = (*hash ^ buffer[position]) * CACHE_HASH_MULTIPLIER;
+        }
+    }
+    fclose(file);
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Load Plugin Function
+// --- Opens the shared object at path, checks its CachePolicy, and creates the policy state and
+// --- metadata of the cache. Returns false if the object or its policy cannot be used.
+// ****************************************************************************************************
+static bool loadPlugin(Cache *cache, const char *path)
+{
+    // Function Variables
+    const CachePolicy *(*getPolicy)(void);  // Function exported by the plugin
+
+    cache->plugin = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if(cache->plugin == NULL)
+    {
+        return false;
+    }
+
+    *(void **)&getPolicy = dlsym(cache->plugin, CACHE_POLICY_SYMBOL);
+    cache->policy = getPolicy != NULL ? getPolicy() : NULL;
+    if(cache->policy == NULL || cache->policy->version != CACHE_POLICY_VERSION || cache->policy->init == NULL
+        || cache->policy->onHit == NULL || cache->policy->victim == NULL || cache->policy->onFill == NULL
+        || cache->policy->destroy == NULL || (cache->policy->save == NULL) != (cache->policy->restore == NULL)
+        || hashObject(path, &cache->policyHash) == false)
+    {
+        return false;
+    }
+
+    // Every line's metadata starts zeroed; a policy without metadata still gets a valid pointer
+    cache->policyData = calloc((size_t)cache->numSets * cache->numLines, cache->policy->lineDataSize > 0 ? cache->policy->lineDataSize : 1);
+    cache->policyState = cache->policy->init(cache->numSets, cache->numLines);
+
+    return cache->policyData != NULL && cache->policyState != NULL;
+}
+
+// ****************************************************************************************************
+// Cache Create Function
+// --- Allocates a cache of S = 2^s (or config->sets) sets of E = 2^e (or config->ways) empty lines
+// --- from the given config. Returns NULL if the algorithm or set index function is unknown, the
+// --- geometry is invalid, or memory runs out.
+// ****************************************************************************************************
+Cache *cacheCreate(const CacheConfig *config)
+{
+    // Function Variables
+    Cache *cache;                   // Newly allocated cache handle
+    Algorithm algorithm;            // Replacement algorithm of the config
+    IndexHash indexHash;            // Set index function of the config
+    int tenant;                     // Index counter for moving through tenants
+
+    if(config->algorithm == NULL)
+    {
+        return NULL;
+    }
+    else if(strcmp(config->algorithm, "lru") == 0)
+    {
+        algorithm = ALGORITHM_LRU;
+    }
+    else if(strcmp(config->algorithm, "fifo") == 0)
+    {
+        algorithm = ALGORITHM_FIFO;
+    }
+    else if(strcmp(config->algorithm, "optimal") == 0)
+    {
+        algorithm = ALGORITHM_OPTIMAL;
+    }
+    else if(strcmp(config->algorithm, "hawkeye") == 0)
+    {
+        algorithm = ALGORITHM_HAWKEYE;
+    }
+    else if(strncmp(config->algorithm, PLUGIN_PREFIX, strlen(PLUGIN_PREFIX)) == 0)
+    {
+        algorithm = ALGORITHM_PLUGIN;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    if(config->indexHash == NULL || strcmp(config->indexHash, "modulo") == 0)
+    {
+        indexHash = INDEX_MODULO;
+    }
+    else if(strcmp(config->indexHash, "xor") == 0)
+    {
+        indexHash = INDEX_XOR;
+    }
+    else if(strcmp(config->indexHash, "prime") == 0)
+    {
+        indexHash = INDEX_PRIME;
+    }
+    else if(strcmp(config->indexHash, "skew") == 0)
+    {
+        indexHash = INDEX_SKEW;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    // Skewed sets have no single set to rank within
+    if(indexHash == INDEX_SKEW && algorithm != ALGORITHM_LRU && algorithm != ALGORITHM_FIFO)
+    {
+        return NULL;
+    }
+
+    // Geometry must fit within the address and the int sized set and line counts
+    if(config->addressSize <= 0 || config->addressSize > 64 || config->blockOffsetBits < 0
+        || config->blockOffsetBits > config->addressSize
+        || (config->sets == 0 && (config->setBits < 0 || config->setBits > 30
+            || config->setBits + config->blockOffsetBits > config->addressSize))
+        || (config->ways == 0 && (config->linesPerSet < 0 || config->linesPerSet > 16))
+        || config->sets < 0 || config->sets > 1 << 30 || config->ways < 0 || config->ways > 1 << 16)
+    {
+        return NULL;
+    }
+
+    cache = calloc(1, sizeof(Cache));
+    if(cache == NULL)
+    {
+        return NULL;
+    }
+
+    cache->config = *config;
+    cache->algorithm = algorithm;
+    cache->indexHash = indexHash;
+    cache->numSets = config->sets > 0 ? config->sets : 1 << config->setBits;
+    cache->numLines = config->ways > 0 ? config->ways : 1 << config->linesPerSet;
+    while((1LL << cache->indexBits) < cache->numSets)
+    {
+        cache->indexBits++;
+    }
+    cache->modulus = indexHash == INDEX_PRIME ? largestPrime(cache->numSets) : (unsigned long long)cache->numSets;
+    cache->setMask = (cache->modulus & (cache->modulus - 1)) == 0 ? cache->modulus - 1 : 0;
+    cache->maskIndex = indexHash == INDEX_MODULO && (cache->modulus & (cache->modulus - 1)) == 0;
+
+    // Every tenant may fill every way until partitioned
+    cache->fillEnd = cache->numLines;
+    for (tenant = 0; tenant < CACHE_MAX_TENANTS; tenant++)
+    {
+        cache->partitionWays[tenant] = cache->numLines;
+    }
+    cache->addressMask = config->addressSize == 64 ? ~0ULL : (1ULL << config->addressSize) - 1;
+
+    cache->nextUse = INT_MAX;
+
+    // Allocate every set at once, each line invalid
+    cache->lines = allocateLines((size_t)cache->numSets * cache->numLines);
+    if(cache->lines == NULL || (algorithm == ALGORITHM_HAWKEYE && createHawkeye(cache) == false)
+        || (algorithm == ALGORITHM_PLUGIN && loadPlugin(cache, &config->algorithm[strlen(PLUGIN_PREFIX)]) == false))
+    {
+        cacheDestroy(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+// ****************************************************************************************************
+// Cache Destroy Function
+// --- Frees the cache lines and the cache handle
+// ****************************************************************************************************
+void cacheDestroy(Cache *cache)
+{
+    if(cache != NULL)
+    {
+        if(cache->hawkeye != NULL)
+        {
+            free(cache->hawkeye->times);
+            free(cache->hawkeye->occupancy);
+            free(cache->hawkeye->entries);
+            free(cache->hawkeye);
+        }
+        if(cache->policyState != NULL)
+        {
+            cache->policy->destroy(cache->policyState);
+        }
+        if(cache->plugin != NULL)
+        {
+            dlclose(cache->plugin);
+        }
+        free(cache->policyData);
+        free(cache->lines);
+        free(cache);
+    }
+}
+
+// ****************************************************************************************************
+// Access Skewed Function
+// --- Same as cacheAccess for a skewed-associative cache, where the candidate line of each way lies
+// --- in the set given by that way's own hash of the block
+// ****************************************************************************************************
+static CacheResult accessSkewed(Cache *cache, unsigned long long block)
+{
+    // Function Variables
+    CacheLine *candidate;           // Line of the current way the block maps to
+    CacheLine *victim = NULL;       // Line to fill on a miss
+    CacheResult result = CACHE_MISS;// Outcome of the access on a miss
+    bool full = true;               // Flag indicating every candidate line is valid
+    int way;                        // Index counter for moving through the ways
+
+    for (way = 0; way < cache->numLines; way++)
+    {
+        candidate = &cache->lines[setIndex(cache, block, way) * cache->numLines + way];
+        if(candidate->validBit == false)
+        {
+            if(full && way >= cache->fillFirst && way < cache->fillEnd)
+            {
+                victim = candidate;
+                full = false;
+            }
+        }
+        else if(candidate->tag == block && candidate->owner == cache->tenant)
+        {
+            candidate->lruCount = cache->clock;
+            cache->stats.hits++;
+            cache->lastLine = candidate;
+            return CACHE_HIT;
+        }
+        // Lower count = least recently used or first in
+        else if(full && way >= cache->fillFirst && way < cache->fillEnd && (victim == NULL
+            || (cache->algorithm == ALGORITHM_LRU && candidate->lruCount < victim->lruCount)
+            || (cache->algorithm == ALGORITHM_FIFO && candidate->fifoCount < victim->fifoCount)))
+        {
+            victim = candidate;
+        }
+    }
+
+    cache->stats.misses++;
+    if(full)
+    {
+        result = CACHE_EVICT;
+        cache->stats.evictions++;
+        cache->victimBlock = victim->tag;
+    }
+
+    victim->validBit = true;
+    victim->owner = cache->tenant;
+    victim->tag = block;
+    victim->lruCount = cache->clock;
+    victim->fifoCount = cache->clock;
+    cache->lastLine = victim;
+
+    return result;
+}
+
+// ****************************************************************************************************
+// Region Counter Function
+// --- Returns the predictor counter of the region of the given block address
+// ****************************************************************************************************
+static inline unsigned char *regionCounter(Hawkeye *hawkeye, unsigned long long region)
+{
+    return &hawkeye->predictor[(region * CACHE_HASH_MULTIPLIER) >> (64 - HAWKEYE_PREDICTOR_BITS)];
+}
+
+// ****************************************************************************************************
+// Train Function
+// --- Moves the predictor counter of region towards cache-friendly or cache-averse
+// ****************************************************************************************************
+static inline void train(Hawkeye *hawkeye, unsigned long long region, bool friendly)
+{
+    // Function Variables
+    unsigned char *counter = regionCounter(hawkeye, region);
+
+    if(friendly && *counter < HAWKEYE_COUNTER_MAX)
+    {
+        (*counter)++;
+    }
+    else if(friendly == false && *counter > 0)
+    {
+        (*counter)--;
+    }
+}
+
+// ****************************************************************************************************
+// OPTgen Access Function
+// --- Replays an access of block in the given sampled set. If the block was seen within the
+// --- history, OPT would have hit if every step since then had a free way: the occupancy of those
+// --- steps is raised and the region of the last access trained friendly, otherwise averse.
+// ****************************************************************************************************
+static void optgenAccess(Cache *cache, int sampled, unsigned long long block, unsigned long long region)
+{
+    // Function Variables
+    Hawkeye *hawkeye = cache->hawkeye;
+    SamplerEntry *entries = &hawkeye->entries[(size_t)sampled * hawkeye->history];
+    int *occupancy = &hawkeye->occupancy[(size_t)sampled * hawkeye->history];
+    SamplerEntry *entry = NULL;     // Last access of block, or the entry to replace
+    long now = hawkeye->times[sampled]++;
+    long step;                      // Step of the history since the last access
+    bool fits = true;               // Flag indicating OPT had a free way at every step
+    int index;                      // Index counter for moving through the sampler entries
+
+    occupancy[now % hawkeye->history] = 0;
+
+    // Find the last access of block, else the oldest entry
+    for (index = 0; index < hawkeye->history; index++)
+    {
+        if(entries[index].valid && entries[index].block == block)
+        {
+            entry = &entries[index];
+            break;
+        }
+        else if(entry == NULL || entries[index].valid == false || (entry->valid && entries[index].time < entry->time))
+        {
+            entry = &entries[index];
+        }
+    }
+
+    if(entry->valid && entry->block == block && now - entry->time < hawkeye->history)
+    {
+        for (step = entry->time; step < now && fits; step++)
+        {
+            fits = occupancy[step % hawkeye->history] < cache->numLines;
+        }
+        for (step = entry->time; step < now && fits; step++)
+        {
+            occupancy[step % hawkeye->history]++;
+        }
+        train(hawkeye, entry->region, fits);
+    }
+    else if(entry->valid && entry->block == block)
+    {
+        train(hawkeye, entry->region, false);
+    }
+
+    entry->valid = true;
+    entry->block = block;
+    entry->region = region;
+    entry->time = now;
+}
+
+// ****************************************************************************************************
+// Access Ranked Function
+// --- Same as cacheAccess for the OPTIMAL and HAWKEYE algorithms, which evict the line of the
+// --- highest rank in the set: the furthest next use, or the highest RRPV
+// ****************************************************************************************************
+static CacheResult accessRanked(Cache *cache, CacheLine *set, unsigned long long index, unsigned long long block)
+{
+    // Function Variables
+    Hawkeye *hawkeye = cache->hawkeye;
+    unsigned long long region = 0;  // Region of the block for HAWKEYE
+    int rank;                       // Rank of the block after this access
+    bool friendly = false;          // Flag indicating HAWKEYE predicts the block cache-friendly
+    int victim = -1;                // Index of the line to fill on a miss
+    CacheResult result = CACHE_MISS;// Outcome of the access on a miss
+    int line;                       // Index counter for moving through the set
+
+    if(hawkeye != NULL)
+    {
+        region = block >> hawkeye->regionShift;
+        if(index % hawkeye->sampleStride == 0 && index / hawkeye->sampleStride < (unsigned long long)hawkeye->numSampled)
+        {
+            optgenAccess(cache, index / hawkeye->sampleStride, block, region);
+        }
+        friendly = *regionCounter(hawkeye, region) >= HAWKEYE_FRIENDLY;
+        rank = friendly ? 0 : HAWKEYE_RRPV_MAX;
+    }
+    else
+    {
+        rank = cache->nextUse;
+    }
+
+    for (line = 0; line < cache->numLines; line++)
+    {
+        if(set[line].validBit == false)
+        {
+            if(victim < 0 && line >= cache->fillFirst && line < cache->fillEnd)
+            {
+                victim = line;
+            }
+        }
+        else if(set[line].tag == block && set[line].owner == cache->tenant)
+        {
+            set[line].lruCount = cache->clock;
+            set[line].rank = rank;
+            cache->stats.hits++;
+            cache->lastLine = &set[line];
+            return CACHE_HIT;
+        }
+    }
+
+    cache->stats.misses++;
+
+    // If the set is full, evict the highest rank, the first one on a tie
+    if(victim < 0)
+    {
+        result = CACHE_EVICT;
+        victim = cache->fillFirst;
+        for (line = cache->fillFirst + 1; line < cache->fillEnd; line++)
+        {
+            if(set[line].rank > set[victim].rank)
+            {
+                victim = line;
+            }
+        }
+        cache->stats.evictions++;
+        cache->victimBlock = set[victim].tag;
+
+        // A friendly line had to go, so its region was predicted wrong
+        if(hawkeye != NULL && set[victim].rank < HAWKEYE_RRPV_MAX)
+        {
+            train(hawkeye, set[victim].tag >> hawkeye->regionShift, false);
+        }
+    }
+
+    // A friendly insertion ages the rest of the set
+    if(friendly)
+    {
+        for (line = 0; line < cache->numLines; line++)
+        {
+            if(set[line].validBit && set[line].rank < HAWKEYE_RRPV_MAX - 1)
+            {
+                set[line].rank++;
+            }
+        }
+    }
+
+    set[victim].validBit = true;
+    set[victim].owner = cache->tenant;
+    set[victim].tag = block;
+    set[victim].lruCount = cache->clock;
+    set[victim].fifoCount = cache->clock;
+    set[victim].rank = rank;
+    cache->lastLine = &set[victim];
+
+    return result;
+}
+
+// ****************************************************************************************************
+// Access Plugin Function
+// --- Same as cacheAccess for a PLUGIN policy, which is told of every hit and fill and picks the
+// --- victim of a full set
+// ****************************************************************************************************
+static CacheResult accessPlugin(Cache *cache, CacheLine *set, unsigned long long index, unsigned long long block)
+{
+    // Function Variables
+    const CachePolicy *policy = cache->policy;
+    size_t size = policy->lineDataSize;
+    unsigned char *setData = &cache->policyData[index * cache->numLines * size];
+    int victim = -1;                // Index of the line to fill on a miss
+    CacheResult result = CACHE_MISS;// Outcome of the access on a miss
+    int line;                       // Index counter for moving through the set
+
+    for (line = 0; line < cache->numLines; line++)
+    {
+        if(set[line].validBit == false)
+        {
+            if(victim < 0 && line >= cache->fillFirst && line < cache->fillEnd)
+            {
+                victim = line;
+            }
+        }
+        else if(set[line].tag == block && set[line].owner == cache->tenant)
+        {
+            set[line].lruCount = cache->clock;
+            policy->onHit(cache->policyState, index, line, &setData[line * size], block);
+            cache->stats.hits++;
+            cache->lastLine = &set[line];
+            return CACHE_HIT;
+        }
+    }
+
+    cache->stats.misses++;
+
+    // If the set is full, the policy chooses; a way outside the range falls back to the first
+    if(victim < 0)
+    {
+        result = CACHE_EVICT;
+        victim = policy->victim(cache->policyState, index, setData, cache->fillFirst, cache->fillEnd);
+        if(victim < cache->fillFirst || victim >= cache->fillEnd)
+        {
+            victim = cache->fillFirst;
+        }
+        cache->stats.evictions++;
+        cache->victimBlock = set[victim].tag;
+    }
+
+    set[victim].validBit = true;
+    set[victim].owner = cache->tenant;
+    set[victim].tag = block;
+    set[victim].lruCount = cache->clock;
+    set[victim].fifoCount = cache->clock;
+    policy->onFill(cache->policyState, index, victim, &setData[victim * size], block);
+    cache->lastLine = &set[victim];
+
+    return result;
+}
+
+// ****************************************************************************************************
+// Compare Stamps Function
+// --- qsort comparison of two clock stamps in ascending order
+// ****************************************************************************************************
+static int compareStamps(const void *first, const void *second)
+{
+    // Function Variables
+    int a = *(const int *)first;
+    int b = *(const int *)second;
+
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+
+// ****************************************************************************************************
+// Renumber Clock Function
+// --- Replaces the LRU and FIFO stamps of every valid line with their rank among all stamps and
+// --- winds the clock back to the highest rank. Lines are only ever compared by stamp, and across
+// --- sets under skewed indexing, so the same order over the whole cache keeps every later decision
+// --- unchanged. Without memory for the ranks, the stamps are shifted down by the oldest instead.
+// ****************************************************************************************************
+static void renumberClock(Cache *cache)
+{
+    // Function Variables
+    long numLines = (long)cache->numSets * cache->numLines;
+    int *stamps = malloc(2 * numLines * sizeof(int) + 1);
+    long count = 0;                 // Stamps collected, then distinct stamps
+    long distinct = 0;              // Index counter for removing duplicate stamps
+    int oldest = cache->clock;      // Oldest stamp of a valid line
+    CacheLine *line;
+    long index;
+
+    for (index = 0; index < numLines; index++)
+    {
+        line = &cache->lines[index];
+        if(line->validBit)
+        {
+            oldest = line->lruCount < oldest ? line->lruCount : oldest;
+            oldest = line->fifoCount < oldest ? line->fifoCount : oldest;
+            if(stamps != NULL)
+            {
+                stamps[count++] = line->lruCount;
+                stamps[count++] = line->fifoCount;
+            }
+        }
+    }
+
+    if(stamps == NULL)
+    {
+        for (index = 0; index < numLines; index++)
+        {
+            cache->lines[index].lruCount -= oldest;
+            cache->lines[index].fifoCount -= oldest;
+        }
+        cache->clock -= oldest;
+        return;
+    }
+
+    qsort(stamps, count, sizeof(int), compareStamps);
+    for (index = 0; index < count; index++)
+    {
+        if(distinct == 0 || stamps[index] != stamps[distinct - 1])
+        {
+            stamps[distinct++] = stamps[index];
+        }
+    }
+
+    // Rank 1 is the oldest stamp; empty lines are never compared
+    for (index = 0; index < numLines; index++)
+    {
+        line = &cache->lines[index];
+        if(line->validBit)
+        {
+            line->lruCount = (int *)bsearch(&line->lruCount, stamps, distinct, sizeof(int), compareStamps) - stamps + 1;
+            line->fifoCount = (int *)bsearch(&line->fifoCount, stamps, distinct, sizeof(int), compareStamps) - stamps + 1;
+        }
+        else
+        {
+            line->lruCount = 0;
+            line->fifoCount = 0;
+        }
+    }
+    cache->clock = distinct;
+
+    free(stamps);
+}
+
+// ****************************************************************************************************
+// Access Set Function
+// --- Simulates the access of block, already counted on the clock, in the set index it maps to.
+// --- The part of cacheAccess after the set index, shared with cacheAccessBatch.
+// ****************************************************************************************************
+static inline CacheResult accessSet(Cache *cache, unsigned long long block, unsigned long long index)
+{
+    // Function Variables
+    unsigned long long tag = block; // Tag of the address, the whole block address
+    CacheLine *set = &cache->lines[index * cache->numLines]; // First line of the set the address maps to
+    int victim = -1;                // Index of the line to fill on a miss
+    CacheResult result;             // Outcome of the access on a miss
+    int line;                       // Index counter for moving through the set
+
+    if(cache->algorithm == ALGORITHM_OPTIMAL || cache->algorithm == ALGORITHM_HAWKEYE)
+    {
+        return accessRanked(cache, set, index, block);
+    }
+    else if(cache->algorithm == ALGORITHM_PLUGIN)
+    {
+        return accessPlugin(cache, set, index, block);
+    }
+
+    // Search the set for the tag, remembering the first empty line this access may fill
+    for (line = 0; line < cache->numLines; line++)
+    {
+        if(set[line].validBit == false)
+        {
+            if(victim < 0 && line >= cache->fillFirst && line < cache->fillEnd)
+            {
+                victim = line;
+            }
+        }
+        else if(set[line].tag == tag && set[line].owner == cache->tenant)
+        {
+            set[line].lruCount = cache->clock;
+            cache->stats.hits++;
+            cache->lastLine = &set[line];
+            return CACHE_HIT;
+        }
+    }
+
+    cache->stats.misses++;
+    result = CACHE_MISS;
+
+    // If the set is full, evict using the replacement algorithm
+    if(victim < 0)
+    {
+        result = CACHE_EVICT;
+        victim = cache->fillFirst;
+        for (line = cache->fillFirst + 1; line < cache->fillEnd; line++)
+        {
+            // Lower count = least recently used or first in
+            if((cache->algorithm == ALGORITHM_LRU && set[line].lruCount < set[victim].lruCount)
+                || (cache->algorithm == ALGORITHM_FIFO && set[line].fifoCount < set[victim].fifoCount))
+            {
+                victim = line;
+            }
+        }
+        cache->stats.evictions++;
+        cache->victimBlock = set[victim].tag;
+    }
+
+    set[victim].validBit = true;
+    set[victim].owner = cache->tenant;
+    set[victim].tag = tag;
+    set[victim].lruCount = cache->clock;
+    set[victim].fifoCount = cache->clock;
+    cache->lastLine = &set[victim];
+
+    return result;
+}
+
+// ****************************************************************************************************
+// Cache Access Function
+// --- Simulates one access of the given address, updating the set it maps to and the counters.
+// --- Returns CACHE_HIT, CACHE_MISS when the block filled an empty line, or CACHE_EVICT when the
+// --- block replaced the victim chosen by the replacement algorithm.
+// ****************************************************************************************************
+CacheResult cacheAccess(Cache *cache, unsigned long long address)
+{
+    // Function Variables
+    unsigned long long block;       // Address with the block offset bits shifted out
+
+    block = (address & cache->addressMask) >> cache->config.blockOffsetBits;
+
+    // Increment "clock" time for each access
+    if(cache->clock == CLOCK_LIMIT)
+    {
+        renumberClock(cache);
+    }
+    cache->clock++;
+
+    if(cache->indexHash == INDEX_SKEW)
+    {
+        return accessSkewed(cache, block);
+    }
+
+    return accessSet(cache, block, cache->maskIndex ? block & cache->setMask : setIndex(cache, block, 0));
+}
+
+// ****************************************************************************************************
+// Cache Access Run Function
+// --- Simulates count consecutive accesses to the block of the given address. Only the first access
+// --- can miss; every following one is a guaranteed hit that just moves the block's last use, so
+// --- they are counted in bulk. Returns the outcome of the first access.
+// ****************************************************************************************************
+CacheResult cacheAccessRun(Cache *cache, unsigned long long address, long count)
+{
+    // Function Variables
+    CacheResult result;             // Outcome of the first access
+
+    result = cacheAccess(cache, address);
+
+    // Later accesses of a run still train or rank the other algorithms
+    if(cache->algorithm != ALGORITHM_LRU && cache->algorithm != ALGORITHM_FIFO)
+    {
+        for (; count > 1; count--)
+        {
+            cacheAccess(cache, address);
+        }
+    }
+    // The block already has the newest stamp, which the rest of the run would only renew
+    else if(count > 1)
+    {
+        cache->stats.hits += count - 1;
+    }
+
+    return result;
+}
+
+// ****************************************************************************************************
+// Rebase Ranks Function
+// --- Moves rankBase of an OPTIMAL cache up to the nearest next use of its lines, or to nextUse if
+// --- that is nearer, so positions past RANK_LIMIT still fit the int ranks. Lines never used again
+// --- keep INT_MAX.
+// ****************************************************************************************************
+static void rebaseRanks(Cache *cache, long nextUse)
+{
+    // Function Variables
+    long numLines = (long)cache->numSets * cache->numLines;
+    long shift = nextUse - cache->rankBase; // Amount every finite rank is lowered by
+    long index;                     // Index counter for moving through the lines
+
+    for (index = 0; index < numLines; index++)
+    {
+        if(cache->lines[index].validBit && cache->lines[index].rank < shift)
+        {
+            shift = cache->lines[index].rank;
+        }
+    }
+    for (index = 0; index < numLines; index++)
+    {
+        if(cache->lines[index].validBit && cache->lines[index].rank < INT_MAX)
+        {
+            cache->lines[index].rank -= shift;
+        }
+    }
+    cache->rankBase += shift;
+}
+
+// ****************************************************************************************************
+// Rank Of Function
+// --- Returns the rank of a line next used at position nextUse, relative to rankBase; INT_MAX for
+// --- CACHE_NEVER or a position still too far ahead
+// ****************************************************************************************************
+static int rankOf(Cache *cache, long nextUse)
+{
+    if(nextUse == CACHE_NEVER)
+    {
+        return INT_MAX;
+    }
+    if(cache->algorithm == ALGORITHM_OPTIMAL && nextUse - cache->rankBase >= RANK_LIMIT)
+    {
+        rebaseRanks(cache, nextUse);
+    }
+
+    return nextUse - cache->rankBase < INT_MAX ? (int)(nextUse - cache->rankBase) : INT_MAX;
+}
+
+// ****************************************************************************************************
+// Cache Access Next Function
+// --- Simulates one access of the given address like cacheAccess, with nextUse the position of the
+// --- next access to the same block (CACHE_NEVER if none), which the optimal algorithm ranks by
+// ****************************************************************************************************
+CacheResult cacheAccessNext(Cache *cache, unsigned long long address, long nextUse)
+{
+    // Function Variables
+    CacheResult result;             // Outcome of the access
+
+    cache->nextUse = rankOf(cache, nextUse);
+    result = cacheAccess(cache, address);
+    cache->nextUse = INT_MAX;
+
+    return result;
+}
+
+// ****************************************************************************************************
+// Cache Update Next Function
+// --- Sets the next use of the block of address, if an optimal cache holds it, to position nextUse,
+// --- for callers that only learn of a next use after the access, like a lookahead window of the
+// --- trace. Returns false if the block is not in the cache.
+// ****************************************************************************************************
+bool cacheUpdateNext(Cache *cache, unsigned long long address, long nextUse)
+{
+    // Function Variables
+    unsigned long long block = (address & cache->addressMask) >> cache->config.blockOffsetBits;
+    unsigned long long index;       // Set the block maps to
+    CacheLine *set;                 // First line of that set
+    int line;                       // Index counter for moving through the set
+
+    if(cache->algorithm != ALGORITHM_OPTIMAL || cache->indexHash == INDEX_SKEW)
+    {
+        return false;
+    }
+    index = cache->maskIndex ? block & cache->setMask : setIndex(cache, block, 0);
+    set = &cache->lines[index * cache->numLines];
+
+    for (line = 0; line < cache->numLines; line++)
+    {
+        if(set[line].validBit && set[line].tag == block && set[line].owner == cache->tenant)
+        {
+            set[line].rank = rankOf(cache, nextUse);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ****************************************************************************************************
+// Cache Next Uses Function
+// --- Stores in nextUses[i] the position of the next access after i to the block of addresses[i],
+// --- or CACHE_NEVER, scanning the trace backwards with a hash table of the blocks seen so far.
+// --- Returns false if memory runs out.
+// ****************************************************************************************************
+bool cacheNextUses(const unsigned long long *addresses, long count, int blockOffsetBits, long *nextUses)
+{
+    // Function Variables
+    unsigned long long *blocks;     // Block address of each table slot
+    long *positions;                // Earliest position seen of each slot's block, -1 if empty
+    unsigned long long block;       // Block address of the current access
+    size_t capacity = 16;           // Number of table slots, at least twice the accesses
+    int shift = 60;                 // Shift of the block hash down to a slot
+    size_t slot;                    // Table slot of the current block
+    long index;                     // Index counter for moving backwards through addresses
+
+    while(capacity < 2 * (size_t)count)
+    {
+        capacity *= 2;
+        shift--;
+    }
+    blocks = malloc(capacity * sizeof(unsigned long long));
+    positions = malloc(capacity * sizeof(long));
+    if(blocks == NULL || positions == NULL)
+    {
+        free(blocks);
+        free(positions);
+        return false;
+    }
+    memset(positions, 0xFF, capacity * sizeof(long));
+
+    for (index = count - 1; index >= 0; index--)
+    {
+        block = addresses[index] >> blockOffsetBits;
+        slot = (block * CACHE_HASH_MULTIPLIER) >> shift;
+        while(positions[slot] >= 0 && blocks[slot] != block)
+        {
+            slot = (slot + 1) & (capacity - 1);
+        }
+
+        nextUses[index] = positions[slot] >= 0 ? positions[slot] : CACHE_NEVER;
+        blocks[slot] = block;
+        positions[slot] = index;
+    }
+
+    free(blocks);
+    free(positions);
+    return true;
+}
+
+// ****************************************************************************************************
+// Cache Collapse Runs Function
+// --- Collapses consecutive accesses of count addresses that fall in the same block of 2^b bytes
+// --- into (address, count) runs stored in runs, which must have room for count runs. Returns the
+// --- number of runs.
+// ****************************************************************************************************
+long cacheCollapseRuns(const unsigned long long *addresses, long count, int blockOffsetBits, CacheRun *runs)
+{
+    // Function Variables
+    long index;                     // Index counter for moving through addresses
+    long numRuns = 0;               // Number of runs stored
+
+    for (index = 0; index < count; index++)
+    {
+        if(numRuns > 0 && (addresses[index] >> blockOffsetBits) == (runs[numRuns - 1].address >> blockOffsetBits))
+        {
+            runs[numRuns - 1].count++;
+        }
+        else
+        {
+            runs[numRuns].address = addresses[index];
+            runs[numRuns].count = 1;
+            numRuns++;
+        }
+    }
+
+    return numRuns;
+}
+
+// ****************************************************************************************************
+// Cache Access Collapsed Function
+// --- Simulates count accesses in order like cacheAccessBatch without per-access outcomes,
+// --- collapsing same-block runs RUN_CHUNK addresses at a time so each run is one engine step.
+// --- Returns the number of engine steps taken.
+// ****************************************************************************************************
+long cacheAccessCollapsed(Cache *cache, const unsigned long long *addresses, long count)
+{
+    // Function Variables
+    CacheRun runs[RUN_CHUNK];       // Runs of the current chunk
+    long numRuns;                   // Number of runs of the current chunk
+    long steps = 0;                 // Number of runs simulated
+    long index;                     // Index of the first address of the current chunk
+    long run;                       // Index counter for moving through runs
+
+    for (index = 0; index < count; index += RUN_CHUNK)
+    {
+        numRuns = cacheCollapseRuns(&addresses[index], count - index < RUN_CHUNK ? count - index : RUN_CHUNK,
+            cache->config.blockOffsetBits, runs);
+        for (run = 0; run < numRuns; run++)
+        {
+            cacheAccessRun(cache, runs[run].address, runs[run].count);
+        }
+        steps += numRuns;
+    }
+
+    return steps;
+}
+
+// ****************************************************************************************************
+// Prefetch Set Function
+// --- Asks the host to start loading the lines of set index, up to BATCH_PREFETCH_BYTES of them, for
+// --- writing
+// ****************************************************************************************************
+static inline void prefetchSet(const Cache *cache, unsigned long long index)
+{
+    // Function Variables
+    const char *set = (const char *)&cache->lines[index * cache->numLines];
+    size_t bytes = (size_t)cache->numLines * sizeof(CacheLine);
+    size_t offset;                  // Index counter for moving through the bytes of the set
+
+    for (offset = 0; offset < bytes && offset < BATCH_PREFETCH_BYTES; offset += 64)
+    {
+        __builtin_prefetch(set + offset, 1);
+    }
+}
+
+// ****************************************************************************************************
+// Cache Access Batch Function
+// --- Simulates count accesses in order, storing each outcome in results when results is not NULL.
+// --- The blocks and sets of BATCH_CHUNK accesses are computed first, then while each access is
+// --- simulated the lines of the set BATCH_PREFETCH accesses ahead are prefetched, so a cache whose
+// --- lines do not fit the host's caches waits on host memory for several sets at once instead of
+// --- one after another. The outcomes are the same as cacheAccess one address at a time.
+// ****************************************************************************************************
+void cacheAccessBatch(Cache *cache, const unsigned long long *addresses, long count, CacheResult *results)
+{
+    // Function Variables
+    unsigned long long blocks[BATCH_CHUNK];     // Block of every access of the chunk
+    unsigned long long indexes[BATCH_CHUNK];    // Set of every access of the chunk
+    CacheResult result;             // Outcome of the current access
+    long start;                     // Index of the first address of the chunk
+    long chunk;                     // Number of addresses of the chunk
+    long index;                     // Index counter for moving through the chunk
+
+    // Skewed ways each have their own set, so there is no one set to fetch ahead
+    if(cache->indexHash == INDEX_SKEW)
+    {
+        for (index = 0; index < count; index++)
+        {
+            result = cacheAccess(cache, addresses[index]);
+            if(results != NULL)
+            {
+                results[index] = result;
+            }
+        }
+        return;
+    }
+
+    for (start = 0; start < count; start += chunk)
+    {
+        chunk = count - start < BATCH_CHUNK ? count - start : BATCH_CHUNK;
+        for (index = 0; index < chunk; index++)
+        {
+            blocks[index] = (addresses[start + index] & cache->addressMask) >> cache->config.blockOffsetBits;
+            indexes[index] = cache->maskIndex ? blocks[index] & cache->setMask : setIndex(cache, blocks[index], 0);
+        }
+        for (index = 0; index < chunk && index < BATCH_PREFETCH; index++)
+        {
+            prefetchSet(cache, indexes[index]);
+        }
+
+        for (index = 0; index < chunk; index++)
+        {
+            if(index + BATCH_PREFETCH < chunk)
+            {
+                prefetchSet(cache, indexes[index + BATCH_PREFETCH]);
+            }
+
+            if(cache->clock == CLOCK_LIMIT)
+            {
+                renumberClock(cache);
+            }
+            cache->clock++;
+            result = accessSet(cache, blocks[index], indexes[index]);
+            if(results != NULL)
+            {
+                results[start + index] = result;
+            }
+        }
+    }
+}
+
+// ****************************************************************************************************
+// Cache Get Stats Function
+// --- Copies the counters of the cache into stats
+// ****************************************************************************************************
+void cacheGetStats(const Cache *cache, CacheStats *stats)
+{
+    *stats = cache->stats;
+}
+
+// ****************************************************************************************************
+// Cache Reset Stats Function
+// --- Zeroes the counters while keeping the cache contents, e.g. at the end of a warm-up window
+// ****************************************************************************************************
+void cacheResetStats(Cache *cache)
+{
+    memset(&cache->stats, 0, sizeof(cache->stats));
+    memset(cache->tenantStats, 0, sizeof(cache->tenantStats));
+}
+
+// ****************************************************************************************************
+// Cache Set Of Function
+// --- Returns the set the given address maps to (for a skewed cache, its set in way 0)
+// ****************************************************************************************************
+long cacheSetOf(const Cache *cache, unsigned long long address)
+{
+    return (long)setIndex(cache, (address & cache->addressMask) >> cache->config.blockOffsetBits, 0);
+}
+
+// ****************************************************************************************************
+// Cache Last Victim Function
+// --- Returns the address of the block removed by the most recent access that returned CACHE_EVICT
+// ****************************************************************************************************
+unsigned long long cacheLastVictim(const Cache *cache)
+{
+    return cache->victimBlock << cache->config.blockOffsetBits;
+}
+
+// ****************************************************************************************************
+// Cache Access Tenant Function
+// --- Simulates one access of the given address in tenant's address space. The block may hit in any
+// --- way but a miss only fills the ways of the tenant's partition. Updates both the cache and the
+// --- tenant's counters. Returns the outcome like cacheAccess.
+// ****************************************************************************************************
+CacheResult cacheAccessTenant(Cache *cache, int tenant, unsigned long long address)
+{
+    // Function Variables
+    CacheResult result;             // Outcome of the access
+    CacheStats *stats = &cache->tenantStats[tenant];
+
+    cache->tenant = tenant;
+    cache->fillFirst = cache->partitionFirst[tenant];
+    cache->fillEnd = cache->partitionFirst[tenant] + cache->partitionWays[tenant];
+
+    result = cacheAccess(cache, address);
+
+    cache->tenant = 0;
+    cache->fillFirst = 0;
+    cache->fillEnd = cache->numLines;
+
+    if(result == CACHE_HIT)
+    {
+        stats->hits++;
+    }
+    else
+    {
+        stats->misses++;
+        if(result == CACHE_EVICT)
+        {
+            stats->evictions++;
+        }
+    }
+
+    return result;
+}
+
+// ****************************************************************************************************
+// Cache Set Partition Function
+// --- Restricts the fills of tenant to the numWays ways starting at firstWay. Blocks already held
+// --- outside the partition stay until evicted. Returns false if the ways are out of range.
+// ****************************************************************************************************
+bool cacheSetPartition(Cache *cache, int tenant, int firstWay, int numWays)
+{
+    if(tenant < 0 || tenant >= CACHE_MAX_TENANTS || firstWay < 0 || numWays <= 0
+        || firstWay + numWays > cache->numLines)
+    {
+        return false;
+    }
+
+    cache->partitionFirst[tenant] = firstWay;
+    cache->partitionWays[tenant] = numWays;
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Cache Get Tenant Stats Function
+// --- Copies the counters of tenant into stats
+// ****************************************************************************************************
+void cacheGetTenantStats(const Cache *cache, int tenant, CacheStats *stats)
+{
+    *stats = cache->tenantStats[tenant];
+}
+
+// ****************************************************************************************************
+// Save Hawkeye Function
+// --- Writes the predictor and OPTgen state to file. Returns false if a write fails.
+// ****************************************************************************************************
+static bool saveHawkeye(const Hawkeye *hawkeye, FILE *file)
+{
+    // Function Variables
+    size_t history = (size_t)hawkeye->numSampled * hawkeye->history;
+
+    return fwrite(hawkeye->predictor, sizeof(hawkeye->predictor), 1, file) == 1
+        && fwrite(hawkeye->times, sizeof(long), hawkeye->numSampled, file) == (size_t)hawkeye->numSampled
+        && fwrite(hawkeye->occupancy, sizeof(int), history, file) == history
+        && fwrite(hawkeye->entries, sizeof(SamplerEntry), history, file) == history;
+}
+
+// ****************************************************************************************************
+// Restore Hawkeye Function
+// --- Reads the state written by saveHawkeye into hawkeye. Returns false and leaves hawkeye
+// --- unchanged if the state is truncated or memory runs out.
+// ****************************************************************************************************
+static bool restoreHawkeye(Hawkeye *hawkeye, FILE *file)
+{
+    // Function Variables
+    unsigned char predictor[HAWKEYE_PREDICTOR]; // Predictor read from file
+    size_t history = (size_t)hawkeye->numSampled * hawkeye->history;
+    long *times = malloc(hawkeye->numSampled * sizeof(long));
+    int *occupancy = malloc(history * sizeof(int));
+    SamplerEntry *entries = malloc(history * sizeof(SamplerEntry));
+
+    if(times == NULL || occupancy == NULL || entries == NULL
+        || fread(predictor, sizeof(predictor), 1, file) != 1
+        || fread(times, sizeof(long), hawkeye->numSampled, file) != (size_t)hawkeye->numSampled
+        || fread(occupancy, sizeof(int), history, file) != history
+        || fread(entries, sizeof(SamplerEntry), history, file) != history)
+    {
+        free(times);
+        free(occupancy);
+        free(entries);
+        return false;
+    }
+
+    memcpy(hawkeye->predictor, predictor, sizeof(predictor));
+    free(hawkeye->times);
+    free(hawkeye->occupancy);
+    free(hawkeye->entries);
+    hawkeye->times = times;
+    hawkeye->occupancy = occupancy;
+    hawkeye->entries = entries;
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Cache Save Function
+// --- Writes the geometry, "clock", counters, and every line of the cache to file in a compact
+// --- binary layout readable by cacheRestore. Returns false if a write fails.
+// ****************************************************************************************************
+bool cacheSave(const Cache *cache, FILE *file)
+{
+    // Function Variables
+    CacheHeader header;             // Header written before the cache lines
+    size_t numLines = (size_t)cache->numSets * cache->numLines;
+
+    memset(&header, 0, sizeof(header));
+    header.addressSize = cache->config.addressSize;
+    header.setBits = cache->config.setBits;
+    header.linesPerSet = cache->config.linesPerSet;
+    header.blockOffsetBits = cache->config.blockOffsetBits;
+    header.algorithm = cache->algorithm;
+    header.sets = cache->numSets;
+    header.ways = cache->numLines;
+    header.indexHash = cache->indexHash;
+    header.clock = cache->clock;
+    header.policyHash = cache->policyHash;
+    header.stats = cache->stats;
+
+    // A plugin's state can only be kept if the policy knows how to write it
+    if((cache->policy != NULL && cache->policy->save == NULL) || fwrite(&header, sizeof(header), 1, file) != 1 || fwrite(cache->lines, sizeof(CacheLine), numLines, file) != numLines)
+    {
+        return false;
+    }
+
+    // Hawkeye keeps what it learned after the lines, a plugin its line metadata and state
+    return (cache->hawkeye == NULL || saveHawkeye(cache->hawkeye, file))
+        && (cache->policyData == NULL || (fwrite(cache->policyData, 1, numLines * cache->policy->lineDataSize, file) == numLines * cache->policy->lineDataSize
+            && cache->policy->save(cache->policyState, file)));
+}
+
+// ****************************************************************************************************
+// Cache Restore Function
+// --- Reads a snapshot written by cacheSave into the cache. Returns false and leaves the cache
+// --- unchanged if the snapshot is truncated or was taken from a cache of a different config or plugin.
+// ****************************************************************************************************
+bool cacheRestore(Cache *cache, FILE *file)
+{
+    // Function Variables
+    CacheHeader header;             // Header read before the cache lines
+    CacheLine *lines;               // Lines read from file before replacing the cache lines
+    unsigned char *policyData = NULL;   // Plugin metadata read from file before replacing it
+    void *policyState = NULL;       // Plugin state read from file before replacing it
+    size_t numLines = (size_t)cache->numSets * cache->numLines;
+    size_t dataSize = cache->policyData != NULL ? numLines * cache->policy->lineDataSize : 0;
+
+    if(fread(&header, sizeof(header), 1, file) != 1
+        || header.addressSize != cache->config.addressSize
+        || header.setBits != cache->config.setBits
+        || header.linesPerSet != cache->config.linesPerSet
+        || header.blockOffsetBits != cache->config.blockOffsetBits
+        || header.algorithm != (int)cache->algorithm
+        || header.sets != cache->numSets
+        || header.ways != cache->numLines
+        || header.indexHash != (int)cache->indexHash
+        || header.policyHash != cache->policyHash
+        || (cache->policy != NULL && cache->policy->restore == NULL))
+    {
+        return false;
+    }
+
+    lines = allocateLines(numLines);
+    if(lines == NULL || fread(lines, sizeof(CacheLine), numLines, file) != numLines
+        || (cache->hawkeye != NULL && restoreHawkeye(cache->hawkeye, file) == false)
+        || (cache->policyData != NULL && ((policyData = malloc(dataSize + 1)) == NULL || fread(policyData, 1, dataSize, file) != dataSize
+            || (policyState = cache->policy->init(cache->numSets, cache->numLines)) == NULL
+            || cache->policy->restore(policyState, file) == false)))
+    {
+        if(policyState != NULL)
+        {
+            cache->policy->destroy(policyState);
+        }
+        free(lines);
+        free(policyData);
+        return false;
+    }
+
+    if(policyData != NULL)
+    {
+        free(cache->policyData);
+        cache->policyData = policyData;
+        cache->policy->destroy(cache->policyState);
+        cache->policyState = policyState;
+    }
+
+    free(cache->lines);
+    cache->lines = lines;
+    cache->clock = header.clock;
+    cache->stats = header.stats;
+
+    return true;
+}
@@ -0,0 +1,394 @@
+//
+//  libcachesim.h - header file for libcachesim
+//  : reusable cache simulator engine with no global state. Every cache is a
+//  : Cache handle created from a CacheConfig, so any number of independent
+//  : caches can be simulated at once, including from different threads.
+//
+
+#ifndef libcachesim_h
+#define libcachesim_h
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <limits.h>
+
+//
+// CacheConfig
+// : geometry and replacement algorithm of a simulated cache
+//  - addressSize: (m) size of an address in bits
+//  - setBits: (s) number of set index bits (S = 2^s)
+//  - linesPerSet: (e) number of line bits per set (E = 2^e)
+//  - blockOffsetBits: (b) number of block offset bits (B = 2^b)
+//  - algorithm: (r) replacement algorithm name - "lru", "fifo", "optimal", "hawkeye", or
+//    "plugin:path.so" to load a CachePolicy from a shared object
+//  - sets: (S) number of sets of any size, overriding setBits when not 0
+//  - ways: (E) number of lines per set of any size, overriding linesPerSet when not 0
+//  - indexHash: (h) set index function - NULL or "modulo", "xor", "prime", or "skew"
+//
+typedef struct{
+    int addressSize;
+    int setBits;
+    int linesPerSet;
+    int blockOffsetBits;
+    const char *algorithm;
+    int sets;
+    int ways;
+    const char *indexHash;
+} CacheConfig;
+
+//
+// CacheStats
+// : counters of a simulated cache since creation or the last cacheResetStats, 64 bit so traces of
+// : any length are counted exactly
+//
+typedef struct{
+    long long hits;
+    long long misses;
+    long long evictions;
+} CacheStats;
+
+//
+// CacheResult
+// : outcome of a single access - an eviction is always also a miss
+//
+typedef enum{
+    CACHE_MISS = 0,
+    CACHE_HIT = 1,
+    CACHE_EVICT = 2
+} CacheResult;
+
+//
+// TraceHeader
+// : header of a binary trace file, followed by count 64 bit little-endian addresses
+//
+#define TRACE_MAGIC "CSTR"
+#define TRACE_VERSION 1
+
+typedef struct{
+    char magic[4];
+    int version;
+    unsigned long long count;
+} TraceHeader;
+
+//
+// CacheRun
+// : count consecutive accesses to the block of address
+//
+typedef struct{
+    unsigned long long address;
+    long count;
+} CacheRun;
+
+//
+// Next Use
+// : position in the trace of the next access to the same block, or CACHE_NEVER. The "optimal"
+// : algorithm needs it for every access, so its caches are driven by cacheAccessNext. A next use
+// : found only later, e.g. within a lookahead window sliding over the trace, is set by cacheUpdateNext.
+//
+#define CACHE_NEVER LONG_MAX
+
+//
+// Hash Multiplier
+// : 2^64 / golden ratio. Multiplying a block or key by it and keeping the high bits spreads nearby
+// : values over a table; every hashed table of the simulator and its tools uses it.
+//
+#define CACHE_HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+//
+// CachePolicy
+// : replacement policy loaded from a shared object by "plugin:path.so". The object exports
+// : const CachePolicy *cachePolicy(void) returning a policy of CACHE_POLICY_VERSION. Every line
+// : has lineDataSize bytes of zeroed metadata for the policy, stored contiguously per set.
+//  - init: returns the policy state of a cache of numSets sets of ways lines, NULL on failure
+//  - onHit: the block in way of set was accessed again
+//  - victim: ways firstWay to endWay - 1 of set are all valid and setData holds the metadata of
+//    every way of the set; returns the way to evict, within the range
+//  - onFill: block was placed in way of set
+//  - destroy: frees the policy state
+//  - save: writes the policy state to file, returning false if a write fails
+//  - restore: reads a state written by save into a state fresh from init, returning false if the
+//    file is truncated or corrupt
+//  Save and restore are optional but go together; without them the cache cannot be checkpointed.
+//  A checkpoint records a hash of the shared object, so it is only restored by the same build.
+//
+#define CACHE_POLICY_VERSION 2
+#define CACHE_POLICY_SYMBOL "cachePolicy"
+
+typedef struct{
+    int version;
+    size_t lineDataSize;
+    void *(*init)(long numSets, int ways);
+    void (*onHit)(void *state, long set, int way, void *lineData, unsigned long long block);
+    int (*victim)(void *state, long set, void *setData, int firstWay, int endWay);
+    void (*onFill)(void *state, long set, int way, void *lineData, unsigned long long block);
+    void (*destroy)(void *state);
+    bool (*save)(const void *state, FILE *file);
+    bool (*restore)(void *state, FILE *file);
+} CachePolicy;
+
+//
+// Tenants
+// : up to CACHE_MAX_TENANTS programs may share one cache through cacheAccessTenant. Each tenant
+// : has its own address space and counters, and only fills the ways of its partition.
+//
+#define CACHE_MAX_TENANTS 16
+
+typedef struct Cache Cache;
+
+Cache *cacheCreate(const CacheConfig *config);
+void cacheDestroy(Cache *cache);
+CacheResult cacheAccess(Cache *cache, unsigned long long address);
+void cacheAccessBatch(Cache *cache, const unsigned long long *addresses, long count, CacheResult *results);
+CacheResult cacheAccessRun(Cache *cache, unsigned long long address, long count);
+long cacheCollapseRuns(const unsigned long long *addresses, long count, int blockOffsetBits, CacheRun *runs);
+long cacheAccessCollapsed(Cache *cache, const unsigned long long *addresses, long count);
+CacheResult cacheAccessNext(Cache *cache, unsigned long long address, long nextUse);
+bool cacheUpdateNext(Cache *cache, unsigned long long address, long nextUse);
+bool cacheNextUses(const unsigned long long *addresses, long count, int blockOffsetBits, long *nextUses);
+void cacheGetStats(const Cache *cache, CacheStats *stats);
+void cacheResetStats(Cache *cache);
+long cacheSetOf(const Cache *cache, unsigned long long address);
+unsigned long long cacheLastVictim(const Cache *cache);
+CacheResult cacheAccessTenant(Cache *cache, int tenant, unsigned long long address);
+bool cacheSetPartition(Cache *cache, int tenant, int firstWay, int numWays);
+void cacheGetTenantStats(const Cache *cache, int tenant, CacheStats *stats);
+bool cacheSave(const Cache *cache, FILE *file);
+bool cacheRestore(Cache *cache, FILE *file);
+
+// cacheparallel.c
+bool cacheSimulateSliced(const CacheConfig *config, const unsigned long long *addresses, long count,
+    int numSlices, long warmUp, CacheStats *stats, CacheStats *sliceStats);
+
+// cacheshared.c
+//
+// SharedTenant
+// : one program of a multiprogrammed simulation
+//  - addresses, count: the program's trace
+//  - rate: accesses issued per round-robin turn
+//  - ways: ways of its static partition
+//
+typedef struct{
+    const unsigned long long *addresses;
+    long count;
+    int rate;
+    int ways;
+} SharedTenant;
+
+bool cacheSimulateShared(const CacheConfig *config, const SharedTenant *tenants, int numTenants,
+    const char *partition, long epoch, CacheStats *tenantStats, int *tenantWays);
+
+// cachetiming.c
+//
+// TimingConfig
+// : non-blocking timing model of the accesses to a cache
+//  - mshrs: misses that may be outstanding at once
+//  - hitLatency: cycles of a hit, and of the lookup before a miss goes to memory
+//  - memoryLatency: cycles until memory answers a request, unless timingSetDram gives a DRAM model
+//  - transferCycles: cycles a block occupies the memory bus, limiting bandwidth (0 for unlimited)
+//  - issueInterval: cycles between accesses of a trace without timestamps
+//
+typedef struct{
+    int mshrs;
+    int hitLatency;
+    int memoryLatency;
+    int transferCycles;
+    int issueInterval;
+} TimingConfig;
+
+//
+// TimingStats
+// : counters of a timing model since creation or the last timingResetStats
+//  - cycles: from the first issue to the last completion
+//  - requests: misses sent to memory; merged: accesses waiting on a block already in flight
+//  - stallCycles: issue cycles lost with every MSHR busy
+//  - parallelism: average memory requests outstanding while any is
+//
+typedef struct{
+    unsigned long long cycles;
+    long accesses;
+    long requests;
+    long merged;
+    unsigned long long stallCycles;
+    double parallelism;
+} TimingStats;
+
+typedef struct CacheTiming CacheTiming;
+typedef struct CacheDram CacheDram;
+
+CacheTiming *timingCreate(const TimingConfig *config, int blockOffsetBits);
+void timingDestroy(CacheTiming *timing);
+unsigned long long timingAccess(CacheTiming *timing, unsigned long long address, CacheResult result, unsigned long long cycle);
+void timingGetStats(const CacheTiming *timing, TimingStats *stats);
+void timingResetStats(CacheTiming *timing);
+void timingSetDram(CacheTiming *timing, CacheDram *dram);
+
+// cachedram.c
+//
+// DramConfig
+// : memory behind the cache, answering misses by bank
+//  - channels, ranks, banks: powers of two, banks counted per rank
+//  - columnBits: bytes of a row buffer as a power of two, at least one block
+//  - mapping: colon separated fields row, rank, bank, channel, and column from the most significant
+//    address bits down, starting with row - NULL for "row:rank:bank:channel:column"
+//  - rowHit, rowEmpty, rowConflict: cycles of a request finding its row open, no row open, or
+//    another row open
+//
+typedef struct{
+    int channels;
+    int ranks;
+    int banks;
+    int columnBits;
+    const char *mapping;
+    int rowHit;
+    int rowEmpty;
+    int rowConflict;
+} DramConfig;
+
+//
+// DramStats, DramBankStats
+// : counters of the whole memory and of one bank since creation or the last dramResetStats
+//
+typedef struct{
+    long requests;
+    long rowHits;
+    long rowEmpty;
+    long rowConflicts;
+} DramStats;
+
+typedef struct{
+    long requests;
+    long conflicts;
+} DramBankStats;
+
+CacheDram *dramCreate(const DramConfig *config, int blockOffsetBits);
+void dramDestroy(CacheDram *dram);
+unsigned long long dramAccess(CacheDram *dram, unsigned long long address, unsigned long long cycle);
+void dramGetStats(const CacheDram *dram, DramStats *stats);
+bool dramGetBankStats(const CacheDram *dram, int channel, int rank, int bank, DramBankStats *stats);
+void dramResetStats(CacheDram *dram, unsigned long long cycle);
+
+// cachephase.c
+//
+// PhaseSignature
+// : MinHash fingerprint of the blocks accessed in one interval of a trace, PHASE_BINS minimum
+// : hashes. The share of bins two signatures agree on estimates how much their working sets overlap.
+//
+#define PHASE_BIN_BITS 6
+#define PHASE_BINS (1 << PHASE_BIN_BITS)
+
+typedef struct{
+    unsigned long long mins[PHASE_BINS];
+    long long accesses;
+} PhaseSignature;
+
+void phaseSignatureReset(PhaseSignature *signature);
+void phaseSignatureAdd(PhaseSignature *signature, unsigned long long block);
+double phaseDistance(const PhaseSignature *first, const PhaseSignature *second);
+int phaseCluster(const PhaseSignature *signatures, long count, int maxClusters, int *clusters, long *representatives);
+
+// cachesharing.c
+//
+// Sharing analysis
+// : coherence traffic of a multi-threaded trace between private caches that never evict. A write
+// : invalidates the copy of every other thread holding the block. A thread's next access to a block
+// : after losing its copy is a coherence miss: true sharing if it touches a byte another thread wrote
+// : since, false sharing otherwise. Bytes are tracked in granules, one bit per granule of a block,
+// : so a block of up to 64 bytes is tracked byte by byte.
+//
+#define SHARING_MAX_THREADS 64
+#define SHARING_THREADS_SHOWN 4
+
+//
+// SharingThread
+// : bytes of a block a thread read and wrote, bit i standing for granule i
+//
+typedef struct{
+    int thread;
+    unsigned long long readGranules;
+    unsigned long long writtenGranules;
+} SharingThread;
+
+//
+// SharingBlock
+// : coherence traffic of one block, with the first SHARING_THREADS_SHOWN threads to access it
+//  - disjoint: no thread wrote a granule another thread accessed
+//
+typedef struct{
+    unsigned long long block;
+    long long invalidations;
+    long long trueMisses;
+    long long falseMisses;
+    bool disjoint;
+    int threads;
+    SharingThread shown[SHARING_THREADS_SHOWN];
+} SharingBlock;
+
+//
+// SharingStats
+// : totals over every block; sharedBlocks counts blocks accessed by more than one thread
+//
+typedef struct{
+    long long accesses;
+    long long blocks;
+    long long sharedBlocks;
+    long long invalidations;
+    long long trueMisses;
+    long long falseMisses;
+    int threads;
+    int granule;
+} SharingStats;
+
+typedef struct CacheSharing CacheSharing;
+
+CacheSharing *sharingCreate(int blockOffsetBits);
+void sharingDestroy(CacheSharing *sharing);
+bool sharingAccess(CacheSharing *sharing, unsigned long long address, int bytes, int thread, bool write);
+long sharingTop(const CacheSharing *sharing, bool falseSharing, SharingBlock *blocks, long max);
+void sharingGetStats(const CacheSharing *sharing, SharingStats *stats);
+
+// cacheregion.c
+//
+// Region attribution
+// : hits, misses, and evictions of a cache split by the named address ranges they fall in, e.g. the
+// : mappings of /proc/<pid>/maps or the arrays of a program. Ranges of the same name are counted as
+// : one region; addresses outside every range are counted as REGION_UNMAPPED.
+//
+#define REGION_UNMAPPED "[unmapped]"
+
+//
+// RegionRange
+// : addresses start to end - 1 belong to the region called name
+//
+typedef struct{
+    unsigned long long start;
+    unsigned long long end;
+    const char *name;
+} RegionRange;
+
+//
+// RegionStats
+// : counters of one region since creation or the last regionResetStats
+//  - evictions: misses to the region that evicted a line
+//  - evicted: lines of the region evicted by any access
+//
+typedef struct{
+    const char *name;
+    long long hits;
+    long long misses;
+    long long evictions;
+    long long evicted;
+} RegionStats;
+
+typedef struct CacheRegions CacheRegions;
+
+CacheRegions *regionCreate(const RegionRange *ranges, long count);
+void regionDestroy(CacheRegions *regions);
+void regionAccess(CacheRegions *regions, unsigned long long address, CacheResult result, unsigned long long victim);
+long regionGetStats(const CacheRegions *regions, RegionStats *stats, long max);
+void regionResetStats(CacheRegions *regions);
+
+// tracehex.c
+long traceParseHex(const char *text, size_t length, unsigned long long *addresses, long capacity, size_t *consumed);
+long traceParseHexScalar(const char *text, size_t length, unsigned long long *addresses, long capacity, size_t *consumed);
+
+#endif /* libcachesim_h */
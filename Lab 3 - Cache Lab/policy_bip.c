@@ -0,0 +1,142 @@
+// ****************************************************************************************************
+//
+//                                          policy_bip.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                  Example replacement policy plugin: Bimodal Insertion Policy. Like LRU, every
+//                  hit moves a block to the most recently used position, but a new block is only
+//                  inserted there once every BIP_EPSILON fills and otherwise at the least recently
+//                  used position, where it is the next victim unless it is reused first. A working
+//                  set larger than the cache then keeps part of itself instead of thrashing.
+//
+//                  Build as a shared object and select with -r plugin:<path>:
+//                  gcc -O2 -shared -fPIC policy_bip.c -o policy_bip.so
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // libcachesim.h used for the CachePolicy interface
+#include <stdlib.h>                 // stdlib.h used for malloc()
+
+// One in BIP_EPSILON fills is inserted at the most recently used position
+#define BIP_EPSILON 32
+
+// BipState Struct
+typedef struct{
+    unsigned long long clock;       // Stamp of the most recent use
+    unsigned long fills;            // Number of blocks inserted
+} BipState;
+
+// ****************************************************************************************************
+// Bip Init Function
+// --- Allocates the policy state; it does not depend on the geometry
+// ****************************************************************************************************
+static void *bipInit(long numSets, int ways)
+{
+    (void)numSets;
+    (void)ways;
+    return calloc(1, sizeof(BipState));
+}
+
+// ****************************************************************************************************
+// Bip On Hit Function
+// --- Moves the block to the most recently used position
+// ****************************************************************************************************
+static void bipOnHit(void *state, long set, int way, void *lineData, unsigned long long block)
+{
+    (void)set;
+    (void)way;
+    (void)block;
+    *(unsigned long long *)lineData = ++((BipState *)state)->clock;
+}
+
+// ****************************************************************************************************
+// Bip Victim Function
+// --- Returns the least recently used way of the range, the first one on a tie
+// ****************************************************************************************************
+static int bipVictim(void *state, long set, void *setData, int firstWay, int endWay)
+{
+    // Function Variables
+    unsigned long long *stamps = setData;   // Last use stamp of every way of the set
+    int victim = firstWay;          // Way with the oldest stamp so far
+    int way;                        // Index counter for moving through the ways
+
+    (void)state;
+    (void)set;
+    for (way = firstWay + 1; way < endWay; way++)
+    {
+        if(stamps[way] < stamps[victim])
+        {
+            victim = way;
+        }
+    }
+
+    return victim;
+}
+
+// ****************************************************************************************************
+// Bip On Fill Function
+// --- Inserts the block at the most recently used position once every BIP_EPSILON fills, otherwise
+// --- at the least recently used position
+// ****************************************************************************************************
+static void bipOnFill(void *state, long set, int way, void *lineData, unsigned long long block)
+{
+    // Function Variables
+    BipState *bip = state;
+
+    (void)set;
+    (void)way;
+    (void)block;
+    *(unsigned long long *)lineData = bip->fills++ % BIP_EPSILON == 0 ? ++bip->clock : 0;
+}
+
+// ****************************************************************************************************
+// Bip Save Function
+// --- Writes the clock and fill count, so a restored cache continues the same insertion pattern
+// ****************************************************************************************************
+static bool bipSave(const void *state, FILE *file)
+{
+    return fwrite(state, sizeof(BipState), 1, file) == 1;
+}
+
+// ****************************************************************************************************
+// Bip Restore Function
+// --- Reads the clock and fill count written by bipSave
+// ****************************************************************************************************
+static bool bipRestore(void *state, FILE *file)
+{
+    return fread(state, sizeof(BipState), 1, file) == 1;
+}
+
+// ****************************************************************************************************
+// Bip Destroy Function
+// --- Frees the policy state
+// ****************************************************************************************************
+static void bipDestroy(void *state)
+{
+    free(state);
+}
+
+// Policy exported to the simulator
+static const CachePolicy BIP_POLICY = {
+    CACHE_POLICY_VERSION,
+    sizeof(unsigned long long),     // Last use stamp per line
+    bipInit,
+    bipOnHit,
+    bipVictim,
+    bipOnFill,
+    bipDestroy,
+    bipSave,
+    bipRestore
+};
+
+// ****************************************************************************************************
+// Cache Policy Function
+// --- Entry point looked up by the simulator
+// ****************************************************************************************************
+const CachePolicy *cachePolicy(void)
+{
+    return &BIP_POLICY;
+}
@@ -0,0 +1,958 @@
+// ****************************************************************************************************
+//
+//                                           tracecap.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                  Captures the data addresses of a local x86-64 Linux program under ptrace, with no
+//                  instrumentation framework: tracecap [options] -- program [arguments]
+//
+//                  Modes:
+//                      step        Single-steps the program and decodes the memory operands of
+//                                  every instruction from its bytes and the registers before it
+//                                  runs: ModRM/SIB operands of legacy, VEX, and EVEX encodings,
+//                                  RIP-relative and fs/gs based ones, and the implicit accesses of
+//                                  push, pop, call, ret, enter, leave, xlat, and string
+//                                  instructions (one iteration per step under rep).
+//                      sampled     Same as step for -w steps out of every -i milliseconds, the
+//                                  program running at full speed in between.
+//                      watch       Runs at full speed with up to four hardware watchpoints (-W),
+//                                  recording the watched address on every read or write of it.
+//
+//                  Addresses are written as a text trace like address01 or a binary trace
+//                  (TraceHeader and 64 bit addresses) to -o or standard output, so they can be
+//                  piped straight into the simulator (-i /dev/stdin), and/or simulated live on a
+//                  libcachesim cache given by -c. Messages go to standard error.
+//
+//                  Limits: only the first thread of the program is traced, and code is cached per
+//                  page, so self-modifying code is not followed. lea, nop, and prefetch operands
+//                  are not accesses. Gathers and scatters record their base and displacement
+//                  only, and EVEX compressed displacements assume full vector operands. The
+//                  program shares standard output, so pipe the trace only from programs that do
+//                  not write there.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // libcachesim.h used for the binary TraceHeader and live caches
+#include <stdio.h>                  // stdio.h used for input/output functions
+#include <stdlib.h>                 // stdlib.h used for strtoull()
+#include <unistd.h>                 // unistd.h used for getopt() and fork()
+#include <string.h>                 // string.h used for strcmp()
+#include <signal.h>                 // signal.h used for kill() and sigaction()
+#include <fcntl.h>                  // fcntl.h used for open()
+#include <errno.h>                  // errno.h used for EINTR
+#include <stddef.h>                 // stddef.h used for offsetof()
+#include <sys/ptrace.h>             // sys/ptrace.h used for ptrace()
+#include <sys/wait.h>               // sys/wait.h used for waitpid()
+#include <sys/user.h>               // sys/user.h used for the registers of the program
+#include <sys/time.h>               // sys/time.h used for setitimer()
+
+#if !defined(__x86_64__) || !defined(__linux__)
+#error tracecap decodes x86-64 instructions under Linux ptrace
+#endif
+
+// // // Tracecap Constants
+const int BUFFER_ADDRESSES = 1 << 16;   // Number of addresses buffered before each write
+const char *OPTIMAL = "optimal";    // Algorithm needing the next use of every access, unknown while capturing
+#define CODE_PAGES 256              // Pages of program code cached by readCode
+#define PAGE_BYTES 4096             // Bytes of a code page
+#define MAX_WATCHPOINTS 4           // Debug address registers DR0 to DR3
+
+// Opcode flags of the decoding tables
+#define OP_MODRM 0x01               // Followed by a ModRM byte
+#define OP_IMM8 0x02                // 1 byte immediate
+#define OP_IMM16 0x04               // 2 byte immediate
+#define OP_IMMZ 0x08                // 4 byte immediate, 2 with the operand size prefix
+#define OP_IMM32 0x10               // 4 byte immediate whatever the prefixes
+#define OP_IMMV 0x20                // 4 byte immediate, 8 with REX.W, 2 with the operand size prefix
+#define OP_NONE 0x40                // ModRM memory operand that is not accessed (lea, nop, prefetch)
+#define OP_SPECIAL 0x80             // Implicit accesses, immediates, or branches decoded case by case
+#define OP_INVALID 0xFF             // Not an instruction in 64 bit mode
+
+// Abbreviations of the tables
+#define M OP_MODRM
+#define I8 OP_IMM8
+#define IZ OP_IMMZ
+#define X OP_SPECIAL
+#define NA OP_INVALID
+
+// One byte opcodes
+static const unsigned char ONE_BYTE[256] = {
+    M, M, M, M, I8, IZ, NA, NA, M, M, M, M, I8, IZ, NA, 0,                      // 00
+    M, M, M, M, I8, IZ, NA, NA, M, M, M, M, I8, IZ, NA, NA,                     // 10
+    M, M, M, M, I8, IZ, 0, NA, M, M, M, M, I8, IZ, 0, NA,                       // 20
+    M, M, M, M, I8, IZ, 0, NA, M, M, M, M, I8, IZ, 0, NA,                       // 30
+    NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,             // 40 REX
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,                             // 50
+    NA, NA, NA, M, 0, 0, 0, 0, X, M | IZ, X, M | I8, X, X, X, X,                // 60
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,                             // 70
+    M | I8, M | IZ, NA, M | I8, M, M, M, M, M, M, M, M, M, M | OP_NONE, M, M | X, // 80
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, NA, 0, X, X, 0, 0,                            // 90
+    X, X, X, X, X, X, X, X, I8, IZ, X, X, X, X, X, X,                           // A0
+    I8, I8, I8, I8, I8, I8, I8, I8, OP_IMMV, OP_IMMV, OP_IMMV, OP_IMMV, OP_IMMV, OP_IMMV, OP_IMMV, OP_IMMV, // B0
+    M | I8, M | I8, X, X, NA, NA, M | I8, M | IZ, X, X, X, X, X, X, NA, X,      // C0
+    M, M, M, M, NA, NA, NA, X, M, M, M, M, M, M, M, M,                          // D0
+    X, X, X, X, I8, I8, I8, I8, X, X, NA, X, 0, 0, 0, 0,                        // E0
+    0, 0, 0, 0, 0, 0, M | X, M | X, 0, 0, 0, 0, 0, 0, M, M | X                  // F0
+};
+
+// Two byte opcodes after 0F
+static const unsigned char TWO_BYTE[256] = {
+    M, M, M, M, NA, X, 0, X, 0, 0, NA, 0, NA, M | OP_NONE, 0, M | I8,           // 00
+    M, M, M, M, M, M, M, M, M | OP_NONE, M | OP_NONE, M | OP_NONE, M | OP_NONE, M | OP_NONE, M | OP_NONE, M | OP_NONE, M | OP_NONE, // 10
+    M, M, M, M, NA, NA, NA, NA, M, M, M, M, M, M, M, M,                         // 20
+    0, 0, 0, 0, X, X, NA, 0, NA, NA, NA, NA, NA, NA, NA, NA,                    // 30
+    M, M, M, M, M, M, M, M, M, M, M, M, M, M, M, M,                             // 40
+    M, M, M, M, M, M, M, M, M, M, M, M, M, M, M, M,                             // 50
+    M, M, M, M, M, M, M, M, M, M, M, M, M, M, M, M,                             // 60
+    M | I8, M | I8, M | I8, M | I8, M, M, M, 0, M, M, NA, NA, M, M, M, M,       // 70
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,                             // 80
+    M, M, M, M, M, M, M, M, M, M, M, M, M, M, M, M,                             // 90
+    X, X, 0, M, M | I8, M, NA, NA, X, X, 0, M, M | I8, M, M, M,                 // A0
+    M, M, M, M, M, M, M, M, M, M, M | I8, M, M, M, M, M,                        // B0
+    M, M, M | I8, M, M | I8, M | I8, M | I8, M, 0, 0, 0, 0, 0, 0, 0, 0,         // C0
+    M, M, M, M, M, M, M, M, M, M, M, M, M, M, M, M,                             // D0
+    M, M, M, M, M, M, M, M, M, M, M, M, M, M, M, M,                             // E0
+    M, M, M, M, M, M, M, M, M, M, M, M, M, M, M, M                              // F0
+};
+
+#undef M
+#undef I8
+#undef IZ
+#undef X
+#undef NA
+
+// // // Tracecap Variables
+// Args
+char *format = "binary";            // (f) Output format - text/binary
+char *outputName;                   // (o) Name of output file, standard output if not given
+unsigned long long limit;           // (n) Number of accesses to capture, 0 for the whole run
+long sampleSteps;                   // (w) Steps traced per sampling period, 0 to trace every step
+long sampleInterval = 10;           // (i) Milliseconds per sampling period
+char *watchList;                    // (W) Comma separated addresses watched instead of stepping
+char *cacheSpec;                    // (c) Cache simulated live, as key=value pairs of m,s,e,b,r,S,E,h
+
+// Output
+FILE *pOutput;                      // Output file pointer, NULL with only a live cache
+bool binary;                        // Flag indicating binary output format
+unsigned long long *buffer;         // Addresses waiting to be written
+int buffered;                       // Number of addresses in buffer
+unsigned long long captured;        // Number of addresses captured so far
+Cache *cache;                       // Cache simulated live, NULL without -c
+
+// Program
+pid_t pid;                          // Process being traced
+int memoryFile = -1;                // /proc/<pid>/mem of the process, read for its code
+unsigned long long codeTags[CODE_PAGES]; // Page address cached in each slot, 0 for none
+unsigned char codePages[CODE_PAGES][PAGE_BYTES + 16]; // Bytes of each cached page and the start of the next
+volatile sig_atomic_t alarmed;      // Flag set when the sampling period ends
+
+// Counters
+unsigned long long steps;           // Instructions single-stepped
+unsigned long long undecoded;       // Instructions that could not be decoded
+unsigned long long mismatched;      // Non-branching instructions whose length disagreed with the next rip
+
+// Operands Struct
+typedef struct{
+    unsigned long long addresses[3];// Data addresses accessed
+    int count;                      // Number of addresses
+    int length;                     // Bytes of the instruction, 0 if it could not be decoded
+    bool branch;                    // Flag indicating the next instruction may not follow this one
+} Operands;
+
+// ****************************************************************************************************
+// Flush Function
+// --- Writes the buffered addresses in the output format
+// ****************************************************************************************************
+void flush(void)
+{
+    // Function Variables
+    int index;                      // Index counter for moving through buffer
+
+    if(pOutput != NULL && binary)
+    {
+        fwrite(buffer, sizeof(unsigned long long), buffered, pOutput);
+    }
+    else if(pOutput != NULL)
+    {
+        for (index = 0; index < buffered; index++)
+        {
+            fprintf(pOutput, "%llx\n", buffer[index]);
+        }
+    }
+
+    buffered = 0;
+}
+
+// ****************************************************************************************************
+// Emit Function
+// --- Adds an address to the trace and the live cache. Returns false once limit addresses have
+// --- been captured.
+// ****************************************************************************************************
+bool emit(unsigned long long address)
+{
+    if(limit > 0 && captured == limit)
+    {
+        return false;
+    }
+
+    if(cache != NULL)
+    {
+        cacheAccess(cache, address);
+    }
+    buffer[buffered++] = address;
+    captured++;
+    if(buffered == BUFFER_ADDRESSES)
+    {
+        flush();
+    }
+
+    return limit == 0 || captured < limit;
+}
+
+// ****************************************************************************************************
+// Read Code Function
+// --- Copies the 16 bytes of program code at address into code through the page cache. Returns
+// --- false if the page cannot be read.
+// ****************************************************************************************************
+bool readCode(unsigned long long address, unsigned char *code)
+{
+    // Function Variables
+    unsigned long long page = address & ~(unsigned long long)(PAGE_BYTES - 1);
+    int slot = (page / PAGE_BYTES) % CODE_PAGES;
+    ssize_t count;                  // Bytes read of the page and the next
+
+    if(codeTags[slot] != page)
+    {
+        count = pread(memoryFile, codePages[slot], PAGE_BYTES + 16, page);
+        if(count <= (ssize_t)(address - page))
+        {
+            return false;
+        }
+        memset(codePages[slot] + count, 0, PAGE_BYTES + 16 - count);
+        codeTags[slot] = page;
+    }
+
+    memcpy(code, codePages[slot] + (address - page), 16);
+    return true;
+}
+
+// ****************************************************************************************************
+// Open Code Function
+// --- Opens the memory of the program for readCode and empties the page cache, at the start and
+// --- after every exec, which replaces the memory an already open file refers to
+// ****************************************************************************************************
+bool openCode(void)
+{
+    // Function Variables
+    char path[64];                  // Path of the program's memory
+
+    if(memoryFile >= 0)
+    {
+        close(memoryFile);
+    }
+    memset(codeTags, 0, sizeof(codeTags));
+    snprintf(path, sizeof(path), "/proc/%d/mem", (int)pid);
+    memoryFile = open(path, O_RDONLY);
+
+    return memoryFile >= 0;
+}
+
+// ****************************************************************************************************
+// Register Function
+// --- Returns general purpose register number (0 rax ... 15 r15, in encoding order) of regs
+// ****************************************************************************************************
+unsigned long long registerOf(const struct user_regs_struct *regs, int number)
+{
+    switch (number)
+    {
+        case 0: return regs->rax;
+        case 1: return regs->rcx;
+        case 2: return regs->rdx;
+        case 3: return regs->rbx;
+        case 4: return regs->rsp;
+        case 5: return regs->rbp;
+        case 6: return regs->rsi;
+        case 7: return regs->rdi;
+        case 8: return regs->r8;
+        case 9: return regs->r9;
+        case 10: return regs->r10;
+        case 11: return regs->r11;
+        case 12: return regs->r12;
+        case 13: return regs->r13;
+        case 14: return regs->r14;
+        default: return regs->r15;
+    }
+}
+
+// ****************************************************************************************************
+// Decode Function
+// --- Decodes the instruction in code, about to run with regs, and stores the addresses it accesses
+// --- in operands. operands->length is 0 if the instruction is not understood.
+// ****************************************************************************************************
+void decode(const unsigned char *code, const struct user_regs_struct *regs, Operands *operands)
+{
+    // Function Variables
+    const unsigned char *byte = code;   // Next byte to decode
+    unsigned long long segment = 0; // Base of an fs or gs override
+    unsigned long long address = 0; // Effective address of the ModRM operand
+    unsigned long long stack = regs->rsp;
+    bool operandSize = false;       // Flag indicating the 66 prefix
+    bool addressSize = false;       // Flag indicating the 67 prefix, 32 bit addresses
+    bool repeat = false;            // Flag indicating an F2 or F3 prefix
+    bool vex = false;               // Flag indicating a VEX or EVEX encoding
+    bool memory = false;            // Flag indicating the ModRM operand is in memory
+    bool ripRelative = false;       // Flag indicating the ModRM operand is relative to the next rip
+    int evexScale = 1;              // Multiplier of an EVEX 8 bit displacement
+    int rex = 0;                    // REX bits W R X B, or those of a VEX or EVEX prefix
+    int map = 0;                    // Opcode map: 0 one byte, 1 0F, 2 0F38, 3 0F3A
+    int flags;                      // Table flags of the opcode
+    int opcode;                     // Opcode byte
+    int modrm = 0, mod = 0, reg = 0, rm = 0;
+    int immediate = 0;              // Bytes of immediate after the operand
+    int sib, index, base;
+    long long displacement = 0;
+
+    memset(operands, 0, sizeof(Operands));
+
+    // Legacy prefixes, then REX
+    for (; byte - code < 14; byte++)
+    {
+        if(*byte == 0x66) operandSize = true;
+        else if(*byte == 0x67) addressSize = true;
+        else if(*byte == 0xF2 || *byte == 0xF3) repeat = true;
+        else if(*byte == 0x64) segment = regs->fs_base;
+        else if(*byte == 0x65) segment = regs->gs_base;
+        else if(*byte != 0xF0 && *byte != 0x2E && *byte != 0x36 && *byte != 0x3E && *byte != 0x26) break;
+    }
+    if((*byte & 0xF0) == 0x40)
+    {
+        rex = *byte++ & 0x0F;
+    }
+
+    // VEX (C5, C4) and EVEX (62) carry inverted R X B bits and the opcode map
+    if(*byte == 0xC5)
+    {
+        rex = (byte[1] & 0x80) ? 0 : 0x4;
+        map = 1;
+        vex = true;
+        byte += 2;
+    }
+    else if(*byte == 0xC4 || *byte == 0x62)
+    {
+        rex = ((~byte[1] >> 5) & 0x7) | ((byte[2] & 0x80) ? 0x8 : 0);
+        map = byte[1] & (*byte == 0xC4 ? 0x1F : 0x07);
+        vex = true;
+        if(*byte == 0x62)
+        {
+            // Compressed 8 bit displacements scale by the vector, or the element when broadcast
+            evexScale = (byte[3] & 0x10) ? ((byte[2] & 0x80) ? 8 : 4) : 16 << ((byte[3] >> 5) & 0x3);
+            byte++;
+        }
+        byte += 3;
+    }
+    else if(*byte == 0x0F)
+    {
+        map = byte[1] == 0x38 ? 2 : byte[1] == 0x3A ? 3 : 1;
+        byte += map == 1 ? 1 : 2;
+    }
+    opcode = *byte++;
+
+    if(vex)
+    {
+        flags = (map == 1 && opcode == 0x77) ? 0 : OP_MODRM;
+        if(map == 3 || (map == 1 && (TWO_BYTE[opcode] & OP_IMM8) != 0))
+        {
+            flags |= OP_IMM8;
+        }
+        if(map < 1 || map > 6)
+        {
+            return;
+        }
+    }
+    else
+    {
+        flags = map == 0 ? ONE_BYTE[opcode] : map == 1 ? TWO_BYTE[opcode] : map == 2 ? OP_MODRM : OP_MODRM | OP_IMM8;
+    }
+    if(flags == OP_INVALID)
+    {
+        return;
+    }
+
+    // ModRM, SIB, and displacement
+    if(flags & OP_MODRM)
+    {
+        modrm = *byte++;
+        mod = modrm >> 6;
+        reg = (modrm >> 3) & 0x7;
+        rm = modrm & 0x7;
+        memory = mod != 3;
+        if(memory && rm == 4)
+        {
+            sib = *byte++;
+            index = ((sib >> 3) & 0x7) | ((rex & 0x2) << 2);
+            base = (sib & 0x7) | ((rex & 0x1) << 3);
+            if(index != 4)
+            {
+                address = registerOf(regs, index) << (sib >> 6);
+            }
+            if((sib & 0x7) == 5 && mod == 0)
+            {
+                mod = 2;
+            }
+            else
+            {
+                address += registerOf(regs, base);
+            }
+        }
+        else if(memory && rm == 5 && mod == 0)
+        {
+            ripRelative = true;
+            mod = 2;
+        }
+        else if(memory)
+        {
+            address = registerOf(regs, rm | ((rex & 0x1) << 3));
+        }
+
+        if(mod == 1)
+        {
+            displacement = (signed char)*byte++ * (long long)evexScale;
+        }
+        else if(mod == 2 && memory)
+        {
+            displacement = (int)(byte[0] | byte[1] << 8 | byte[2] << 16 | (unsigned)byte[3] << 24);
+            byte += 4;
+        }
+    }
+
+    // Immediates
+    if(flags & OP_IMM8) immediate = 1;
+    if(flags & OP_IMM16) immediate = 2;
+    if(flags & OP_IMMZ) immediate = operandSize ? 2 : 4;
+    if(flags & OP_IMM32) immediate = 4;
+    if(flags & OP_IMMV) immediate = (rex & 0x8) ? 8 : operandSize ? 2 : 4;
+    if((flags & OP_SPECIAL) && map == 0)
+    {
+        if(opcode == 0x68 || opcode == 0xE8 || opcode == 0xE9) immediate = opcode == 0x68 && operandSize ? 2 : 4;
+        else if(opcode == 0x6A || (opcode >= 0x70 && opcode <= 0x7F) || (opcode >= 0xE0 && opcode <= 0xE3) || opcode == 0xEB) immediate = 1;
+        else if(opcode >= 0xA0 && opcode <= 0xA3) immediate = addressSize ? 4 : 8;
+        else if(opcode == 0xC2 || opcode == 0xCA) immediate = 2;
+        else if(opcode == 0xC8) immediate = 3;
+        else if(opcode == 0xCD) immediate = 1;
+        else if(opcode == 0xF6 && reg <= 1) immediate = 1;
+        else if(opcode == 0xF7 && reg <= 1) immediate = operandSize ? 2 : 4;
+    }
+    else if((flags & OP_SPECIAL) && map == 1 && opcode >= 0x80 && opcode <= 0x8F)
+    {
+        immediate = 4;
+    }
+    operands->length = byte - code + immediate;
+    if(operands->length > 15)
+    {
+        operands->length = 0;
+        return;
+    }
+
+    // The ModRM operand, unless it is only an address computation
+    if(memory && (flags & OP_NONE) == 0)
+    {
+        address += displacement + (ripRelative ? regs->rip + operands->length : 0);
+        if(addressSize)
+        {
+            address &= 0xFFFFFFFFULL;
+        }
+        operands->addresses[operands->count++] = address + segment;
+    }
+
+    if((flags & OP_SPECIAL) == 0)
+    {
+        return;
+    }
+
+    // Implicit accesses and branches of the one byte map
+    if(map == 0)
+    {
+        if(opcode >= 0x50 && opcode <= 0x57) operands->addresses[operands->count++] = stack - 8;
+        else if(opcode >= 0x58 && opcode <= 0x5F) operands->addresses[operands->count++] = stack;
+        else if(opcode == 0x68 || opcode == 0x6A || opcode == 0x9C || opcode == 0xC8) operands->addresses[operands->count++] = stack - 8;
+        else if(opcode == 0x8F || opcode == 0x9D) operands->addresses[operands->count++] = stack;
+        else if(opcode == 0xC9) operands->addresses[operands->count++] = regs->rbp;
+        else if(opcode == 0xD7) operands->addresses[operands->count++] = segment + ((addressSize ? regs->rbx & 0xFFFFFFFFULL : regs->rbx) + (regs->rax & 0xFF));
+        else if(opcode >= 0xA0 && opcode <= 0xA3)
+        {
+            memcpy(&address, byte, immediate);
+            operands->addresses[operands->count++] = segment + (addressSize ? address & 0xFFFFFFFFULL : address);
+        }
+        else if((opcode >= 0x6C && opcode <= 0x6F) || (opcode >= 0xA4 && opcode <= 0xA7) || (opcode >= 0xAA && opcode <= 0xAF))
+        {
+            // String instructions: none left under rep with a zero count, otherwise rsi and/or rdi.
+            // Under rep every iteration is a step of its own at the same rip.
+            operands->branch = repeat;
+            if(repeat == false || (addressSize ? regs->rcx & 0xFFFFFFFFULL : regs->rcx) != 0)
+            {
+                if(opcode == 0x6E || opcode == 0x6F || (opcode >= 0xA4 && opcode <= 0xA7) || opcode == 0xAC || opcode == 0xAD)
+                {
+                    operands->addresses[operands->count++] = segment + (addressSize ? regs->rsi & 0xFFFFFFFFULL : regs->rsi);
+                }
+                if(opcode == 0x6C || opcode == 0x6D || (opcode >= 0xA4 && opcode <= 0xA7) || opcode == 0xAA || opcode == 0xAB || opcode == 0xAE || opcode == 0xAF)
+                {
+                    operands->addresses[operands->count++] = addressSize ? regs->rdi & 0xFFFFFFFFULL : regs->rdi;
+                }
+            }
+        }
+        else if(opcode == 0xC2 || opcode == 0xC3 || opcode == 0xCA || opcode == 0xCB || opcode == 0xCF)
+        {
+            operands->addresses[operands->count++] = stack;
+            operands->branch = true;
+        }
+        else if(opcode == 0xE8)
+        {
+            operands->addresses[operands->count++] = stack - 8;
+            operands->branch = true;
+        }
+        else if(opcode == 0xFF && (reg == 2 || reg == 3 || reg == 6))
+        {
+            operands->addresses[operands->count++] = stack - 8;
+            operands->branch = reg != 6;
+        }
+        else if(opcode == 0xFF && (reg == 4 || reg == 5))
+        {
+            operands->branch = true;
+        }
+        else if((opcode >= 0x70 && opcode <= 0x7F) || (opcode >= 0xE0 && opcode <= 0xE3) || opcode == 0xE9 || opcode == 0xEB || opcode == 0xCC || opcode == 0xCD)
+        {
+            operands->branch = true;
+        }
+    }
+    // Push and pop of fs and gs, branches and system calls of the 0F map
+    else if(map == 1)
+    {
+        if(opcode == 0xA0 || opcode == 0xA8) operands->addresses[operands->count++] = stack - 8;
+        else if(opcode == 0xA1 || opcode == 0xA9) operands->addresses[operands->count++] = stack;
+        operands->branch = (opcode >= 0x80 && opcode <= 0x8F) || opcode == 0x05 || opcode == 0x07 || opcode == 0x34 || opcode == 0x35;
+    }
+}
+
+// ****************************************************************************************************
+// Parse Cache Function
+// --- Fills config from a comma separated list of key=value pairs of m,s,e,b,r,S,E,h, each
+// --- overriding the default 64 bit LRU cache of 64 sets of 8 ways of 64 byte blocks. Returns
+// --- false on an unknown key or the optimal algorithm, which cannot see the accesses to come.
+// ****************************************************************************************************
+bool parseCache(char *spec, CacheConfig *config)
+{
+    // Function Variables
+    char *pair;                     // Current key=value pair
+    char *value;                    // Value of the pair
+
+    memset(config, 0, sizeof(CacheConfig));
+    config->addressSize = 64;
+    config->setBits = 6;
+    config->linesPerSet = 3;
+    config->blockOffsetBits = 6;
+    config->algorithm = "lru";
+
+    for (pair = strtok(spec, ","); pair != NULL; pair = strtok(NULL, ","))
+    {
+        value = strchr(pair, '=');
+        if(value == NULL || value - pair != 1)
+        {
+            return false;
+        }
+        value++;
+        switch (pair[0])
+        {
+            case 'm': config->addressSize = atoi(value); break;
+            case 's': config->setBits = atoi(value); break;
+            case 'e': config->linesPerSet = atoi(value); break;
+            case 'b': config->blockOffsetBits = atoi(value); break;
+            case 'r': config->algorithm = value; break;
+            case 'S': config->sets = atoi(value); break;
+            case 'E': config->ways = atoi(value); break;
+            case 'h': config->indexHash = value; break;
+            default: return false;
+        }
+    }
+
+    return strcmp(config->algorithm, OPTIMAL) != 0;
+}
+
+// ****************************************************************************************************
+// Alarm Handler
+// --- Ends the full speed part of a sampling period, interrupting waitpid
+// ****************************************************************************************************
+void alarmHandler(int signal)
+{
+    (void)signal;
+    alarmed = 1;
+}
+
+// ****************************************************************************************************
+// Run Free Function
+// --- Lets the stopped program run at full speed for sampleInterval milliseconds, then stops it
+// --- again. Returns false if it exits meanwhile.
+// ****************************************************************************************************
+bool runFree(int *signal)
+{
+    // Function Variables
+    struct itimerval timer = {{0, 0}, {sampleInterval / 1000, (sampleInterval % 1000) * 1000}};
+    int status;                     // Status of the program reported by waitpid
+    bool stopping = false;          // Flag indicating our SIGSTOP is on its way
+
+    alarmed = 0;
+    setitimer(ITIMER_REAL, &timer, NULL);
+    ptrace(PTRACE_CONT, pid, 0, *signal);
+    *signal = 0;
+
+    while(true)
+    {
+        if(waitpid(pid, &status, 0) < 0)
+        {
+            if(errno == EINTR && alarmed && stopping == false)
+            {
+                kill(pid, SIGSTOP);
+                stopping = true;
+            }
+            continue;
+        }
+        if(WIFEXITED(status) || WIFSIGNALED(status))
+        {
+            return false;
+        }
+        if(WSTOPSIG(status) == SIGSTOP && stopping)
+        {
+            return true;
+        }
+
+        // Pass on the program's own signals; restart the code cache after an exec
+        if(status >> 8 == (SIGTRAP | (PTRACE_EVENT_EXEC << 8)))
+        {
+            openCode();
+        }
+        else
+        {
+            *signal = WSTOPSIG(status);
+        }
+        ptrace(PTRACE_CONT, pid, 0, *signal);
+        *signal = 0;
+    }
+}
+
+// ****************************************************************************************************
+// Step Function
+// --- Single-steps the program, recording the operands of every instruction that completes, until
+// --- it exits or limit addresses are captured. With sampleSteps, only that many steps are taken
+// --- before each period the program runs free. Returns true if the program exited.
+// ****************************************************************************************************
+bool step(void)
+{
+    // Function Variables
+    struct user_regs_struct regs;   // Registers before the instruction
+    unsigned char code[16];         // Bytes of the instruction
+    Operands operands;              // Addresses the instruction accesses
+    Operands last = {{0}, 0, 0, true}; // Operands of the instruction stepped last
+    unsigned long long lastRip = 0; // Address of the instruction stepped last
+    long periodSteps = 0;           // Steps of the current sampling period
+    int signal = 0;                 // Signal to deliver to the program on resuming it
+    int status;                     // Status of the program reported by waitpid
+    int index;
+
+    while(true)
+    {
+        if(sampleSteps > 0 && periodSteps == sampleSteps)
+        {
+            if(runFree(&signal) == false)
+            {
+                return true;
+            }
+            periodSteps = 0;
+            last.branch = true;
+        }
+
+        ptrace(PTRACE_GETREGS, pid, 0, &regs);
+        if(last.branch == false && last.length > 0 && regs.rip != lastRip + last.length)
+        {
+            mismatched++;
+        }
+
+        if(readCode(regs.rip, code))
+        {
+            decode(code, &regs, &operands);
+        }
+        else
+        {
+            operands.length = 0;
+        }
+        if(operands.length == 0)
+        {
+            undecoded++;
+            operands.count = 0;
+            operands.branch = true;
+        }
+
+        ptrace(PTRACE_SINGLESTEP, pid, 0, signal);
+        signal = 0;
+        if(waitpid(pid, &status, 0) < 0 || WIFEXITED(status) || WIFSIGNALED(status))
+        {
+            return true;
+        }
+
+        // The instruction completed: record it. Any other stop leaves it to be stepped again.
+        last = operands;
+        lastRip = regs.rip;
+        if(WSTOPSIG(status) == SIGTRAP)
+        {
+            if(status >> 8 == (SIGTRAP | (PTRACE_EVENT_EXEC << 8)))
+            {
+                openCode();
+                last.branch = true;
+            }
+            steps++;
+            periodSteps++;
+            for (index = 0; index < operands.count; index++)
+            {
+                if(emit(operands.addresses[index]) == false)
+                {
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            signal = WSTOPSIG(status);
+            last.branch = true;
+        }
+    }
+}
+
+// ****************************************************************************************************
+// Set Watchpoints Function
+// --- Loads the watched addresses into DR0 to DR3 of the program, each trapping on a read or write
+// --- of its 8 bytes. Returns false if the kernel refuses them.
+// ****************************************************************************************************
+bool setWatchpoints(const unsigned long long *watched, int count)
+{
+    // Function Variables
+    unsigned long long control = 0; // DR7: local enable, read/write, and 8 byte length of each
+    int index;
+
+    for (index = 0; index < count; index++)
+    {
+        if(ptrace(PTRACE_POKEUSER, pid, offsetof(struct user, u_debugreg[index]), watched[index]) != 0)
+        {
+            return false;
+        }
+        control |= (1ULL << (2 * index)) | (3ULL << (16 + 4 * index)) | (2ULL << (18 + 4 * index));
+    }
+
+    return ptrace(PTRACE_POKEUSER, pid, offsetof(struct user, u_debugreg[7]), control) == 0;
+}
+
+// ****************************************************************************************************
+// Watch Function
+// --- Runs the program at full speed, recording the watched address of every watchpoint trap, until
+// --- it exits or limit addresses are captured. Returns true if the program exited, false if it is
+// --- left stopped or the watchpoints could not be set.
+// ****************************************************************************************************
+bool watch(void)
+{
+    // Function Variables
+    unsigned long long watched[MAX_WATCHPOINTS];    // Addresses watched
+    unsigned long long hits;        // DR6: the watchpoints that triggered
+    char *token;                    // Current comma separated address
+    int count = 0;                  // Number of addresses watched
+    int signal = 0;                 // Signal to deliver to the program on resuming it
+    int status;                     // Status of the program reported by waitpid
+    int index;
+
+    for (token = strtok(watchList, ","); token != NULL && count < MAX_WATCHPOINTS; token = strtok(NULL, ","))
+    {
+        watched[count++] = strtoull(token, NULL, 16) & ~7ULL;
+    }
+    if(setWatchpoints(watched, count) == false)
+    {
+        fprintf(stderr, "[ERROR] Could not set the watchpoints ...\n");
+        return false;
+    }
+
+    while(true)
+    {
+        ptrace(PTRACE_CONT, pid, 0, signal);
+        signal = 0;
+        if(waitpid(pid, &status, 0) < 0 || WIFEXITED(status) || WIFSIGNALED(status))
+        {
+            return true;
+        }
+        if(status >> 8 == (SIGTRAP | (PTRACE_EVENT_EXEC << 8)))
+        {
+            setWatchpoints(watched, count);
+            continue;
+        }
+        if(WSTOPSIG(status) != SIGTRAP)
+        {
+            signal = WSTOPSIG(status);
+            continue;
+        }
+
+        // A trap without a watchpoint hit belongs to the program
+        hits = ptrace(PTRACE_PEEKUSER, pid, offsetof(struct user, u_debugreg[6]), 0);
+        if((hits & 0xF) == 0)
+        {
+            signal = SIGTRAP;
+            continue;
+        }
+        ptrace(PTRACE_POKEUSER, pid, offsetof(struct user, u_debugreg[6]), 0);
+        for (index = 0; index < count; index++)
+        {
+            if((hits & (1ULL << index)) && emit(watched[index]) == false)
+            {
+                return false;
+            }
+        }
+    }
+}
+
+// ****************************************************************************************************
+// Main Function
+// --- Starts the program after -- under ptrace, captures its data addresses in the chosen mode, and
+// --- writes them as a trace and/or simulates them on the live cache
+// ****************************************************************************************************
+int main(int argc, char **argv)
+{
+    // Function Variables
+    int opt;                        // Option for switch case to gather argument list
+    TraceHeader header;             // Header of a binary trace
+    CacheConfig config;             // Config of the live cache
+    CacheStats stats;               // Counters of the live cache
+    struct sigaction action;        // Handler of the sampling alarm
+    bool exited;                    // Flag indicating the program ran to its end
+    int status;                     // Status of the program reported by waitpid
+
+    while ((opt = getopt(argc, argv, "+:o:f:n:w:i:W:c:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'o': outputName = optarg; break;
+            case 'f': format = optarg; break;
+            case 'n': limit = strtoull(optarg, NULL, 0); break;
+            case 'w': sampleSteps = atol(optarg); break;
+            case 'i': sampleInterval = atol(optarg); break;
+            case 'W': watchList = optarg; break;
+            case 'c': cacheSpec = optarg; break;
+            default:
+                printf("Error: Please check format of arguments ... \n");
+                exit(1);
+        }
+    }
+
+    if(optind >= argc || sampleSteps < 0 || sampleInterval <= 0)
+    {
+        fprintf(stderr, "Usage: %s [-f text|binary] [-o file] [-n count] [-w steps -i milliseconds]\n"
+            "       [-W address,...] [-c m=64,s=6,e=3,b=6,r=lru] -- program [arguments]\n", argv[0]);
+        exit(1);
+    }
+
+    binary = strcmp(format, "binary") == 0;
+    if(binary == false && strcmp(format, "text") != 0)
+    {
+        fprintf(stderr, "[ERROR] Given Format Invalid - Use text or binary ...\n");
+        exit(1);
+    }
+
+    // Simulate live on a cache, writing a trace only if one is asked for
+    if(cacheSpec != NULL && (parseCache(cacheSpec, &config) == false || (cache = cacheCreate(&config)) == NULL))
+    {
+        fprintf(stderr, "[ERROR] Invalid -c cache - use key=value pairs of m,s,e,b,r,S,E,h, r not optimal ...\n");
+        exit(1);
+    }
+    if(cache == NULL || outputName != NULL)
+    {
+        pOutput = outputName == NULL ? stdout : fopen(outputName, binary ? "wb" : "w");
+        if(pOutput == NULL)
+        {
+            fprintf(stderr, "[ERROR] Could not open %s ...\n", outputName);
+            exit(1);
+        }
+    }
+
+    // Binary traces start with their header, its count filled in at the end when the file allows
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    if(pOutput != NULL && binary)
+    {
+        fwrite(&header, sizeof(header), 1, pOutput);
+    }
+    buffer = malloc(BUFFER_ADDRESSES * sizeof(unsigned long long));
+
+    // Start the program stopped at its exec
+    pid = fork();
+    if(pid == 0)
+    {
+        ptrace(PTRACE_TRACEME, 0, 0, 0);
+        execvp(argv[optind], argv + optind);
+        _exit(127);
+    }
+    if(pid < 0 || waitpid(pid, &status, 0) < 0 || WIFSTOPPED(status) == false)
+    {
+        fprintf(stderr, "[ERROR] Could not run %s under ptrace ...\n", argv[optind]);
+        exit(1);
+    }
+    ptrace(PTRACE_SETOPTIONS, pid, 0, PTRACE_O_TRACEEXEC | PTRACE_O_EXITKILL);
+    if(watchList == NULL && openCode() == false)
+    {
+        fprintf(stderr, "[ERROR] Could not read the code of %s ...\n", argv[optind]);
+        exit(1);
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = alarmHandler;
+    sigaction(SIGALRM, &action, NULL);
+
+    exited = watchList != NULL ? watch() : step();
+
+    // Past the limit, let the program finish untraced
+    if(exited == false)
+    {
+        if(watchList != NULL)
+        {
+            ptrace(PTRACE_POKEUSER, pid, offsetof(struct user, u_debugreg[7]), 0);
+        }
+        ptrace(PTRACE_DETACH, pid, 0, 0);
+        waitpid(pid, &status, 0);
+    }
+    flush();
+    if(memoryFile >= 0)
+    {
+        close(memoryFile);
+    }
+
+    if(pOutput != NULL)
+    {
+        header.count = captured;
+        if(binary && fseek(pOutput, 0, SEEK_SET) == 0)
+        {
+            fwrite(&header, sizeof(header), 1, pOutput);
+        }
+        if(fclose(pOutput) != 0)
+        {
+            fprintf(stderr, "[ERROR] Could not write trace ...\n");
+            exit(1);
+        }
+    }
+
+    fprintf(stderr, "[capture] accesses: %llu steps: %llu undecoded: %llu length mismatches: %llu\n", captured, steps, undecoded, mismatched);
+    if(cache != NULL)
+    {
+        cacheGetStats(cache, &stats);
+        fprintf(stderr, "[cache] hits: %lld misses: %lld evictions: %lld miss rate: %.3f%%\n", stats.hits, stats.misses, stats.evictions,
+            stats.hits + stats.misses > 0 ? stats.misses * 100.0 / (stats.hits + stats.misses) : 0.0);
+        cacheDestroy(cache);
+    }
+    free(buffer);
+
+    return 0;
+}
@@ -0,0 +1,445 @@
+// ****************************************************************************************************
+//
+//                                           tracegen.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                  Generates synthetic address traces for benchmarking the cache simulator. Every
+//                  pattern emits exactly -n accesses, repeating its kernel as often as needed, and
+//                  the same arguments and seed always produce the same trace.
+//
+//                  Patterns (-p):
+//                      seq         Sequential elements of the footprint, wrapping around
+//                      stride      Every -S bytes of the footprint, wrapping around
+//                      random      Uniformly random elements of the footprint
+//                      zipf        Zipfian (-a skew) choice of blocks; block 0 is the hottest
+//                      chase       Pointer chasing through a random cycle visiting every element
+//                      transpose   B = A^T over -N x -N doubles, reading A and writing B
+//                      btranspose  Same as transpose in -T x -T tiles
+//                      matmul      C = A * B over -N x -N doubles, ijk loop order
+//                      bmatmul     Same as matmul in -T x -T x -T tiles
+//
+//                  Formats (-f):
+//                      text        One lowercase hexidecimal address per line, like address01
+//                      binary      TraceHeader followed by 64 bit little-endian addresses
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // libcachesim.h used for the binary TraceHeader
+#include <stdio.h>                  // stdio.h used for input/output functions
+#include <stdlib.h>                 // stdlib.h used for strtoull()
+#include <unistd.h>                 // unistd.h used for getopt()
+#include <string.h>                 // string.h used for strcmp()
+#include <math.h>                   // math.h used for exp() and log()
+
+// // // Tracegen Constants
+const int BUFFER_ADDRESSES = 1 << 16;   // Number of addresses buffered before each write
+
+// // // Tracegen Variables
+// Args
+char *pattern;                      // (p) Access pattern
+unsigned long long count;           // (n) Number of accesses to generate
+char *format = "text";              // (f) Output format - text/binary
+char *outputName;                   // (o) Name of output file, standard output if not given
+unsigned long long seed = 1;        // (x) Seed of the random number generator
+unsigned long long footprint = 1 << 20; // (F) Bytes covered by the seq, stride, random, zipf, and chase patterns
+unsigned long long stride = 64;     // (S) Bytes between accesses of the stride pattern
+unsigned long long elementSize = 8; // (E) Bytes per element of the seq, random, and chase patterns
+unsigned long long blockSize = 64;  // (B) Bytes per block of the zipf pattern
+double skew = 0.99;                 // (a) Skew of the zipf pattern
+int dimension = 64;                 // (N) Matrix dimension of the transpose and matmul patterns
+int tile = 8;                       // (T) Tile size of the blocked transpose and matmul patterns
+unsigned long long base;            // (b) Address of the first byte of the footprint or first matrix
+
+// Output
+FILE *pOutput;                      // Output file pointer
+bool binary;                        // Flag indicating binary output format
+unsigned long long *buffer;         // Addresses waiting to be written
+int buffered;                       // Number of addresses in buffer
+unsigned long long emitted;         // Number of addresses generated so far
+
+// Random number generator
+unsigned long long state;           // splitmix64 state
+
+// Zipf sampler constants
+double zipfHIntegralX1;             // zipfHIntegral(1.5) - 1
+double zipfHIntegralN;              // zipfHIntegral(n + 0.5) for n blocks
+double zipfS;                       // Acceptance bound of the rejection test
+
+// ****************************************************************************************************
+// Next Random Function
+// --- Returns the next 64 bit number of the splitmix64 generator
+// ****************************************************************************************************
+unsigned long long nextRandom(void)
+{
+    unsigned long long z = (state += CACHE_HASH_MULTIPLIER);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// ****************************************************************************************************
+// Next Uniform Function
+// --- Returns a random number in [0, bound) without modulo bias
+// ****************************************************************************************************
+unsigned long long nextUniform(unsigned long long bound)
+{
+    // Function Variables
+    unsigned long long value;       // Random number
+    unsigned long long limit = -bound % bound; // Values below limit would bias the result
+
+    do
+    {
+        value = nextRandom();
+    } while(value < limit);
+
+    return value % bound;
+}
+
+// ****************************************************************************************************
+// Flush Function
+// --- Writes the buffered addresses in the output format
+// ****************************************************************************************************
+void flush(void)
+{
+    // Function Variables
+    char line[4096 * 17];           // Text of up to 4096 addresses
+    int length = 0;                 // Bytes of text in line
+    int index;                      // Index counter for moving through buffer
+    int digit;                      // Index counter for moving through the digits of an address
+    unsigned long long address;     // Address being formatted
+
+    if(binary)
+    {
+        fwrite(buffer, sizeof(unsigned long long), buffered, pOutput);
+    }
+    else
+    {
+        for (index = 0; index < buffered; index++)
+        {
+            // Format the address as lowercase hexidecimal without leading zeros
+            address = buffer[index];
+            digit = address == 0 ? 1 : (67 - __builtin_clzll(address)) / 4;
+            length += digit;
+            while(digit > 0)
+            {
+                line[length - digit] = "0123456789abcdef"[(address >> (4 * (digit - 1))) & 0xF];
+                digit--;
+            }
+            line[length++] = '\n';
+
+            if(length > (int)sizeof(line) - 17 || index == buffered - 1)
+            {
+                fwrite(line, 1, length, pOutput);
+                length = 0;
+            }
+        }
+    }
+
+    buffered = 0;
+}
+
+// ****************************************************************************************************
+// Emit Function
+// --- Adds an address to the trace. Returns false once count addresses have been generated.
+// ****************************************************************************************************
+bool emit(unsigned long long address)
+{
+    if(emitted == count)
+    {
+        return false;
+    }
+
+    buffer[buffered++] = address;
+    emitted++;
+    if(buffered == BUFFER_ADDRESSES)
+    {
+        flush();
+    }
+
+    return emitted < count;
+}
+
+// ****************************************************************************************************
+// Zipf Sampler
+// --- Rejection-inversion sampling of ranks 1..n with probability proportional to 1 / k^skew in
+// --- constant memory (W. Hormann and G. Derflinger, 1996)
+// ****************************************************************************************************
+double zipfH(double x)
+{
+    return exp(-skew * log(x));
+}
+
+double zipfHIntegral(double x)
+{
+    double logX = log(x);
+    double t = (1 - skew) * logX;
+
+    return (fabs(t) > 1e-8 ? expm1(t) / t : 1 + t / 2) * logX;
+}
+
+double zipfHIntegralInverse(double x)
+{
+    double t = x * (1 - skew);
+
+    if(t < -1)
+    {
+        t = -1;
+    }
+    return exp((fabs(t) > 1e-8 ? log1p(t) / t : 1 - t / 2) * x);
+}
+
+void zipfSetup(unsigned long long n)
+{
+    zipfHIntegralX1 = zipfHIntegral(1.5) - 1;
+    zipfHIntegralN = zipfHIntegral(n + 0.5);
+    zipfS = 2 - zipfHIntegralInverse(zipfHIntegral(2.5) - zipfH(2));
+}
+
+unsigned long long zipfSample(unsigned long long n)
+{
+    // Function Variables
+    double u;                       // Uniform point of the integral
+    double x;                       // Inverse of u
+    unsigned long long k;           // Sampled rank
+
+    while(true)
+    {
+        u = zipfHIntegralN + (nextRandom() >> 11) * 0x1.0p-53 * (zipfHIntegralX1 - zipfHIntegralN);
+        x = zipfHIntegralInverse(u);
+        k = (unsigned long long)(x + 0.5);
+        if(k < 1)
+        {
+            k = 1;
+        }
+        else if(k > n)
+        {
+            k = n;
+        }
+        if(k - x <= zipfS || u >= zipfHIntegral(k + 0.5) - zipfH(k))
+        {
+            return k;
+        }
+    }
+}
+
+// ****************************************************************************************************
+// Generate Function
+// --- Emits count addresses of the chosen pattern. Returns false if the pattern is unknown.
+// ****************************************************************************************************
+bool generate(void)
+{
+    // Function Variables
+    unsigned long long elements = footprint / elementSize;   // Elements of the footprint
+    unsigned long long blocks = footprint / blockSize;       // Blocks of the footprint
+    unsigned long long offset = 0;  // Offset into the footprint
+    unsigned long long period;      // Power of two at least elements for the chase cycle
+    unsigned long long multiplier;  // Multiplier of the chase cycle
+    unsigned long long increment;   // Increment of the chase cycle
+    unsigned long long matrixBytes = (unsigned long long)dimension * dimension * sizeof(double);
+    unsigned long long a = base;    // Address of matrix A
+    unsigned long long b = base + matrixBytes;       // Address of matrix B
+    unsigned long long c = base + 2 * matrixBytes;   // Address of matrix C
+    int i, j, k;                    // Matrix indexes
+    int ii, jj, kk;                 // Tile indexes
+    bool more = count > 0;          // Flag indicating more addresses are needed
+
+    if(strcmp(pattern, "seq") == 0)
+    {
+        while(more)
+        {
+            more = emit(base + offset);
+            offset = offset + elementSize < footprint ? offset + elementSize : 0;
+        }
+    }
+    else if(strcmp(pattern, "stride") == 0)
+    {
+        while(more)
+        {
+            more = emit(base + offset);
+            offset = (offset + stride) % footprint;
+        }
+    }
+    else if(strcmp(pattern, "random") == 0)
+    {
+        while(more)
+        {
+            more = emit(base + nextUniform(elements) * elementSize);
+        }
+    }
+    else if(strcmp(pattern, "zipf") == 0)
+    {
+        zipfSetup(blocks);
+        while(more)
+        {
+            more = emit(base + (zipfSample(blocks) - 1) * blockSize + nextUniform(blockSize / elementSize) * elementSize);
+        }
+    }
+    else if(strcmp(pattern, "chase") == 0)
+    {
+        // Full period linear congruential cycle over a power of two, skipping values past the
+        // footprint, visits every element once per lap in a seeded random order
+        for (period = 1; period < elements; period <<= 1);
+        multiplier = (nextRandom() & ~3ULL) | 1;
+        increment = nextRandom() | 1;
+        while(more)
+        {
+            do
+            {
+                offset = (offset * multiplier + increment) & (period - 1);
+            } while(offset >= elements);
+            more = emit(base + offset * elementSize);
+        }
+    }
+    else if(strcmp(pattern, "transpose") == 0)
+    {
+        while(more)
+        {
+            for (i = 0; i < dimension && more; i++)
+                for (j = 0; j < dimension && more; j++)
+                    more = emit(a + ((unsigned long long)i * dimension + j) * sizeof(double))
+                        && emit(b + ((unsigned long long)j * dimension + i) * sizeof(double));
+        }
+    }
+    else if(strcmp(pattern, "btranspose") == 0)
+    {
+        while(more)
+        {
+            for (ii = 0; ii < dimension && more; ii += tile)
+                for (jj = 0; jj < dimension && more; jj += tile)
+                    for (i = ii; i < ii + tile && i < dimension && more; i++)
+                        for (j = jj; j < jj + tile && j < dimension && more; j++)
+                            more = emit(a + ((unsigned long long)i * dimension + j) * sizeof(double))
+                                && emit(b + ((unsigned long long)j * dimension + i) * sizeof(double));
+        }
+    }
+    else if(strcmp(pattern, "matmul") == 0)
+    {
+        while(more)
+        {
+            for (i = 0; i < dimension && more; i++)
+                for (j = 0; j < dimension && more; j++)
+                {
+                    more = emit(c + ((unsigned long long)i * dimension + j) * sizeof(double));
+                    for (k = 0; k < dimension && more; k++)
+                        more = emit(a + ((unsigned long long)i * dimension + k) * sizeof(double))
+                            && emit(b + ((unsigned long long)k * dimension + j) * sizeof(double));
+                    more = more && emit(c + ((unsigned long long)i * dimension + j) * sizeof(double));
+                }
+        }
+    }
+    else if(strcmp(pattern, "bmatmul") == 0)
+    {
+        while(more)
+        {
+            for (ii = 0; ii < dimension && more; ii += tile)
+                for (jj = 0; jj < dimension && more; jj += tile)
+                    for (kk = 0; kk < dimension && more; kk += tile)
+                        for (i = ii; i < ii + tile && i < dimension && more; i++)
+                            for (j = jj; j < jj + tile && j < dimension && more; j++)
+                            {
+                                more = emit(c + ((unsigned long long)i * dimension + j) * sizeof(double));
+                                for (k = kk; k < kk + tile && k < dimension && more; k++)
+                                    more = emit(a + ((unsigned long long)i * dimension + k) * sizeof(double))
+                                        && emit(b + ((unsigned long long)k * dimension + j) * sizeof(double));
+                                more = more && emit(c + ((unsigned long long)i * dimension + j) * sizeof(double));
+                            }
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// ****************************************************************************************************
+// Main Function
+// --- Given arguments in the form :p:n:f:o:x:F:S:E:B:a:N:T:b: generates count addresses of the
+// --- pattern into the output file in the chosen format
+// ****************************************************************************************************
+int main(int argc, char **argv)
+{
+    // Function Variables
+    int opt;                        // Option for switch case to gather argument list
+    TraceHeader header;             // Header of a binary trace
+
+    while ((opt = getopt(argc, argv, ":p:n:f:o:x:F:S:E:B:a:N:T:b:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p': pattern = optarg; break;
+            case 'n': count = strtoull(optarg, NULL, 0); break;
+            case 'f': format = optarg; break;
+            case 'o': outputName = optarg; break;
+            case 'x': seed = strtoull(optarg, NULL, 0); break;
+            case 'F': footprint = strtoull(optarg, NULL, 0); break;
+            case 'S': stride = strtoull(optarg, NULL, 0); break;
+            case 'E': elementSize = strtoull(optarg, NULL, 0); break;
+            case 'B': blockSize = strtoull(optarg, NULL, 0); break;
+            case 'a': skew = atof(optarg); break;
+            case 'N': dimension = atoi(optarg); break;
+            case 'T': tile = atoi(optarg); break;
+            case 'b': base = strtoull(optarg, NULL, 0); break;
+            default:
+                printf("Error: Please check format of arguments ... \n");
+                exit(1);
+        }
+    }
+
+    if(pattern == NULL || elementSize == 0 || blockSize < elementSize || footprint < blockSize
+        || stride == 0 || dimension <= 0 || tile <= 0 || skew <= 0)
+    {
+        fprintf(stderr, "Usage: %s -p seq|stride|random|zipf|chase|transpose|btranspose|matmul|bmatmul -n <count>\n"
+            "       [-f text|binary] [-o file] [-x seed] [-F footprint] [-S stride] [-E elementSize]\n"
+            "       [-B blockSize] [-a skew] [-N dimension] [-T tile] [-b base]\n", argv[0]);
+        exit(1);
+    }
+
+    binary = strcmp(format, "binary") == 0;
+    if(binary == false && strcmp(format, "text") != 0)
+    {
+        fprintf(stderr, "[ERROR] Given Format Invalid - Use text or binary ...\n");
+        exit(1);
+    }
+
+    pOutput = outputName == NULL ? stdout : fopen(outputName, binary ? "wb" : "w");
+    if(pOutput == NULL)
+    {
+        fprintf(stderr, "[ERROR] Could not open %s ...\n", outputName);
+        exit(1);
+    }
+
+    // Binary traces start with their header
+    if(binary)
+    {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+        header.version = TRACE_VERSION;
+        header.count = count;
+        fwrite(&header, sizeof(header), 1, pOutput);
+    }
+
+    buffer = malloc(BUFFER_ADDRESSES * sizeof(unsigned long long));
+    state = seed;
+
+    if(generate() == false)
+    {
+        fprintf(stderr, "[ERROR] Given Pattern Invalid ...\n");
+        exit(1);
+    }
+    flush();
+
+    free(buffer);
+    if(fclose(pOutput) != 0)
+    {
+        fprintf(stderr, "[ERROR] Could not write trace ...\n");
+        exit(1);
+    }
+
+    return 0;
+}
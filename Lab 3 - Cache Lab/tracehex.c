@@ -0,0 +1,307 @@
+// ****************************************************************************************************
+//
+//                                           tracehex.c
+//
+// ****************************************************************************************************
+//
+//                                            Notes:
+//
+//                                    Vectorized Hex Parsing:
+//
+//                  "1e0\n"  ->  [ '1' 'e' '0' '\n' ... ]                 <-16 byte load
+//                           ->  [  1   14   0   x  ... ]                 <-nibble values
+//                           ->  [  1   14   0   0  ... ]                 <-digits past the token zeroed
+//                           ->  [ 0x1e   0x00   ... ]                    <-pairs of nibbles into bytes
+//                           ->  0x1e00000000000000 >> (64 - 4 * 3)       <-byte swap and align
+//
+//                  Line breaks and other whitespace are found 64 bytes at a time (two AVX2 or four
+//                  SSE2 compares) into a delimiter bit mask; every non-delimiter following a
+//                  delimiter starts an address. Each address of up to 16 digits is then classified,
+//                  validated, and converted with one 16 byte SSSE3 pass: the first byte that is not
+//                  a hex digit ends the token and must be whitespace or the end of the text. Since
+//                  the starts come from the mask, consecutive addresses convert independently of
+//                  each other. Upper and lower case digits are both accepted. Without SSSE3 the
+//                  scalar loop below gives identical results.
+//
+// ****************************************************************************************************
+
+#include "libcachesim.h"            // header file for libcachesim.c
+#include <string.h>                 // string.h used for memcpy()
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>              // tmmintrin.h used for SSSE3 _mm_maddubs_epi16()
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>              // immintrin.h used for AVX2 _mm256_cmpeq_epi8()
+#endif
+
+// Maximum number of hex digits of a 64 bit address
+#define HEX_DIGITS 16
+
+// ****************************************************************************************************
+// Is Delimiter Function
+// --- Returns true if c separates two addresses
+// ****************************************************************************************************
+static inline bool isDelimiter(char c)
+{
+    return c == '\n' || c == '\r' || c == ' ' || c == '\t' || c == '\0';
+}
+
+// ****************************************************************************************************
+// Hex Value Function
+// --- Returns the value of hex digit c, or -1 if c is not a hex digit
+// ****************************************************************************************************
+static inline int hexValue(char c)
+{
+    if(c >= '0' && c <= '9')
+        return c - '0';
+    else if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    else if(c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+#if defined(__SSSE3__)
+// ****************************************************************************************************
+// Delimiter Mask Function
+// --- Returns a bit per byte of the 64 bytes starting at text that is set if the byte is whitespace
+// ****************************************************************************************************
+static inline unsigned long long delimiterMask(const char *text)
+{
+#if defined(__AVX2__)
+    // Function Variables
+    __m256i bytes;                  // 32 characters of the block
+    __m256i found;                  // 0xFF for each delimiter character
+    unsigned long long mask = 0;    // Delimiter bit per byte
+    int half;                       // Index counter for moving through the two halves of the block
+
+    for (half = 0; half < 2; half++)
+    {
+        bytes = _mm256_loadu_si256((const __m256i *)&text[32 * half]);
+        found = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r'))),
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t'))),
+            _mm256_cmpeq_epi8(bytes, _mm256_setzero_si256())));
+        mask |= (unsigned long long)(unsigned int)_mm256_movemask_epi8(found) << (32 * half);
+    }
+
+    return mask;
+#else
+    // Function Variables
+    __m128i bytes;                  // 16 characters of the block
+    __m128i found;                  // 0xFF for each delimiter character
+    unsigned long long mask = 0;    // Delimiter bit per byte
+    int quarter;                    // Index counter for moving through the four quarters of the block
+
+    for (quarter = 0; quarter < 4; quarter++)
+    {
+        bytes = _mm_loadu_si128((const __m128i *)&text[16 * quarter]);
+        found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r'))),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t'))),
+            _mm_cmpeq_epi8(bytes, _mm_setzero_si128())));
+        mask |= (unsigned long long)(unsigned int)_mm_movemask_epi8(found) << (16 * quarter);
+    }
+
+    return mask;
+#endif
+}
+
+// ****************************************************************************************************
+// Parse Token Vector Function
+// --- Converts the token starting at text, where at least 16 bytes are readable, into address.
+// --- Returns the number of digits of the token, or -1 if it has a bad character or is too long.
+// ****************************************************************************************************
+static inline int parseTokenVector(const char *text, unsigned long long *address)
+{
+    // Function Variables
+    __m128i bytes;                  // 16 characters starting at the token
+    __m128i lower;                  // Characters with the lower case bit set
+    __m128i isDigit;                // 0xFF for each '0' - '9' character
+    __m128i isLetter;               // 0xFF for each 'a' - 'f' or 'A' - 'F' character
+    __m128i values;                 // Nibble value of each character
+    __m128i pairs;                  // Two nibbles combined per 16 bit lane
+    unsigned int hexMask;           // Bit per character that is a hex digit
+    int length;                     // Number of digits of the token
+
+    bytes = _mm_loadu_si128((const __m128i *)text);
+    lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+    isDigit = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('9' + 1)));
+    isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+    // The token ends at the first character that is not a hex digit
+    hexMask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter));
+    length = __builtin_ctz(~hexMask | 0x10000);
+
+    // Digit values are the low nibble, plus 9 for letters; characters past the token become 0
+    values = _mm_add_epi8(_mm_and_si128(bytes, _mm_set1_epi8(0x0F)), _mm_and_si128(isLetter, _mm_set1_epi8(9)));
+    values = _mm_and_si128(values, _mm_or_si128(isDigit, isLetter));
+    values = _mm_and_si128(values, _mm_cmplt_epi8(_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm_set1_epi8(length)));
+
+    // Combine nibble pairs into bytes, most significant digit first, and align to the token length
+    pairs = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110));
+    pairs = _mm_packus_epi16(pairs, pairs);
+    if(length > 0)
+    {
+        *address = __builtin_bswap64((unsigned long long)_mm_cvtsi128_si64(pairs)) >> (64 - 4 * length);
+    }
+
+    return length;
+}
+#endif
+
+// ****************************************************************************************************
+// Parse Token Scalar Function
+// --- Converts the token starting at text, ending no later than end, into address. Returns the
+// --- number of digits of the token, or -1 if it has a bad character or is too long.
+// ****************************************************************************************************
+static inline int parseTokenScalar(const char *text, const char *end, unsigned long long *address)
+{
+    // Function Variables
+    unsigned long long value = 0;   // Address accumulated one digit at a time
+    int length = 0;                 // Number of digits of the token
+    int digit;                      // Value of the current digit
+
+    while(text + length < end && (digit = hexValue(text[length])) >= 0)
+    {
+        if(length == HEX_DIGITS)
+        {
+            return -1;
+        }
+        value = (value << 4) | digit;
+        length++;
+    }
+
+    *address = value;
+    return length;
+}
+
+// ****************************************************************************************************
+// Trace Parse Hex Function
+// --- Parses whitespace separated hexidecimal addresses from length bytes of text into addresses,
+// --- stopping after capacity addresses. Returns the number of addresses parsed, storing the number
+// --- of bytes consumed in consumed. Returns -1 on a bad character or an address wider than 64 bits,
+// --- storing the byte offset of the bad token in consumed.
+// ****************************************************************************************************
+long traceParseHex(const char *text, size_t length, unsigned long long *addresses, long capacity, size_t *consumed)
+{
+    // Function Variables
+    size_t position = 0;            // Offset of the next unread byte
+    long count = 0;                 // Number of addresses parsed
+    int digits;                     // Number of digits of the current token
+#if defined(__SSSE3__)
+    char tail[2 * HEX_DIGITS];      // Zero padded copy of the last bytes so 16 byte loads stay in bounds
+    unsigned long long mask;        // Delimiter bit per byte of the current block
+    unsigned long long starts;      // Bit per byte of the current block that starts an address
+    unsigned long long previous = 1;// 1 if the byte before the current block is a delimiter
+    size_t block;                   // Offset of the current 64 byte block
+    size_t start;                   // Offset of the current address
+
+    // Parse whole blocks while every 16 byte load past them stays within the text
+    for (block = 0; block + 64 + HEX_DIGITS <= length && count < capacity; block += 64)
+    {
+        mask = delimiterMask(&text[block]);
+        starts = ~mask & ((mask << 1) | previous);
+        previous = mask >> 63;
+
+        while(starts != 0 && count < capacity)
+        {
+            start = block + __builtin_ctzll(starts);
+            starts &= starts - 1;
+
+            digits = parseTokenVector(&text[start], &addresses[count]);
+            if(digits <= 0 || isDelimiter(text[start + digits]) == false)
+            {
+                *consumed = start;
+                return -1;
+            }
+
+            position = start + digits;
+            count++;
+        }
+    }
+
+    // Continue after the last block unless its last address ran past it
+    if(count < capacity && position < block)
+    {
+        position = block;
+    }
+#endif
+
+    while(count < capacity)
+    {
+        // Skip whitespace between addresses
+        while(position < length && isDelimiter(text[position]))
+        {
+            position++;
+        }
+        if(position == length)
+        {
+            break;
+        }
+
+#if defined(__SSSE3__)
+        if(length - position >= HEX_DIGITS)
+        {
+            digits = parseTokenVector(&text[position], &addresses[count]);
+        }
+        else
+        {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, &text[position], length - position);
+            digits = parseTokenVector(tail, &addresses[count]);
+        }
+#else
+        digits = parseTokenScalar(&text[position], &text[length], &addresses[count]);
+#endif
+
+        // The token must be at least one digit followed by whitespace or the end of the text
+        if(digits <= 0 || (position + digits < length && isDelimiter(text[position + digits]) == false))
+        {
+            *consumed = position;
+            return -1;
+        }
+
+        position += digits;
+        count++;
+    }
+
+    *consumed = position;
+    return count;
+}
+
+// ****************************************************************************************************
+// Trace Parse Hex Scalar Function
+// --- Same as traceParseHex one character at a time, used as the reference for the vector path
+// ****************************************************************************************************
+long traceParseHexScalar(const char *text, size_t length, unsigned long long *addresses, long capacity, size_t *consumed)
+{
+    // Function Variables
+    size_t position = 0;            // Offset of the next unread byte
+    long count = 0;                 // Number of addresses parsed
+    int digits;                     // Number of digits of the current token
+
+    while(count < capacity)
+    {
+        while(position < length && isDelimiter(text[position]))
+        {
+            position++;
+        }
+        if(position == length)
+        {
+            break;
+        }
+
+        digits = parseTokenScalar(&text[position], &text[length], &addresses[count]);
+        if(digits <= 0 || (position + digits < length && isDelimiter(text[position + digits]) == false))
+        {
+            *consumed = position;
+            return -1;
+        }
+
+        position += digits;
+        count++;
+    }
+
+    *consumed = position;
+    return count;
+}